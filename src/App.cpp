@@ -1,30 +1,9 @@
 #include "App.h"
+#include "Extra/Profiler.h"
+#include "Extra/RenderTargetPool.h"
+#include "Extra/TexturePool.h"
 #include <iostream>
 #include <exception>
-void APIENTRY openglDebugCallback(GLenum source, GLenum type, GLuint id,
-                                  GLenum severity, GLsizei length,
-                                  const GLchar *message, const void *userParam)
-{
-    std::cerr << "OpenGL Debug Message [" << id << "]: " << message << std::endl;
-
-    switch (severity)
-    {
-    case GL_DEBUG_SEVERITY_HIGH:
-        std::cerr << "Severity: HIGH" << std::endl;
-        break;
-    case GL_DEBUG_SEVERITY_MEDIUM:
-        std::cerr << "Severity: MEDIUM" << std::endl;
-        break;
-    case GL_DEBUG_SEVERITY_LOW:
-        std::cerr << "Severity: LOW" << std::endl;
-        break;
-    case GL_DEBUG_SEVERITY_NOTIFICATION:
-        std::cerr << "Severity: NOTIFICATION" << std::endl;
-        break;
-    }
-
-    std::cerr << "------------------------" << std::endl;
-}
 App::App(const AppProperties &_p) : properties(_p)
 {
     glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
@@ -37,6 +16,7 @@ App::App(const AppProperties &_p) : properties(_p)
     glfwWindowHint(GLFW_OPENGL_PROFILE, properties.compatability_openGL_profile ? GLFW_OPENGL_COMPAT_PROFILE : GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // required for OSX
     glfwWindowHint(GLFW_RESIZABLE, properties.window_resizable);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, properties.gl_diagnostics.mode != GLDebugMode::Off);
     glfwSetErrorCallback(glfw_error_callback);
     window = glfwCreateWindow(properties.winSizeX, properties.winSizeY, properties.AppName.c_str(), NULL, NULL);
     glfwMakeContextCurrent(window);
@@ -46,9 +26,7 @@ App::App(const AppProperties &_p) : properties(_p)
     }
     glfwSetWindowTitle(window, "Command Macros");
 
-    glEnable(GL_DEBUG_OUTPUT);
-    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // Ensures messages are synchronous
-    glDebugMessageCallback(openglDebugCallback, nullptr);
+    gl_diagnostics.Init(properties.gl_diagnostics);
     const GLubyte *version = glGetString(GL_VERSION);
     std::cout << "OpenGL version supported: " << version << std::endl;
 
@@ -76,6 +54,7 @@ void App::Run()
     while (!shouldShutdown && !glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+        Profiler::Shared().BeginFrame();
         // new imgui frame
 
         int display_w, display_h;
@@ -87,13 +66,22 @@ void App::Run()
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        OnUpdate();
-        OnRender();
+        {
+            Profiler::Scope scope("App::OnUpdate", false);
+            OnUpdate();
+        }
+        {
+            Profiler::Scope scope("App::OnRender", false);
+            OnRender();
+        }
 
         ImGui::EndFrame();
         ImGui::Render();
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            Profiler::Scope scope("ImGui_ImplOpenGL3_RenderDrawData");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
             GLFWwindow *backup_current_context = glfwGetCurrentContext();
@@ -103,8 +91,14 @@ void App::Run()
         }
         OnPostRender();
         glfwSwapBuffers(window);
+        Profiler::Shared().EndFrame();
+        RenderTargetPool::Shared().EndFrame();
+        gl_diagnostics.Drain();
     }
     OnShutdown();
+    gl_diagnostics.Drain();
+    if (uint64_t suppressed = gl_diagnostics.SuppressedCount())
+        std::cerr << "[GL] " << suppressed << " debug messages were suppressed this session\n";
     CleanUp();
 }
 
@@ -115,6 +109,9 @@ void App::Shutdown()
 
 void App::CleanUp()
 {
+    Profiler::Shared().ReleaseQueries();
+    RenderTargetPool::Shared().Shutdown();
+    TexturePool::Shared().Shutdown();
     ImPlot::DestroyContext();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
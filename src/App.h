@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include "lib_include.h"
+#include "GLDiagnostics.h"
 class App
 {
 public:
@@ -13,6 +14,7 @@ public:
         bool imgui_viewports_enable = false;
         bool window_resizable = true;
         uint32_t GL_version_major = 3,GL_version_minor = 2; //this would be 3.1
+        GLDiagnosticsSettings gl_diagnostics = {};
     };
 
 protected:
@@ -22,6 +24,7 @@ protected:
     ImGuiContext* imgui_context = nullptr;
     ImGuiIO* imgui_io = nullptr;
     ImPlotContext* implot_context = nullptr;
+    GLDiagnostics gl_diagnostics;
 public:
     App(const AppProperties &_p);
     void Run();
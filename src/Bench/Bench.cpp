@@ -0,0 +1,138 @@
+#include "Bench.h"
+#include "Extra/Mesh.h"
+#include "lib_include.h"
+#include <cmath>
+#include <fstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+long Bench::PeakRssKb()
+{
+#if defined(__linux__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#elif defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#else
+    return 0;
+#endif
+}
+
+Bench::GLContext::GLContext(int width, int height)
+{
+    if (glfwInit() != GLFW_TRUE)
+        return;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(width, height, "bench", nullptr, nullptr);
+    if (!window)
+    {
+        fprintf(stderr, "[WARN] No OpenGL 4.5 context, skipping GPU measurements\n");
+        return;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK)
+    {
+        fprintf(stderr, "[WARN] GLEW failed to init, skipping GPU measurements\n");
+        glfwDestroyWindow(window);
+        window = nullptr;
+    }
+}
+
+Bench::GLContext::~GLContext()
+{
+    if (window)
+        glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+void Bench::GLContext::Swap()
+{
+    glfwSwapBuffers(window);
+}
+
+static double GridHeight(uint32_t x, uint32_t y)
+{
+    return std::sin(x * 0.05) * std::cos(y * 0.07);
+}
+
+ImguiBase::Mesh Bench::GridMesh(uint32_t n)
+{
+    using namespace ImguiBase;
+    std::vector<Vertex> vertices;
+    vertices.reserve(size_t(n + 1) * (n + 1));
+    for (uint32_t y = 0; y <= n; y++)
+        for (uint32_t x = 0; x <= n; x++)
+        {
+            Vertex v{};
+            v.Position = vec3(x * 0.1f, float(GridHeight(x, y)), y * 0.1f);
+            v.TexCoord = vec2(float(x) / n, float(y) / n);
+            v.Color = vec4(1);
+            vertices.push_back(v);
+        }
+    std::vector<GLuint> indices;
+    indices.reserve(size_t(n) * n * 6);
+    for (uint32_t y = 0; y < n; y++)
+        for (uint32_t x = 0; x < n; x++)
+        {
+            const GLuint a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    Mesh mesh;
+    mesh.SetVerticies(std::move(vertices));
+    mesh.SetIndicies(std::move(indices));
+    return mesh;
+}
+
+void Bench::WriteGridObj(const std::filesystem::path& path, uint32_t n, GridObj style)
+{
+    std::ofstream out(path, std::ios::binary);
+    std::string faces, attributes;
+    char line[160];
+    for (uint32_t y = 0; y <= n; y++)
+        for (uint32_t x = 0; x <= n; x++)
+        {
+            const double h = GridHeight(x, y);
+            if (style == GridObj::Mixed && (x + y) % 7 == 0)
+                snprintf(line, sizeof(line), "v\t%.6f %.6f\t%.6f 0.5 %.3f 1\n", x * 0.1, h, y * 0.1, x / double(n));
+            else
+                snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x * 0.1, h, y * 0.1);
+            attributes += line;
+            snprintf(line, sizeof(line), "vt %.6f %.6f\nvn 0 %.6f 1\n", x / double(n), y / double(n), h);
+            attributes += line;
+        }
+    for (uint32_t y = 0; y < n; y++)
+        for (uint32_t x = 0; x < n; x++)
+        {
+            // OBJ indices start at 1
+            const uint32_t a = y * (n + 1) + x + 1, b = a + 1, c = a + n + 1, d = c + 1;
+            switch (style == GridObj::Mixed ? (x ^ y) % 4 : 0)
+            {
+            case 0:
+                snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c,
+                         b, b, b, b, b, b, c, c, c, d, d, d);
+                break;
+            case 1:
+                snprintf(line, sizeof(line), "f %u//%u %u//%u %u//%u\nf %u//%u %u//%u %u//%u\n", a, a, c, c, b, b, b, b, c, c, d, d);
+                break;
+            case 2:
+                snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u\nf\t%u/%u %u/%u %u/%u\n", a, a, c, c, b, b, b, b, c, c, d, d);
+                break;
+            default:
+                snprintf(line, sizeof(line), "f %u %u %u\nf %u %u %u\n", a, c, b, b, c, d);
+                break;
+            }
+            faces += line;
+        }
+    if (style == GridObj::Mixed)
+        out << "# grid bench mesh\no grid\n";
+    out << (style == GridObj::FacesFirst ? faces + attributes : attributes + faces);
+}
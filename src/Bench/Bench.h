@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+struct GLFWwindow;
+namespace ImguiBase
+{
+    class Mesh;
+}
+
+// Opt-in micro-benchmarks compiled into the app, run with
+//   ImguiBase --bench <name> [args...]
+// Each benchmark registers itself from its own translation unit.
+namespace Bench
+{
+    using Fn = std::function<int(const std::vector<std::string>& args)>;
+
+    inline std::map<std::string, Fn>& Registry()
+    {
+        static std::map<std::string, Fn> registry;
+        return registry;
+    }
+
+    struct Register
+    {
+        Register(const char* name, Fn fn) { Registry()[name] = std::move(fn); }
+    };
+
+    template <typename F>
+    double TimeMs(F&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Best of several runs, to keep noise out of the comparisons.
+    template <typename F>
+    double BestMs(int runs, F&& f)
+    {
+        double best = 1e300;
+        for (int i = 0; i < runs; i++)
+            best = std::min(best, TimeMs(f));
+        return best;
+    }
+
+    // Peak resident set in KiB, 0 where unsupported.
+    long PeakRssKb();
+
+    // Hidden window with a current 4.5 core context for benchmarks that touch the GPU.
+    // Check Ok(); machines without a display or driver just skip the GPU part.
+    class GLContext
+    {
+        GLFWwindow* window = nullptr;
+
+    public:
+        GLContext(int width = 512, int height = 512);
+        ~GLContext();
+        GLContext(const GLContext&) = delete;
+        GLContext& operator=(const GLContext&) = delete;
+        bool Ok() const { return window != nullptr; }
+        void Swap();
+    };
+
+    // (n+1) x (n+1) vertices on the wavy height field y = sin(0.05x) cos(0.07z), 0.1 apart, with
+    // texcoords running 0..1 across it and two triangles {a, c, b, b, c, d} per quad.
+    ImguiBase::Mesh GridMesh(uint32_t n);
+
+    enum class GridObj
+    {
+        Plain,      // v, vt and vn per vertex, then the faces
+        FacesFirst, // the faces before the vertices they use
+        Mixed,      // every face corner form, tabs and some vertex colors
+    };
+
+    // Writes the GridMesh grid as an OBJ file.
+    void WriteGridObj(const std::filesystem::path& path, uint32_t n, GridObj style = GridObj::Plain);
+
+    inline size_t ArgOr(const std::vector<std::string>& args, size_t i, size_t fallback)
+    {
+        return i < args.size() ? std::stoull(args[i]) : fallback;
+    }
+
+    // Returns the process exit code; lists the benchmarks when the name is unknown.
+    inline int Run(const std::string& name, const std::vector<std::string>& args)
+    {
+        auto it = Registry().find(name);
+        if (it == Registry().end())
+        {
+            fprintf(stderr, "Unknown benchmark '%s'. Available:\n", name.c_str());
+            for (auto& [n, fn] : Registry())
+                fprintf(stderr, "  %s\n", n.c_str());
+            return 1;
+        }
+        return it->second(args);
+    }
+}
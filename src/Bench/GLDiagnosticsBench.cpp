@@ -0,0 +1,44 @@
+#include "Bench.h"
+#include "GLDiagnostics.h"
+#include <memory>
+
+// Inserts application messages with ignored and allowed ids and checks that only the allowed
+// ones come out of Drain(), and that Init() itself raised no GL error.
+static Bench::Register glDiagnosticsBench("gl-diagnostics", [](const std::vector<std::string> &args)
+{
+    const size_t repeats = Bench::ArgOr(args, 0, 8);
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    const GLuint ignoredId = 0x1234, allowedId = 0x1235;
+    GLDiagnosticsSettings settings;
+    settings.mode = GLDebugMode::Async;
+    settings.ignoredIds = {ignoredId};
+    auto diagnostics = std::make_unique<GLDiagnostics>();
+    while (glGetError() != GL_NO_ERROR)
+        ;
+    diagnostics->Init(settings);
+    const GLenum initError = glGetError();
+
+    for (size_t i = 0; i < repeats; i++)
+    {
+        glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, ignoredId, GL_DEBUG_SEVERITY_HIGH, -1,
+                             "gl-diagnostics: ignored id, must not be printed");
+        glDebugMessageInsert(GL_DEBUG_SOURCE_THIRD_PARTY, GL_DEBUG_TYPE_PERFORMANCE, ignoredId, GL_DEBUG_SEVERITY_HIGH, -1,
+                             "gl-diagnostics: ignored id, must not be printed");
+    }
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_OTHER, allowedId, GL_DEBUG_SEVERITY_HIGH, -1,
+                         "gl-diagnostics: allowed id");
+    glFinish();
+    diagnostics->Drain();
+    glDebugMessageCallback(nullptr, nullptr);
+
+    const GLDiagnostics::Stats stats = diagnostics->GetStats();
+    const bool ok = initError == GL_NO_ERROR && stats.printed == 1 && stats.deduplicated == 0;
+    printf("gl-diagnostics: %zu x 2 messages with ignored id 0x%x, 1 with id 0x%x\n", repeats, ignoredId, allowedId);
+    printf("  Init GL error 0x%x, printed %llu, deduplicated %llu\n", initError, (unsigned long long)stats.printed,
+           (unsigned long long)stats.deduplicated);
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
@@ -0,0 +1,106 @@
+#include "Bench.h"
+#include "Extra/Geometry.h"
+#include "Extra/Mesh.h"
+#include <algorithm>
+#include <thread>
+
+using namespace ImguiBase;
+
+// Geometry kernels against the scalar loops Mesh used before, on a wavy `n` x `n` height field:
+// first checks that they agree, then times each kernel at 1, 2, 4, ... threads up to the core count.
+
+static void ReferenceNormals(const std::vector<vec3> &positions, const std::vector<uint32_t> &indices, std::vector<vec3> &normals)
+{
+    std::fill(normals.begin(), normals.end(), vec3(0));
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        vec3 verts[] = {positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]};
+        vec3 edges[3] = {normalize(verts[0] - verts[2]), normalize(verts[0] - verts[1]), normalize(verts[1] - verts[2])};
+        const vec3 normal = normalize(cross(edges[1], edges[0]));
+        for (int v = 0; v < 3; v++)
+            normals[indices[i + v]] += normal * length(cross(edges[v], edges[(v + 1) % 3]));
+    }
+    for (auto &n : normals)
+        n = normalize(n);
+}
+
+static Geometry::Bounds ReferenceBounds(const std::vector<vec3> &positions)
+{
+    Geometry::Bounds bounds;
+    for (const vec3 &p : positions)
+    {
+        bounds.min = min(bounds.min, p);
+        bounds.max = max(bounds.max, p);
+    }
+    return bounds;
+}
+
+static vec3 ReferenceCentroid(const std::vector<vec3> &positions)
+{
+    vec3 sum(0);
+    for (const vec3 &p : positions)
+        sum += p;
+    return sum / float(positions.size());
+}
+
+static Bench::Register geometryBench("geometry", [](const std::vector<std::string> &args)
+{
+    const uint32_t n = uint32_t(Bench::ArgOr(args, 0, 1000));
+    const Mesh grid = Bench::GridMesh(n);
+    std::vector<vec3> positions;
+    positions.reserve(grid.GetVerticies().size());
+    for (const Vertex &v : grid.GetVerticies())
+        positions.push_back(v.Position);
+    const std::vector<uint32_t> &indices = grid.GetIndicies();
+    printf("geometry: %zu vertices, %zu triangles\n", positions.size(), indices.size() / 3);
+
+    // correctness against the old loops, with at least 4 chunks so the reductions are exercised
+    const unsigned checkThreads = std::max(4u, std::thread::hardware_concurrency());
+    std::vector<vec3> expected(positions.size()), normals(positions.size());
+    const double referenceNormalsMs = Bench::TimeMs([&]() { ReferenceNormals(positions, indices, expected); });
+    Geometry::ComputeNormals(positions, indices, normals, checkThreads);
+    float worstDot = 1.0f;
+    for (size_t i = 0; i < normals.size(); i++)
+        worstDot = std::min(worstDot, dot(normals[i], expected[i]));
+
+    const Geometry::Bounds bounds = Geometry::ComputeBounds(positions, checkThreads), refBounds = ReferenceBounds(positions);
+    const bool boundsMatch = bounds.min == refBounds.min && bounds.max == refBounds.max;
+
+    // the old float running sum drifts on large meshes; measure both against a double sum
+    dvec3 exactSum(0.0);
+    for (const vec3 &p : positions)
+        exactSum += dvec3(p);
+    const vec3 exact = vec3(exactSum / double(positions.size()));
+    const float centroidError = length(Geometry::ComputeCentroid(positions, checkThreads) - exact);
+    const float referenceCentroidError = length(ReferenceCentroid(positions) - exact);
+
+    const bool ok = worstDot > 0.99999f && boundsMatch && centroidError <= 1e-5f * length(refBounds.max - refBounds.min);
+    printf("  normals worst dot %.7f, bounds %s, centroid error %g (old float sum %g) -> %s\n", worstDot,
+           boundsMatch ? "exact" : "DIFFER", centroidError, referenceCentroidError, ok ? "OK" : "MISMATCH");
+
+    Geometry::Bounds sinkBounds;
+    vec3 sinkCentroid(0);
+    const double referenceBoundsMs = Bench::BestMs(3, [&]() { sinkBounds = ReferenceBounds(positions); });
+    const double referenceCentroidMs = Bench::BestMs(3, [&]() { sinkCentroid = ReferenceCentroid(positions); });
+    printf("  scalar reference: normals %.2f ms, bounds %.2f ms, centroid %.2f ms (%g)\n", referenceNormalsMs,
+           referenceBoundsMs, referenceCentroidMs, sinkBounds.max.x + sinkCentroid.x);
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < cores; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(cores);
+
+    printf("  threads   normals    bounds  centroid  translate    scale   (ms)\n");
+    std::vector<vec3> scratch = positions;
+    for (unsigned threads : threadCounts)
+    {
+        const double normalsMs = Bench::BestMs(3, [&]() { Geometry::ComputeNormals(positions, indices, normals, threads); });
+        const double boundsMs = Bench::BestMs(3, [&]() { Geometry::ComputeBounds(positions, threads); });
+        const double centroidMs = Bench::BestMs(3, [&]() { Geometry::ComputeCentroid(positions, threads); });
+        const double translateMs = Bench::BestMs(3, [&]() { Geometry::Translate(scratch, vec3(1, 2, 3), threads); });
+        const double scaleMs = Bench::BestMs(3, [&]() { Geometry::Scale(scratch, 1.0001f, threads); });
+        printf("  %7u  %8.2f  %8.2f  %8.2f  %9.2f  %7.2f\n", threads, normalsMs, boundsMs, centroidMs, translateMs, scaleMs);
+    }
+    return ok ? 0 : 1;
+});
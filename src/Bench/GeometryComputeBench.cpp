@@ -0,0 +1,85 @@
+#include "Bench.h"
+#include "Extra/GeometryCompute.h"
+#include <cstring>
+
+using namespace ImguiBase;
+
+// GeometryCompute against the CPU path it replaces (Mesh::CalculateNormals, then uploading the
+// vertices again) on a wavy `n` x `n` height field. Checks the normals written to the vertex
+// buffer and the reduction against the CPU kernels, plus a vertex shared by more faces than the
+// fixed-point normal sum holds at full precision. Works on Mesa llvmpipe without a GPU.
+static Bench::Register geometryComputeBench("geometry-compute", [](const std::vector<std::string> &args)
+{
+    const uint32_t n = uint32_t(Bench::ArgOr(args, 0, 1000));
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    GeometryCompute compute;
+    const Mesh source = Bench::GridMesh(n);
+    printf("geometry-compute: %zu vertices, %zu triangles, %s\n", source.GetVerticies().size(),
+           source.GetIndicies().size() / 3, compute.UsesGpu() ? "compute shaders" : "CPU fallback");
+
+    Mesh reference = source;
+    GL_Mesh cpuMesh(source);
+    glFinish();
+    const double cpuMs = Bench::TimeMs([&]()
+    {
+        reference.CalculateNormals();
+        cpuMesh = reference;
+        glFinish();
+    });
+
+    GL_Mesh gpuMesh(source);
+    compute.CalculateNormals(gpuMesh); // warm up shader compilation
+    glFinish();
+    const double gpuMs = Bench::BestMs(3, [&]()
+    {
+        compute.CalculateNormals(gpuMesh);
+        glFinish();
+    });
+
+    std::vector<Vertex> written(gpuMesh.GetVertexCount());
+    glGetNamedBufferSubData(gpuMesh.GetVertexBuffer(), 0, written.size() * sizeof(Vertex), written.data());
+    float worstDot = 1.0f;
+    for (size_t i = 0; i < written.size(); i++)
+        worstDot = std::min(worstDot, dot(written[i].Normal, reference.GetVerticies()[i].Normal));
+
+    std::vector<vec3> positions;
+    for (const Vertex &v : source.GetVerticies())
+        positions.push_back(v.Position);
+    const Geometry::Bounds bounds = Geometry::ComputeBounds(positions);
+    const vec3 centroid = Geometry::ComputeCentroid(positions);
+    GeometryCompute::Reduction reduction;
+    const double reduceMs = Bench::BestMs(3, [&]() { reduction = compute.Reduce(gpuMesh).Get(); });
+    const bool boundsMatch = reduction.bounds.min == bounds.min && reduction.bounds.max == bounds.max;
+    const float centroidError = length(reduction.centroid - centroid);
+
+    // 3000 copies of one triangle: each corner sums well past the 2047 faces 20 fractional bits hold
+    Mesh stacked;
+    std::vector<Vertex> stackVertices(3);
+    stackVertices[1].Position = vec3(1, 0, 0);
+    stackVertices[2].Position = vec3(0.5f, 0, 0.866f);
+    stacked.SetVerticies(stackVertices);
+    std::vector<GLuint> stackIndices;
+    for (int i = 0; i < 3000; i++)
+        stackIndices.insert(stackIndices.end(), {0, 2, 1});
+    stacked.SetIndicies(stackIndices);
+    GL_Mesh stackedMesh(stacked);
+    compute.CalculateNormals(stackedMesh);
+    stacked.CalculateNormals();
+    std::vector<Vertex> stackWritten(3);
+    glGetNamedBufferSubData(stackedMesh.GetVertexBuffer(), 0, sizeof(Vertex) * 3, stackWritten.data());
+    float stackDot = 1.0f;
+    for (size_t i = 0; i < 3; i++)
+        stackDot = std::min(stackDot, dot(stackWritten[i].Normal, stacked.GetVerticies()[i].Normal));
+
+    const bool ok = worstDot > 0.9999f && stackDot > 0.9999f && boundsMatch && centroidError < 1e-3f;
+    printf("  CPU normals + re-upload : %8.2f ms\n", cpuMs);
+    printf("  GPU normals             : %8.2f ms (worst dot vs CPU %.6f)\n", gpuMs, worstDot);
+    printf("  3000 stacked faces      : worst dot vs CPU %.6f\n", stackDot);
+    printf("  GPU bounds + centroid   : %8.2f ms including readback (bounds %s, centroid error %g)\n", reduceMs,
+           boundsMatch ? "exact" : "DIFFER", centroidError);
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
@@ -0,0 +1,160 @@
+#include "Bench.h"
+#include "Extra/MeshBatch.h"
+#include "Extra/Program.h"
+#include "Extra/Texture.h"
+#include <cmath>
+#include <memory>
+
+using namespace ImguiBase;
+
+// `instances` copies of `meshes` small distinct meshes, drawn once as one GL_Mesh::Draw per
+// instance and once through MeshBatch. Both render into an offscreen target that is compared
+// pixel for pixel; reports draw calls and CPU submit time per frame.
+static Mesh Ring(uint32_t segments, float radius)
+{
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    for (uint32_t i = 0; i <= segments; i++)
+    {
+        const float a = 6.2831853f * i / segments;
+        for (float r : {radius * 0.6f, radius})
+        {
+            Vertex v{};
+            v.Position = vec3(std::cos(a) * r, std::sin(a) * r, 0);
+            v.Color = vec4(0.5f + 0.5f * std::cos(a), 0.5f + 0.5f * std::sin(a), r, 1);
+            vertices.push_back(v);
+        }
+        if (i < segments)
+        {
+            const GLuint b = i * 2;
+            indices.insert(indices.end(), {b, b + 1, b + 2, b + 2, b + 1, b + 3});
+        }
+    }
+    Mesh mesh;
+    mesh.SetVerticies(std::move(vertices));
+    mesh.SetIndicies(std::move(indices));
+    return mesh;
+}
+
+static const char *FragmentSource = R"(#version 450 core
+in vec4 vColor;
+out vec4 FragColor;
+void main() { FragColor = vColor; }
+)";
+
+static const char *SingleVertexSource = R"(#version 450 core
+layout(location = 0) in vec3 aPos;
+layout(location = 3) in vec4 aColor;
+uniform mat4 uTransform;
+uniform vec4 uColor;
+out vec4 vColor;
+void main()
+{
+    gl_Position = uTransform * vec4(aPos, 1.0);
+    vColor = aColor * uColor;
+}
+)";
+
+static const char *BatchVertexSource = R"(#version 450 core
+layout(location = 0) in vec3 aPos;
+layout(location = 3) in vec4 aColor;
+layout(location = 4) in uint aInstance;
+struct Instance { mat4 transform; vec4 color; };
+layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+out vec4 vColor;
+void main()
+{
+    Instance instance = instances[aInstance];
+    gl_Position = instance.transform * vec4(aPos, 1.0);
+    vColor = aColor * instance.color;
+}
+)";
+
+static Bench::Register meshBatchBench("mesh-batch", [](const std::vector<std::string> &args)
+{
+    const size_t meshCount = Bench::ArgOr(args, 0, 64);
+    const size_t instanceCount = Bench::ArgOr(args, 1, 4096);
+    const size_t frames = Bench::ArgOr(args, 2, 20);
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    const uvec2 size(256, 256);
+    Texture target;
+    target.Alloc2DStorage(size, GL_RGBA8);
+    GLuint fbo;
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, target.GetHandle(), 0);
+
+    std::vector<Mesh> meshes;
+    for (size_t m = 0; m < meshCount; m++)
+        meshes.push_back(Ring(8 + uint32_t(m % 24), 1.0f));
+    std::vector<MeshBatch::Instance> instances(instanceCount);
+    std::vector<size_t> meshOf(instanceCount);
+    const uint32_t side = uint32_t(std::ceil(std::sqrt(double(instanceCount))));
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        const float x = (i % side + 0.5f) / side * 2 - 1, y = (i / side + 0.5f) / side * 2 - 1;
+        instances[i].transform = translate(mat4(1.0f), vec3(x, y, 0)) * scale(mat4(1.0f), vec3(0.9f / side));
+        instances[i].color = vec4(float(i % 7) / 6, float(i % 5) / 4, 1, 1);
+        meshOf[i] = (i * 2654435761u) % meshCount;
+    }
+
+    auto render = [&](auto &&draw) -> std::pair<double, std::vector<uint8_t>>
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, size.x, size.y);
+        double submitMs = 0;
+        for (size_t f = 0; f < frames; f++)
+        {
+            glClearColor(0, 0, 0, 1);
+            glClear(GL_COLOR_BUFFER_BIT);
+            submitMs += Bench::TimeMs(draw);
+            context.Swap();
+            glFinish(); // keep the previous frame's rendering out of the next submit time
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        std::vector<uint8_t> pixels(size_t(size.x) * size.y * 4);
+        target.GetData(pixels.data(), pixels.size());
+        return {submitMs / frames, pixels};
+    };
+
+    Program single({{eVertex, SingleVertexSource}, {eFragment, FragmentSource}}, true);
+    std::vector<std::unique_ptr<GL_Mesh>> glMeshes;
+    for (const Mesh &mesh : meshes)
+        glMeshes.push_back(std::make_unique<GL_Mesh>(mesh));
+    const auto [singleMs, singlePixels] = render([&]()
+    {
+        single.Use();
+        for (size_t i = 0; i < instanceCount; i++)
+        {
+            single.PushUniform("uTransform", instances[i].transform);
+            single.PushUniform("uColor", instances[i].color);
+            glMeshes[meshOf[i]]->Draw();
+        }
+    });
+
+    Program batched({{eVertex, BatchVertexSource}, {eFragment, FragmentSource}}, true);
+    MeshBatch batch;
+    std::vector<MeshBatch::MeshId> ids;
+    for (const Mesh &mesh : meshes)
+        ids.push_back(batch.AddMesh(mesh));
+    for (size_t i = 0; i < instanceCount; i++)
+        batch.AddInstance(ids[meshOf[i]], instances[i]);
+    const auto [batchMs, batchPixels] = render([&]()
+    {
+        batched.Use();
+        batch.Draw();
+    });
+    glDeleteFramebuffers(1, &fbo);
+
+    size_t differing = 0;
+    for (size_t p = 0; p < singlePixels.size(); p++)
+        differing += singlePixels[p] != batchPixels[p];
+    const auto &stats = batch.GetStats();
+    printf("mesh-batch: %zu meshes, %zu instances, %zu frames\n", meshCount, instanceCount, frames);
+    printf("  GL_Mesh::Draw : %6zu draw calls, %8.3f ms submit per frame\n", instanceCount, singleMs);
+    printf("  MeshBatch     : %6zu draw call (%zu indirect commands), %8.3f ms submit per frame\n", stats.drawCalls, stats.commands, batchMs);
+    printf("  images %s (%zu bytes differ)\n", differing ? "DIFFER" : "match", differing);
+    return differing ? 1 : 0;
+});
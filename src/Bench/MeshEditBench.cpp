@@ -0,0 +1,136 @@
+#include "Bench.h"
+#include "Extra/Mesh.h"
+#include <cstring>
+
+using namespace ImguiBase;
+
+// Mesh dirty tracking: how many flushes batched and copied meshes issue, then, when a GL
+// context is available, that GL_Mesh buffers (plain and persistent ring) match the CPU copy
+// after `frames` frames of sub-range edits on an `n` x `n` grid.
+class CountingMesh : public Mesh
+{
+protected:
+    void FlushChanges() override
+    {
+        flushes++;
+        begin = dirtyBegin;
+        end = dirtyEnd;
+        Mesh::FlushChanges();
+    }
+
+public:
+    int flushes = 0;
+    size_t begin = 0, end = 0;
+
+    // the counters stay with each object, only Mesh's own copy is under test
+    CountingMesh() {}
+    CountingMesh(const CountingMesh &mesh) : Mesh(mesh) {}
+    CountingMesh(CountingMesh &&mesh) : Mesh(std::move(mesh)) {}
+    CountingMesh(const Mesh &mesh) : Mesh(mesh) {}
+    CountingMesh &operator=(const CountingMesh &mesh)
+    {
+        Mesh::operator=(mesh);
+        return *this;
+    }
+};
+
+static bool Check(const char *what, bool ok)
+{
+    printf("  %-44s: %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// what the vertex binding currently reads, against the CPU copy
+static bool BufferMatches(const GL_Mesh &mesh)
+{
+    const auto &verticies = mesh.GetVerticies();
+    GLint64 offset = 0;
+    mesh.Use();
+    glGetInteger64i_v(GL_VERTEX_BINDING_OFFSET, 0, &offset);
+    mesh.UnUse();
+    std::vector<Vertex> gpu(verticies.size());
+    glGetNamedBufferSubData(mesh.GetVertexBuffer(), offset, gpu.size() * sizeof(Vertex), gpu.data());
+    return memcmp(gpu.data(), verticies.data(), gpu.size() * sizeof(Vertex)) == 0;
+}
+
+static Bench::Register meshEditBench("mesh-edit", [](const std::vector<std::string> &args)
+{
+    const uint32_t n = uint32_t(Bench::ArgOr(args, 0, 64));
+    const int frames = int(Bench::ArgOr(args, 1, 8));
+    const Mesh grid = Bench::GridMesh(n);
+    const size_t vertexCount = grid.GetVerticies().size();
+    printf("mesh-edit: %zu vertices, %d frames\n", vertexCount, frames);
+    bool ok = true;
+
+    CountingMesh mesh(grid);
+    {
+        Mesh::Batch batch(mesh);
+        mesh.Centerize();
+        mesh.FitToBounds(2.0f);
+        mesh.CalculateNormals();
+    }
+    ok &= Check("batched Centerize/FitToBounds/Normals", mesh.flushes == 1);
+
+    mesh.flushes = 0;
+    const Vertex edit = grid.GetVerticies()[0];
+    {
+        Mesh::Batch batch(mesh);
+        mesh.UpdateVerticies(10, &edit, 1);
+        mesh.UpdateVerticies(40, &edit, 1);
+    }
+    ok &= Check("two sub-range edits, one flush of the union", mesh.flushes == 1 && mesh.begin == 10 && mesh.end == 41);
+
+    // copies of a mesh mid-batch take neither its batch depth nor its pending range
+    CountingMesh copy, assigned;
+    mesh.flushes = 0;
+    mesh.BeginBatch();
+    mesh.UpdateVerticies(5, &edit, 1);
+    {
+        CountingMesh constructed(mesh);
+        constructed.MarkIndiciesDirty();
+        ok &= Check("copy takes neither batch depth nor range", constructed.flushes == 1 && constructed.end == 0);
+    }
+    assigned = mesh;
+    ok &= Check("assignment flushes everything at once", assigned.flushes == 1 && assigned.end == vertexCount);
+    copy.BeginBatch();
+    copy = mesh;
+    ok &= Check("assignment inside a batch waits for its end", copy.flushes == 0);
+    copy.EndBatch();
+    ok &= Check("  ... then flushes once", copy.flushes == 1);
+    {
+        CountingMesh moved(std::move(mesh));
+        mesh.EndBatch();
+        ok &= Check("moved-from mesh drops its pending range", mesh.flushes == 0 && moved.flushes == 0);
+    }
+
+    Bench::GLContext context;
+    if (!context.Ok())
+        return ok ? 0 : 1;
+
+    for (const bool persistent : {false, true})
+    {
+        GL_Mesh glMesh(grid, {VertexLayout::Float, false, persistent});
+        bool same = true;
+        for (int f = 0; f < frames; f++)
+        {
+            Mesh::Batch batch(glMesh);
+            Vertex v = glMesh.GetVerticies()[f];
+            v.Position.y += 1.0f;
+            glMesh.UpdateVerticies(f, &v, 1);
+            glMesh.UpdateVerticies(vertexCount - 1 - f, &v, 1);
+            if (f == frames / 2)
+                glMesh.Centerize();
+        }
+        for (int f = 0; f < frames; f++)
+        {
+            Vertex v = glMesh.GetVerticies()[f];
+            v.Color.x = f / float(frames);
+            glMesh.UpdateVerticies(f, &v, 1);
+            glMesh.Draw();
+            same &= BufferMatches(glMesh);
+        }
+        ok &= Check(persistent ? "persistent ring matches the CPU copy" : "buffer matches the CPU copy", same);
+    }
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
@@ -0,0 +1,131 @@
+#include "Bench.h"
+#include "Extra/MeshLoader.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace ImguiBase;
+namespace fs = std::filesystem;
+
+// Mesh::FromOBJ against MeshLoader on a generated `n` x `n` OBJ, parsed and then from the mesh
+// cache. Reports how long FromOBJ blocks against the slowest per-frame Update, checks that the
+// uploaded buffers and the cache file match FromOBJ exactly, then loads a file whose faces come
+// before their vertices and cancels a load half way.
+static bool MatchesMesh(const GL_Mesh &loaded, const Mesh &reference)
+{
+    const auto &vertices = reference.GetVerticies();
+    const auto &indices = reference.GetIndicies();
+    if (loaded.GetVertexCount() != vertices.size() || loaded.GetIndexCount() != indices.size())
+        return false;
+    std::vector<Vertex> gpuVertices(vertices.size());
+    std::vector<GLuint> gpuIndices(indices.size());
+    glGetNamedBufferSubData(loaded.GetVertexBuffer(), 0, gpuVertices.size() * sizeof(Vertex), gpuVertices.data());
+    glGetNamedBufferSubData(loaded.GetIndexBuffer(), 0, gpuIndices.size() * sizeof(GLuint), gpuIndices.data());
+    return memcmp(gpuVertices.data(), vertices.data(), gpuVertices.size() * sizeof(Vertex)) == 0 &&
+           memcmp(gpuIndices.data(), indices.data(), gpuIndices.size() * sizeof(GLuint)) == 0;
+}
+
+struct LoadRun
+{
+    size_t frames = 0, firstDrawFrame = 0;
+    double totalMs = 0, worstUpdateMs = 0;
+    std::shared_ptr<MeshLoader::Request> request;
+};
+
+// one Update per simulated 60 Hz frame until the request finishes; cancels after `cancelAfter` frames
+static std::string ReadBytes(const fs::path &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+static LoadRun RunLoad(MeshLoader &loader, const std::string &path, size_t budget, size_t cancelAfter = SIZE_MAX)
+{
+    LoadRun run;
+    const auto start = std::chrono::steady_clock::now();
+    run.request = loader.Load(path);
+    while (!run.request->Finished())
+    {
+        run.worstUpdateMs = std::max(run.worstUpdateMs, Bench::TimeMs([&]() { loader.Update(budget); glFinish(); }));
+        run.frames++;
+        if (!run.firstDrawFrame && run.request->GetProgress().indices > 0)
+            run.firstDrawFrame = run.frames;
+        if (run.frames == cancelAfter)
+            loader.Cancel(run.request);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    run.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+static Bench::Register meshLoaderBench("mesh-load", [](const std::vector<std::string> &args)
+{
+    const uint32_t n = uint32_t(Bench::ArgOr(args, 0, 600));
+    const size_t budget = Bench::ArgOr(args, 1, 4) << 20;
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    const fs::path path = fs::temp_directory_path() / "bench_mesh_load.obj";
+    const fs::path reversed = fs::temp_directory_path() / "bench_mesh_load_reversed.obj";
+    Bench::WriteGridObj(path, n);
+    Bench::WriteGridObj(reversed, 64, Bench::GridObj::FacesFirst);
+    auto dropCaches = [&]()
+    {
+        std::error_code ec;
+        fs::remove(MeshCache::PathFor(path.string()), ec);
+        fs::remove(MeshCache::PathFor(reversed.string()), ec);
+    };
+
+    dropCaches();
+    bool colorsFound;
+    Mesh reference;
+    const double blockingMs = Bench::TimeMs([&]() { reference = Mesh::FromOBJ(path.string(), colorsFound); });
+    const std::string fromObjCache = ReadBytes(MeshCache::PathFor(path.string()));
+
+    MeshLoader loader(1, 1u << 20, 64u << 20);
+    dropCaches();
+    const LoadRun parsed = RunLoad(loader, path.string(), budget);
+    // written chunk by chunk, but it has to come out as the file FromOBJ writes in one go
+    const bool cacheOk = ReadBytes(MeshCache::PathFor(path.string())) == fromObjCache;
+    const bool parsedOk = parsed.request->GetState() == MeshLoader::State::Done && MatchesMesh(*parsed.request->GetMesh(), reference);
+    const LoadRun cached = RunLoad(loader, path.string(), budget);
+    const bool cachedOk = cached.request->GetState() == MeshLoader::State::Done && MatchesMesh(*cached.request->GetMesh(), reference);
+
+    dropCaches();
+    const Mesh reversedReference = Mesh::FromOBJ(reversed.string(), colorsFound);
+    dropCaches();
+    const LoadRun forward = RunLoad(loader, reversed.string(), budget);
+    const bool forwardOk = forward.request->GetState() == MeshLoader::State::Done &&
+                           MatchesMesh(*forward.request->GetMesh(), reversedReference);
+
+    dropCaches();
+    const LoadRun cancelled = RunLoad(loader, path.string(), budget / 8, 3);
+    const bool cancelOk = cancelled.request->GetState() == MeshLoader::State::Cancelled &&
+                          cancelled.request->GetMesh()->GetIndexCount() < reference.GetIndicies().size() &&
+                          loader.GetStats().active == 0 && loader.GetStats().queuedBytes == 0;
+
+    dropCaches();
+    fs::remove(path);
+    fs::remove(reversed);
+
+    const bool ok = parsedOk && cacheOk && cachedOk && forwardOk && cancelOk;
+    printf("mesh-load: %zu vertices, %zu triangles, %zu MB upload budget per frame\n", reference.GetVerticies().size(),
+           reference.GetIndicies().size() / 3, budget >> 20);
+    printf("  Mesh::FromOBJ       : %8.2f ms blocked\n", blockingMs);
+    auto report = [](const char *name, const LoadRun &run, bool match)
+    {
+        printf("  %-19s : %8.2f ms over %4zu frames, first draw at frame %zu, slowest Update %6.2f ms, %s\n", name,
+               run.totalMs, run.frames, run.firstDrawFrame, run.worstUpdateMs, match ? "matches FromOBJ" : "MISMATCH");
+    };
+    report("MeshLoader parsed", parsed, parsedOk);
+    printf("  streamed cache file : %s\n", cacheOk ? "identical to FromOBJ's" : "DIFFERS");
+    report("MeshLoader cached", cached, cachedOk);
+    report("faces before verts", forward, forwardOk);
+    printf("  cancel after 3 frames: %s (%zu of %zu indices uploaded)\n", cancelOk ? "stopped" : "FAILED",
+           cancelled.request->GetMesh()->GetIndexCount(), reference.GetIndicies().size());
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
@@ -0,0 +1,171 @@
+#include "Bench.h"
+#include "Extra/Mesh.h"
+#include "Extra/Program.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ImguiBase;
+
+// GL_Mesh::GenerateLods on a bumpy UV sphere of `rings` x `rings` quads (a texture seam and
+// two poles to keep intact): triangles, error and draw time per level and the level SelectLod
+// picks by distance. Checks the chain built from a CPU copy against one read back from the
+// buffers and a 16 bit index buffer, and that replacing the indices drops it.
+// Bench::GridMesh wrapped around a unit sphere through its texcoords
+static Mesh BumpySphere(uint32_t rings)
+{
+    Mesh mesh = Bench::GridMesh(rings);
+    std::vector<Vertex> vertices = mesh.GetVerticies();
+    for (Vertex &vert : vertices)
+    {
+        const float theta = vert.TexCoord.x * 6.2831853f, phi = vert.TexCoord.y * 3.1415927f;
+        const vec3 dir(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+        vert.Position = dir * (1.0f + 0.05f * std::sin(theta * 5) * std::sin(phi * 4));
+        vert.Normal = dir;
+    }
+    mesh.SetVerticies(std::move(vertices));
+    return mesh;
+}
+
+static const char *VertexSource = R"(#version 450 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+uniform mat4 uTransform;
+out vec3 vColor;
+void main()
+{
+    gl_Position = uTransform * vec4(aPos, 1.0);
+    vColor = aNormal * 0.5 + 0.5;
+})";
+
+static const char *FragmentSource = R"(#version 450 core
+in vec3 vColor;
+out vec4 outColor;
+void main() { outColor = vec4(vColor, 1.0); })";
+
+// every index of every level, widened to 32 bit, as the GPU holds them
+static std::vector<GLuint> ReadLods(const GL_Mesh &mesh)
+{
+    std::vector<GLuint> all;
+    const bool narrow = mesh.GetIndexType() == GL_UNSIGNED_SHORT;
+    for (size_t level = 1; level < mesh.GetLodCount(); level++)
+    {
+        const MeshLod lod = mesh.GetLod(level);
+        std::vector<uint16_t> shorts(narrow ? lod.indexCount : 0);
+        std::vector<GLuint> ints(narrow ? 0 : lod.indexCount);
+        if (narrow)
+            glGetNamedBufferSubData(mesh.GetIndexBuffer(), lod.firstIndex * 2, lod.indexCount * 2, shorts.data());
+        else
+            glGetNamedBufferSubData(mesh.GetIndexBuffer(), lod.firstIndex * 4, lod.indexCount * 4, ints.data());
+        all.insert(all.end(), shorts.begin(), shorts.end());
+        all.insert(all.end(), ints.begin(), ints.end());
+    }
+    return all;
+}
+
+static double DrawMs(const GL_Mesh &mesh, size_t level, int draws)
+{
+    GLuint query;
+    glGenQueries(1, &query);
+    double best = 1e300;
+    for (int batch = 0; batch < 3; batch++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        for (int i = 0; i < draws; i++)
+            mesh.DrawLod(level);
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        best = std::min(best, ns / 1e6 / draws);
+    }
+    glDeleteQueries(1, &query);
+    return best;
+}
+
+static Bench::Register meshLodBench("mesh-lod", [](const std::vector<std::string> &args)
+{
+    const uint32_t rings = uint32_t(Bench::ArgOr(args, 0, 400));
+    const int draws = int(Bench::ArgOr(args, 1, 20));
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    const Mesh source = BumpySphere(rings);
+    GL_Mesh mesh(source);
+    size_t levels = 0;
+    const double generateMs = Bench::TimeMs([&]() { levels = mesh.GenerateLods(); });
+
+    // structure: fewer triangles and more error at each level, every index in range
+    bool chainOk = levels > 0 && mesh.GetLodCount() == levels + 1;
+    const std::vector<GLuint> lodIndices = ReadLods(mesh);
+    for (GLuint i : lodIndices)
+        chainOk = chainOk && i < source.GetVerticies().size();
+    for (size_t level = 1; level < mesh.GetLodCount(); level++)
+        chainOk = chainOk && mesh.GetLod(level).indexCount < mesh.GetLod(level - 1).indexCount &&
+                  mesh.GetLod(level).error >= mesh.GetLod(level - 1).error;
+
+    // the same chain from the buffers alone, as for LoadOBJ and MeshLoader meshes
+    GL_Mesh gpuOnly;
+    gpuOnly.ReserveGpu(source.GetVerticies().size(), source.GetIndicies().size());
+    gpuOnly.WriteGpuVertices(0, source.GetVerticies().data(), source.GetVerticies().size());
+    gpuOnly.WriteGpuIndices(0, source.GetIndicies().data(), source.GetIndicies().size());
+    gpuOnly.GenerateLods();
+    const bool readbackOk = ReadLods(gpuOnly) == lodIndices;
+
+    GL_Mesh narrow(BumpySphere(std::min<uint32_t>(rings, 200)), {VertexLayout::Packed, true});
+    GL_Mesh wide(BumpySphere(std::min<uint32_t>(rings, 200)));
+    const bool narrowOk = narrow.GetIndexType() == GL_UNSIGNED_SHORT && narrow.GenerateLods() > 0 &&
+                          wide.GenerateLods() == narrow.GetLodCount() - 1 && ReadLods(narrow) == ReadLods(wide);
+
+    GL_Mesh dropped(source);
+    dropped.GenerateLods(1);
+    const size_t bytesWithLods = dropped.GpuBytes();
+    dropped.SetIndicies(source.GetIndicies());
+    const bool dropOk = dropped.GetLodCount() == 1 && dropped.GpuBytes() < bytesWithLods;
+
+    const uvec2 size(512, 512);
+    GLuint fbo, color, depth;
+    glCreateRenderbuffers(1, &color);
+    glNamedRenderbufferStorage(color, GL_RGBA8, size.x, size.y);
+    glCreateRenderbuffers(1, &depth);
+    glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, size.x, size.y);
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferRenderbuffer(fbo, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glNamedFramebufferRenderbuffer(fbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, size.x, size.y);
+    glEnable(GL_DEPTH_TEST);
+    Program program({{eVertex, VertexSource}, {eFragment, FragmentSource}}, true);
+    mat4 transform(0.9f);
+    transform[3][3] = 1.0f;
+    program.PushUniform("uTransform", transform);
+    program.Use();
+
+    const bool ok = chainOk && readbackOk && narrowOk && dropOk;
+    printf("mesh-lod: %zu vertices, %zu triangles, %zu levels generated in %.1f ms\n", source.GetVerticies().size(),
+           source.GetIndicies().size() / 3, levels, generateMs);
+    for (size_t level = 0; level < mesh.GetLodCount(); level++)
+    {
+        const MeshLod lod = mesh.GetLod(level);
+        mesh.DrawLod(level);
+        glFinish();
+        printf("  LOD %zu : %8zu triangles (%5.1f%%), error %.5f, %8.3f ms/draw\n", level, lod.indexCount / 3,
+               100.0 * lod.indexCount / source.GetIndicies().size(), lod.error, DrawMs(mesh, level, draws));
+    }
+    program.Unuse();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depth);
+
+    printf("  SelectLod at 1080p, 60 degrees, 1 px:");
+    for (float distance : {2.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f})
+    {
+        const mat4 modelView = glm::translate(mat4(1.0f), vec3(0, 0, -distance));
+        printf(" %gm->%zu", distance, mesh.SelectLod(modelView, 1080.0f, glm::radians(60.0f)));
+    }
+    printf("\n  chain %s, readback %s, 16 bit %s, dropped on new indices %s\n", chainOk ? "ok" : "FAILED",
+           readbackOk ? "matches" : "MISMATCH", narrowOk ? "matches" : "MISMATCH", dropOk ? "ok" : "FAILED");
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
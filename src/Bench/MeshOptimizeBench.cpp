@@ -0,0 +1,155 @@
+#include "Bench.h"
+#include "Extra/Mesh.h"
+#include "Extra/MeshOptimizer.h"
+#include "Extra/Program.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <random>
+
+using namespace ImguiBase;
+
+// Mesh::Optimize plus the packed/16 bit upload formats: cache miss ratio, GPU bytes and,
+// when a GL context is available, draw time for each vertex layout and index width on its
+// own. Then checks that 16 bit indices are widened once the vertex count outgrows them.
+// Uses an OBJ file when given, otherwise a UV sphere of `rings` x `rings` quads with its
+// triangles shuffled, like an unordered export.
+static Mesh ShuffledSphere(uint32_t rings)
+{
+    Mesh mesh = Bench::GridMesh(rings);
+    std::vector<Vertex> vertices = mesh.GetVerticies();
+    for (Vertex &vert : vertices)
+    {
+        const float u = vert.TexCoord.x, v = vert.TexCoord.y;
+        const float theta = u * 6.2831853f, phi = v * 3.1415927f;
+        vert.Position = vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+        vert.Normal = vert.Position;
+        vert.Color = vec4(u, v, 1, 1);
+    }
+
+    const auto &indices = mesh.GetIndicies();
+    std::vector<std::array<GLuint, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+        triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+    std::vector<GLuint> shuffled;
+    for (const auto &t : triangles)
+        shuffled.insert(shuffled.end(), t.begin(), t.end());
+    mesh.SetVerticies(std::move(vertices));
+    mesh.SetIndicies(std::move(shuffled));
+    return mesh;
+}
+
+static const char *VertexSource = R"(#version 450 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+layout(location = 3) in vec4 aColor;
+uniform mat4 uTransform;
+out vec3 vColor;
+void main()
+{
+    gl_Position = uTransform * vec4(aPos, 1.0);
+    vColor = aNormal * 0.5 + 0.5 + vec3(aTexCoord, 0.0) * 0.01 + aColor.rgb * 0.01;
+})";
+
+static const char *FragmentSource = R"(#version 450 core
+in vec3 vColor;
+out vec4 outColor;
+void main() { outColor = vec4(vColor, 1.0); })";
+
+// Time per draw in ms, best of a few batches of `draws`. Wall clock between two glFinish
+// calls rather than a GL_TIME_ELAPSED query, which some drivers (llvmpipe) report as 0.
+static double DrawMs(const GL_Mesh &mesh, int draws)
+{
+    return Bench::BestMs(5, [&]()
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glFinish();
+        for (int i = 0; i < draws; i++)
+            mesh.Draw();
+        glFinish();
+    }) / draws;
+}
+
+static Bench::Register meshOptimizeBench("mesh-optimize", [](const std::vector<std::string> &args)
+{
+    Mesh original;
+    if (!args.empty() && !std::isdigit((unsigned char)args[0][0]))
+    {
+        bool colorsFound;
+        original = Mesh::FromOBJ(args[0], colorsFound);
+    }
+    else
+        original = ShuffledSphere(uint32_t(Bench::ArgOr(args, 0, 200)));
+
+    Mesh optimized = original;
+    const double optimizeMs = Bench::TimeMs([&]() { optimized.Optimize(); });
+
+    const size_t vertexCount = original.GetVerticies().size();
+    const size_t indexCount = original.GetIndicies().size();
+    const bool shortFits = vertexCount <= 0x10000;
+    const size_t floatBytes = vertexCount * GL_Mesh::VertexStride(VertexLayout::Float) + indexCount * 4;
+    const size_t packedBytes = vertexCount * GL_Mesh::VertexStride(VertexLayout::Packed) + indexCount * (shortFits ? 2 : 4);
+
+    printf("mesh-optimize: %zu vertices, %zu triangles, optimized in %.1f ms\n", vertexCount, indexCount / 3, optimizeMs);
+    printf("  ACMR (FIFO 16)  : %.3f -> %.3f\n", MeshOptimizer::CacheMissRatio(original.GetIndicies(), vertexCount),
+           MeshOptimizer::CacheMissRatio(optimized.GetIndicies(), vertexCount));
+    printf("  ACMR (FIFO 32)  : %.3f -> %.3f\n", MeshOptimizer::CacheMissRatio(original.GetIndicies(), vertexCount, 32),
+           MeshOptimizer::CacheMissRatio(optimized.GetIndicies(), vertexCount, 32));
+    printf("  GPU bytes       : %.2f MiB float/u32 -> %.2f MiB packed/%s (saved %.2f MiB, %.0f%%)\n",
+           floatBytes / 1048576.0, packedBytes / 1048576.0, shortFits ? "u16" : "u32",
+           (floatBytes - packedBytes) / 1048576.0, 100.0 * (floatBytes - packedBytes) / floatBytes);
+
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 0;
+
+    Program program({{eVertex, VertexSource}, {eFragment, FragmentSource}}, true);
+    float extent = 0;
+    for (const auto &v : original.GetVerticies())
+        extent = std::max({extent, std::abs(v.Position.x), std::abs(v.Position.y), std::abs(v.Position.z)});
+    mat4 transform(0.9f / std::max(extent, 1e-6f));
+    transform[3][3] = 1.0f;
+    program.PushUniform("uTransform", transform);
+    glViewport(0, 0, 512, 512);
+    glEnable(GL_DEPTH_TEST);
+    program.Use();
+
+    const int draws = int(std::clamp<size_t>(200000000 / std::max<size_t>(indexCount, 1), 1, 200));
+    struct Variant
+    {
+        const char *name;
+        const Mesh *mesh;
+        MeshFormat format;
+    } variants[] = {
+        {"original  float/u32", &original, {}},
+        {"optimized float/u32", &optimized, {}},
+        {"optimized float/u16", &optimized, {VertexLayout::Float, true}},
+        {"optimized packed/u32", &optimized, {VertexLayout::Packed, false}},
+        {"optimized packed/u16", &optimized, {VertexLayout::Packed, true}},
+    };
+    for (const auto &variant : variants)
+    {
+        GL_Mesh mesh(*variant.mesh, variant.format);
+        mesh.Draw();
+        glFinish();
+        printf("  %-21s: %8.3f ms/draw  (%.2f MiB, %s)\n", variant.name, DrawMs(mesh, draws), mesh.GpuBytes() / 1048576.0,
+               mesh.GetIndexType() == GL_UNSIGNED_SHORT ? "u16" : "u32");
+    }
+    program.Unuse();
+
+    // the vertex count growing past 65536 after a 16 bit upload has to widen the same indices
+    const Mesh small = ShuffledSphere(16);
+    GL_Mesh grown(small, {VertexLayout::Float, true});
+    const GLenum typeBefore = grown.GetIndexType();
+    grown.SetVerticies(std::vector<Vertex>(0x10000 + 1000, small.GetVerticies()[0]));
+    std::vector<GLuint> readBack(grown.GetIndexCount());
+    if (grown.GetIndexType() == GL_UNSIGNED_INT)
+        glGetNamedBufferSubData(grown.GetIndexBuffer(), 0, readBack.size() * sizeof(GLuint), readBack.data());
+    const bool widenOk = typeBefore == GL_UNSIGNED_SHORT && readBack == small.GetIndicies();
+    printf("  u16 -> u32 on vertex growth: %s\n", widenOk ? "ok" : "FAILED");
+    return widenOk ? 0 : 1;
+});
@@ -0,0 +1,177 @@
+#include "Bench.h"
+#include "Extra/Mesh.h"
+#include "Extra/MeshCache.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace ImguiBase;
+namespace fs = std::filesystem;
+
+// Mesh::FromOBJ (memory-mapped, chunked Obj parser) against the getline/split/stof loader it
+// replaced, kept here verbatim as the reference. Both must give bit-identical vertices and
+// indices. Uses a triangle-only OBJ when one is given (the old loader kept only the first
+// triangle of larger faces), otherwise a generated `n` x `n` grid that mixes every face
+// corner form, tabs and vertex colors.
+#define OBJ_JUMP_VALUE(x, y) (uint16_t(x) << 8) + y
+
+static std::vector<std::string> Split(const std::string &str, char divider, bool AddEmpties = false)
+{
+    std::vector<std::string> result;
+    std::string temp;
+    for (char ch : str)
+    {
+        if (ch == divider)
+        {
+            if (!temp.empty() || AddEmpties)
+            {
+                result.push_back(temp);
+                temp.clear();
+            }
+        }
+        else
+            temp += ch;
+    }
+    if (!temp.empty())
+        result.push_back(temp);
+    return result;
+}
+
+static Mesh LegacyFromOBJ(const std::string &filepath, bool &colorsFound)
+{
+    std::vector<vec3> Positions;
+    std::vector<vec3> Normals;
+    std::vector<vec2> TexCoords;
+
+    std::map<std::array<uint32_t, 3>, size_t> vertexEntries;
+    std::vector<Vertex> verticies;
+    std::vector<uint32_t> indicies;
+    colorsFound = false;
+    std::ifstream file(filepath);
+    if (!file.is_open())
+        throw std::runtime_error("Could not open file");
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty())
+            continue;
+
+        std::replace(line.begin(), line.end(), '\t', ' ');
+        switch (OBJ_JUMP_VALUE(line[0], line[1]))
+        {
+        case OBJ_JUMP_VALUE('v', ' '):
+        {
+            const std::vector<std::string> splits = Split(line, ' ');
+            vec3 pos;
+            for (int i = 0; i < 3; i++)
+                pos[i] = std::stof(splits[i + 1]);
+            Positions.push_back(pos);
+            // the colors themselves were parsed but never reached the vertices
+            if (splits.size() > 4)
+                colorsFound = true;
+        }
+        break;
+        case OBJ_JUMP_VALUE('v', 'n'):
+        {
+            const std::vector<std::string> splits = Split(line, ' ');
+            vec3 normal;
+            for (int i = 0; i < 3; i++)
+                normal[i] = std::stof(splits[i + 1]);
+            Normals.push_back(normal);
+        }
+        break;
+        case OBJ_JUMP_VALUE('v', 't'):
+        {
+            const std::vector<std::string> splits = Split(line, ' ');
+            vec2 texCoord;
+            for (int i = 0; i < 2; i++)
+                texCoord[i] = std::stof(splits[i + 1]);
+            TexCoords.push_back(texCoord);
+        }
+        break;
+        case OBJ_JUMP_VALUE('f', ' '):
+        {
+            const std::vector<std::string> splits = Split(line, ' ');
+            for (int i = 0; i < 3; i++)
+            {
+                const std::vector<std::string> comps = Split(splits[i + 1], '/', true);
+                uint32_t posInd = comps[0].empty() ? -1 : std::stoi(comps[0]) - 1;
+                uint32_t texInd = comps.size() <= 1 || comps[1].empty() ? -1 : std::stoi(comps[1]) - 1;
+                uint32_t norInd = comps.size() <= 2 || comps[2].empty() ? -1 : std::stoi(comps[2]) - 1;
+
+                const auto entry = vertexEntries.find({posInd, texInd, norInd});
+                if (entry != vertexEntries.end())
+                {
+                    indicies.push_back(entry->second);
+                    continue;
+                }
+                Vertex v;
+                v.Position = {0, 0, 0};
+                v.Normal = {0, 0, 0};
+                v.Color = {0, 0, 0, 0};
+                v.TexCoord = {0, 0};
+                if (posInd != uint32_t(-1))
+                    v.Position = Positions[posInd];
+                if (texInd != uint32_t(-1))
+                    v.TexCoord = TexCoords[texInd];
+                if (norInd != uint32_t(-1))
+                    v.Normal = Normals[norInd];
+
+                uint32_t vertIndex = verticies.size();
+                verticies.push_back(v);
+                vertexEntries[{posInd, texInd, norInd}] = vertIndex;
+                indicies.push_back(vertIndex);
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    Mesh mesh;
+    mesh.SetVerticies(verticies);
+    mesh.SetIndicies(indicies);
+    return mesh;
+}
+
+static bool SameMesh(const Mesh &a, const Mesh &b)
+{
+    const auto &va = a.GetVerticies(), &vb = b.GetVerticies();
+    const auto &ia = a.GetIndicies(), &ib = b.GetIndicies();
+    return va.size() == vb.size() && ia == ib && memcmp(va.data(), vb.data(), va.size() * sizeof(Vertex)) == 0;
+}
+
+static Bench::Register objParseBench("obj-parse", [](const std::vector<std::string> &args)
+{
+    const bool generated = args.empty() || std::isdigit((unsigned char)args[0][0]);
+    const fs::path path = generated ? fs::temp_directory_path() / "bench_obj_parse.obj" : fs::path(args[0]);
+    if (generated)
+        Bench::WriteGridObj(path, uint32_t(Bench::ArgOr(args, 0, 400)), Bench::GridObj::Mixed);
+    std::error_code ec;
+    fs::remove(MeshCache::PathFor(path.string()), ec);
+
+    bool legacyColors = false, parsedColors = false, cachedColors = false;
+    Mesh legacy, parsed, cached;
+    const double legacyMs = Bench::TimeMs([&]() { legacy = LegacyFromOBJ(path.string(), legacyColors); });
+    const double parsedMs = Bench::TimeMs([&]() { parsed = Mesh::FromOBJ(path.string(), parsedColors); });
+    const double cachedMs = Bench::TimeMs([&]() { cached = Mesh::FromOBJ(path.string(), cachedColors); });
+    fs::remove(MeshCache::PathFor(path.string()), ec);
+    if (generated)
+        fs::remove(path, ec);
+
+    const bool parsedOk = SameMesh(legacy, parsed) && legacyColors == parsedColors;
+    const bool cachedOk = SameMesh(legacy, cached) && legacyColors == cachedColors;
+    printf("obj-parse: %s, %zu vertices, %zu indices\n", path.filename().string().c_str(), legacy.GetVerticies().size(),
+           legacy.GetIndicies().size());
+    printf("  getline loader : %8.2f ms\n", legacyMs);
+    printf("  Mesh::FromOBJ  : %8.2f ms parsed (%s), %8.2f ms cached (%s)\n", parsedMs, parsedOk ? "identical" : "MISMATCH",
+           cachedMs, cachedOk ? "identical" : "MISMATCH");
+    printf("  %s\n", parsedOk && cachedOk ? "OK" : "MISMATCH");
+    return parsedOk && cachedOk ? 0 : 1;
+});
@@ -0,0 +1,103 @@
+#include "Bench.h"
+#include "Extra/GeometryCompute.h"
+#include "Extra/Profiler.h"
+#include "Extra/RenderTargetPool.h"
+#include "Extra/Texture.h"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using namespace ImguiBase;
+
+// Runs `frames` frames of the instrumented render path (`draws` GL_Mesh::Draw calls, a
+// BlitToNew and a compute normals pass) with the profiler recording and then switched off.
+// Checks that GPU times come back without waiting on the GPU and that the exported trace parses.
+static Bench::Register profilerBench("profiler", [](const std::vector<std::string> &args)
+{
+    const size_t frames = Bench::ArgOr(args, 0, 60);
+    const size_t draws = Bench::ArgOr(args, 1, 200);
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    const uvec2 size(256, 256);
+    auto target = std::make_shared<Texture>();
+    target->Alloc2DStorage(size, GL_RGBA8);
+    GLuint fbo;
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, target->GetHandle(), 0);
+
+    GL_Mesh mesh(Bench::GridMesh(32));
+    GeometryCompute compute;
+    Profiler &profiler = Profiler::Shared();
+
+    double slowestBeginMs = 0;
+    auto run = [&]()
+    {
+        for (size_t f = 0; f < frames; f++)
+        {
+            slowestBeginMs = std::max(slowestBeginMs, Bench::TimeMs([&]() { profiler.BeginFrame(); }));
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glViewport(0, 0, size.x, size.y);
+            glClear(GL_COLOR_BUFFER_BIT);
+            for (size_t d = 0; d < draws; d++)
+                mesh.Draw();
+            compute.CalculateNormals(mesh);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            auto half = target->BlitToNew(uvec2(size.x / 2, size.y / 2), Linear);
+            context.Swap();
+            profiler.EndFrame();
+            RenderTargetPool::Shared().EndFrame();
+        }
+    };
+
+    run(); // warm up shaders and the query pool
+    profiler.ClearHistory();
+    slowestBeginMs = 0;
+    const double recordedMs = Bench::TimeMs(run) / frames;
+    const double recordedBeginMs = slowestBeginMs;
+    const size_t collected = profiler.GetHistory().size();
+    const Profiler::Stats stats = profiler.GetStats();
+
+    size_t gpuFrames = 0, gpuSamples = 0, samples = 0;
+    for (const Profiler::Frame &frame : profiler.GetHistory())
+    {
+        gpuFrames += frame.gpuMs >= 0;
+        samples += frame.samples.size();
+        for (const Profiler::Sample &s : frame.samples)
+            gpuSamples += s.gpuMs >= 0;
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "profiler-bench.json").string();
+    bool traceOk = profiler.ExportChromeTrace(path);
+    size_t events = 0;
+    if (traceOk)
+    {
+        std::ifstream in(path);
+        const auto trace = nlohmann::json::parse(in, nullptr, false);
+        traceOk = !trace.is_discarded() && trace.contains("traceEvents");
+        events = traceOk ? trace["traceEvents"].size() : 0;
+        std::filesystem::remove(path);
+    }
+
+    profiler.SetEnabled(false);
+    const double offMs = Bench::TimeMs(run) / frames;
+    profiler.SetEnabled(true);
+    profiler.ReleaseQueries();
+    glDeleteFramebuffers(1, &fbo);
+
+    // draws, CalculateNormals, BlitToNew, plus its two dispatches on the compute path
+    const size_t scopesPerFrame = draws + 2 + (compute.UsesGpu() ? 2 : 0);
+    const bool ok = collected > 0 && samples == collected * scopesPerFrame && traceOk &&
+                    (!profiler.HasGpuTimers() || gpuSamples > 0);
+    printf("profiler: %zu frames, %zu scopes per frame, %s\n", frames, scopesPerFrame,
+           profiler.HasGpuTimers() ? "GPU timers" : "CPU only");
+    printf("  recording : %8.3f ms per frame, slowest BeginFrame %.3f ms\n", recordedMs, recordedBeginMs);
+    printf("  off       : %8.3f ms per frame\n", offMs);
+    printf("  %zu frames collected (%zu GPU timed, %zu still in flight, %llu CPU only), %zu of %zu samples GPU timed, %zu queries pooled\n",
+           collected, gpuFrames, stats.framesInFlight, (unsigned long long)stats.gpuFramesSkipped, gpuSamples, samples,
+           stats.queriesAllocated);
+    printf("  trace %s (%zu events)\n", traceOk ? "parses" : "FAILED", events);
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+});
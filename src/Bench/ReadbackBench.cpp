@@ -0,0 +1,73 @@
+#include "Bench.h"
+#include "Extra/Texture.h"
+#include <deque>
+
+// Reads a `size` x `size` RGBA texture back every frame, first with the stalling
+// Texture::GetData, then through Readback. Reports the time the calling thread spends
+// per frame and how many frames late the async results arrive.
+static Bench::Register readbackBench("readback", [](const std::vector<std::string> &args)
+{
+    const size_t frames = Bench::ArgOr(args, 0, 200);
+    const uint32_t size = uint32_t(Bench::ArgOr(args, 1, 1024));
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    Texture texture;
+    texture.Alloc2D({size, size}, eRGBA, GL_RGBA8);
+    std::vector<uint8_t> pixels(size_t(size) * size * 4);
+    auto fill = [&](size_t frame)
+    {
+        const uint8_t color[4] = {uint8_t(frame), uint8_t(frame >> 8), 0, 255};
+        glClearTexImage(texture.GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, color);
+    };
+
+    double syncMs = 0;
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        fill(frame);
+        syncMs += Bench::TimeMs([&]() { texture.GetData(pixels.data(), pixels.size()); });
+        context.Swap();
+    }
+
+    struct Pending
+    {
+        Readback readback;
+        size_t frame;
+    };
+    std::deque<Pending> pending;
+    double asyncMs = 0;
+    size_t completed = 0, latencyFrames = 0, mismatches = 0;
+    auto drain = [&](size_t frame)
+    {
+        while (!pending.empty() && pending.front().readback.Ready())
+        {
+            const auto data = pending.front().readback.As<uint8_t>();
+            mismatches += data[0] != uint8_t(pending.front().frame);
+            latencyFrames += frame - pending.front().frame;
+            completed++;
+            pending.pop_front();
+        }
+    };
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        fill(frame);
+        asyncMs += Bench::TimeMs([&]()
+        {
+            pending.push_back({texture.GetDataAsync(), frame});
+            drain(frame);
+        });
+        context.Swap();
+    }
+    for (size_t frame = frames; !pending.empty(); frame++)
+    {
+        drain(frame);
+        context.Swap();
+    }
+
+    printf("readback: %zu frames of %ux%u RGBA\n", frames, size, size);
+    printf("  GetData       : %8.3f ms/frame on the calling thread\n", syncMs / frames);
+    printf("  GetDataAsync  : %8.3f ms/frame on the calling thread, %.2f frames latency, %zu mismatches\n",
+           asyncMs / frames, completed ? double(latencyFrames) / completed : 0.0, mismatches);
+    return 0;
+});
@@ -0,0 +1,125 @@
+#include "Bench.h"
+#include "Extra/RenderTargetPool.h"
+#include "Extra/TexturePool.h"
+#include <cstring>
+
+// `frames` frames of `blits` Texture::BlitToNew calls from a `size` x `size` RGBA texture at
+// a few output sizes, against the old path that made and deleted two framebuffers per call.
+// Checks both give the same pixels, that a target released this frame is only handed out on
+// the next one, that idle targets are evicted and that ShareColor holds its target.
+static std::shared_ptr<Texture> BlitPerCallFramebuffers(const Texture &src, uvec2 newSize, TextureFilter filterMode)
+{
+    auto dst = TexturePool::Shared().Acquire(newSize, src.GetPixelFormat(), src.GetInternalFormat(), filterMode);
+    GLuint fbos[2];
+    glGenFramebuffers(2, fbos);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbos[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, src.GetHandle(), 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst->GetHandle(), 0);
+    const uvec2 srcSize = src.GetDimensions();
+    glBlitFramebuffer(0, 0, srcSize.x, srcSize.y, 0, 0, newSize.x, newSize.y, GL_COLOR_BUFFER_BIT,
+                      filterMode == Linear ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(2, fbos);
+    return dst;
+}
+
+static std::vector<uint8_t> Pixels(const Texture &texture)
+{
+    const uvec2 size = texture.GetDimensions();
+    std::vector<uint8_t> pixels(size_t(size.x) * size.y * 4);
+    glGetTextureImage(texture.GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, GLsizei(pixels.size()), pixels.data());
+    return pixels;
+}
+
+static Bench::Register renderTargetBench("render-targets", [](const std::vector<std::string> &args)
+{
+    const size_t frames = Bench::ArgOr(args, 0, 120);
+    const size_t blits = Bench::ArgOr(args, 1, 16);
+    const uint32_t size = uint32_t(Bench::ArgOr(args, 2, 512));
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    Texture source;
+    source.Alloc2DStorage(uvec2(size, size), GL_RGBA8);
+    {
+        std::vector<uint8_t> pixels(size_t(size) * size * 4);
+        for (size_t i = 0; i < pixels.size(); i++)
+            pixels[i] = uint8_t(i * 7 + i / (size * 4) * 13);
+        glTextureSubImage2D(source.GetHandle(), 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+    const uvec2 outputs[] = {uvec2(size / 2, size / 2), uvec2(size / 4, size / 4), uvec2(size, size / 2)};
+
+    RenderTargetPool &pool = RenderTargetPool::Shared();
+    auto run = [&](bool pooled)
+    {
+        for (size_t f = 0; f < frames; f++)
+        {
+            std::vector<std::shared_ptr<Texture>> results;
+            for (size_t b = 0; b < blits; b++)
+            {
+                const uvec2 out = outputs[b % 3];
+                results.push_back(pooled ? source.BlitToNew(out) : BlitPerCallFramebuffers(source, out, Linear));
+            }
+            glFinish();
+            results.clear();
+            pool.EndFrame();
+        }
+    };
+    run(false); // warm up
+    const double perCallMs = Bench::TimeMs([&]() { run(false); }) / (frames * blits);
+    run(true);
+    const RenderTargetPool::Stats before = pool.GetStats();
+    const double pooledMs = Bench::TimeMs([&]() { run(true); }) / (frames * blits);
+    const RenderTargetPool::Stats after = pool.GetStats();
+    const uint64_t created = after.misses - before.misses;
+
+    bool pixelsOk = true;
+    for (const uvec2 &out : outputs)
+        pixelsOk = pixelsOk && Pixels(*source.BlitToNew(out)) == Pixels(*BlitPerCallFramebuffers(source, out, Linear));
+
+    // reuse waits for the next frame; idle targets go after maxIdleFrames
+    RenderTargetPool local(64ull << 20, 3);
+    GLuint first, second, third;
+    {
+        auto a = local.Acquire(uvec2(64, 64), eNonApplicable, GL_RGBA8, Linear, GL_DEPTH24_STENCIL8);
+        first = a->GetFramebuffer();
+    }
+    {
+        auto b = local.Acquire(uvec2(64, 64), eNonApplicable, GL_RGBA8, Linear, GL_DEPTH24_STENCIL8);
+        second = b->GetFramebuffer();
+    }
+    local.EndFrame();
+    {
+        auto c = local.Acquire(uvec2(64, 64), eNonApplicable, GL_RGBA8, Linear, GL_DEPTH24_STENCIL8);
+        third = c->GetFramebuffer();
+    }
+    const bool reuseOk = first != second && third == second && local.GetStats().pooledTargets == 2;
+    for (int f = 0; f < 5; f++)
+        local.EndFrame();
+    const bool evictOk = local.GetStats().pooledTargets == 0 && local.GetStats().evicted == 2;
+
+    std::shared_ptr<Texture> color;
+    {
+        auto target = local.Acquire(uvec2(32, 32), eNonApplicable, GL_RGBA8);
+        color = target->ShareColor();
+    }
+    const bool heldOk = local.GetStats().pooledTargets == 0;
+    color.reset();
+    const bool shareOk = heldOk && local.GetStats().pooledTargets == 1;
+    local.Clear();
+
+    const bool ok = pixelsOk && reuseOk && evictOk && shareOk && created == 0;
+    printf("render-targets: %zu frames x %zu blits from %ux%u RGBA\n", frames, blits, size, size);
+    printf("  per-call FBOs : %8.4f ms per blit, %zu framebuffers created and deleted\n", perCallMs, frames * blits * 2);
+    printf("  pooled        : %8.4f ms per blit, %llu framebuffers created, hit rate %.1f %%\n", pooledMs,
+           (unsigned long long)created, 100.0 * (after.hits - before.hits) / double(frames * blits));
+    printf("  pool holds %zu targets (%.2f MiB)\n", after.pooledTargets, after.pooledBytes / 1048576.0);
+    printf("  pixels %s, next-frame reuse %s, idle eviction %s, ShareColor %s\n", pixelsOk ? "match" : "MISMATCH",
+           reuseOk ? "ok" : "FAILED", evictOk ? "ok" : "FAILED", shareOk ? "ok" : "FAILED");
+    printf("  %s\n", ok ? "OK" : "MISMATCH");
+    pool.Clear();
+    return ok ? 0 : 1;
+});
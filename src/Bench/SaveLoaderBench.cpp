@@ -0,0 +1,51 @@
+#include "Bench.h"
+#include "SavesWindow/SaveFormat.h"
+#include <fstream>
+
+// Parse cost of a generated JSON save: SAX streaming vs the nlohmann DOM.
+// Script resolution is left out since it is the same stat/read for both.
+// SAX runs first so the peak RSS reading after it is not inflated by the DOM.
+static Bench::Register saveLoaderBench("save-json", [](const std::vector<std::string>& args)
+{
+    const size_t count = Bench::ArgOr(args, 0, 100000);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_save.json";
+    {
+        std::ofstream out(path);
+        out << "{\"scripts\":[";
+        for (size_t i = 0; i < count; i++)
+            out << (i ? "," : "") << "{\"name\":\"script_" << i << "\",\"path\":\"/opt/scripts/script_" << i << ".sh\"}";
+        out << "]}";
+    }
+    const auto fileBytes = std::filesystem::file_size(path);
+
+    size_t saxEntries = 0;
+    const long rssBefore = Bench::PeakRssKb();
+    double saxMs = Bench::BestMs(3, [&]()
+    {
+        saxEntries = 0;
+        std::ifstream in(path, std::ios::binary);
+        SaveFormat::StreamJsonReferences(in, [&](std::string&&, std::string&&) { saxEntries++; });
+    });
+    const long rssSax = Bench::PeakRssKb();
+
+    size_t domEntries = 0;
+    double domMs = Bench::BestMs(3, [&]()
+    {
+        std::ifstream in(path, std::ios::binary);
+        json j = json::parse(in);
+        domEntries = 0;
+        for (auto& item : j["scripts"])
+        {
+            std::string name = item.value("name", "");
+            std::string p = item.value("path", "");
+            domEntries++;
+        }
+    });
+    const long rssDom = Bench::PeakRssKb();
+
+    printf("save-json: %zu entries, %.1f MiB\n", count, fileBytes / (1024.0 * 1024.0));
+    printf("  SAX stream : %8.2f ms  (%zu entries, peak RSS +%ld KiB)\n", saxMs, saxEntries, rssSax - rssBefore);
+    printf("  DOM parse  : %8.2f ms  (%zu entries, peak RSS +%ld KiB)\n", domMs, domEntries, rssDom - rssSax);
+    std::filesystem::remove(path);
+    return saxEntries == domEntries ? 0 : 1;
+});
@@ -0,0 +1,50 @@
+#include "Bench.h"
+#include "Extra/SSBO.hpp"
+#include "Extra/StreamingSSBO.hpp"
+
+// Rewrites `kib` KiB of per-frame data that the GPU then reads (a buffer copy stands in for a
+// draw), through SSBO::Insert and through StreamingSSBO. Reports CPU time per frame.
+static Bench::Register streamingSSBOBench("ssbo-stream", [](const std::vector<std::string> &args)
+{
+    const size_t frames = Bench::ArgOr(args, 0, 300);
+    const size_t bytes = Bench::ArgOr(args, 1, 4096) << 10;
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    std::vector<uint8_t> data(bytes, 1);
+    SSBO sink(bytes);
+
+    SSBO ssbo(bytes);
+    const double insertMs = Bench::TimeMs([&]()
+    {
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            data[0] = uint8_t(frame);
+            ssbo.Insert(data.data(), bytes);
+            ssbo.BindBase(0);
+            glCopyNamedBufferSubData(ssbo.GetHandle(), sink.GetHandle(), 0, 0, bytes);
+            context.Swap();
+        }
+    });
+
+    StreamingSSBO stream(bytes);
+    const double streamMs = Bench::TimeMs([&]()
+    {
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            data[0] = uint8_t(frame);
+            stream.BeginFrame();
+            auto allocation = stream.Push(data.data(), bytes);
+            stream.BindRange(0, allocation);
+            glCopyNamedBufferSubData(stream.GetHandle(), sink.GetHandle(), allocation.offset, 0, bytes);
+            stream.EndFrame();
+            context.Swap();
+        }
+    });
+
+    printf("ssbo-stream: %zu frames, %zu KiB per frame\n", frames, bytes >> 10);
+    printf("  SSBO::Insert  : %8.3f ms/frame\n", insertMs / frames);
+    printf("  StreamingSSBO : %8.3f ms/frame (%llu stalls)\n", streamMs / frames, (unsigned long long)stream.GetStalls());
+    return 0;
+});
@@ -0,0 +1,48 @@
+#include "Bench.h"
+#include "Extra/TextureStreamer.h"
+
+// Streams `count` generated RGBA images of `size` x `size` twice through TextureStreamer.
+// The first round fills the pool, the second should be served from it. Reports throughput,
+// the worst render-thread Update() and the pool hit rate.
+static Bench::Register textureStreamBench("texture-stream", [](const std::vector<std::string> &args)
+{
+    const size_t count = Bench::ArgOr(args, 0, 64);
+    const uint32_t size = uint32_t(Bench::ArgOr(args, 1, 1024));
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    TexturePool pool;
+    TextureStreamer streamer(pool);
+    const size_t imageBytes = size_t(size) * size * 4;
+
+    for (int round = 0; round < 2; round++)
+    {
+        std::vector<std::shared_ptr<Texture>> textures;
+        size_t failed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::vector<uint8_t> pixels(imageBytes, uint8_t(i * 37 + round));
+            streamer.LoadPixels({size, size}, eRGBA, std::move(pixels), [&](std::shared_ptr<Texture> texture)
+                                { texture ? textures.push_back(std::move(texture)) : void(failed++); });
+        }
+
+        double worstUpdateMs = 0;
+        const double totalMs = Bench::TimeMs([&]()
+        {
+            while (textures.size() + failed < count)
+            {
+                worstUpdateMs = std::max(worstUpdateMs, Bench::TimeMs([&]() { streamer.Update(); }));
+                context.Swap();
+            }
+        });
+
+        const auto stats = streamer.GetStats();
+        printf("texture-stream round %d: %zu x %ux%u RGBA\n", round + 1, count, size, size);
+        printf("  throughput    : %8.1f MB/s  (%.1f ms total)\n", count * imageBytes / 1e6 / (totalMs / 1000.0), totalMs);
+        printf("  worst Update  : %8.3f ms\n", worstUpdateMs);
+        printf("  pool hit rate : %8.1f %%  (%llu hits, %llu misses)\n", stats.pool.HitRate() * 100.0,
+               (unsigned long long)stats.pool.hits, (unsigned long long)stats.pool.misses);
+    }
+    return 0;
+});
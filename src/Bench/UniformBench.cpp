@@ -0,0 +1,101 @@
+#include "Bench.h"
+#include "Extra/Program.h"
+#include "Extra/UniformBuffer.hpp"
+
+// Per-frame uniform traffic for one program with a mat4, a vec4 and a float:
+//   legacy  - what PushUniform used to do: bind, glGetUniformLocation, upload, unbind
+//   cached  - PushUniform with reflected locations and glProgramUniform*
+//   block   - the same data as one std140 uniform block update
+static const char *VertexSource = R"(#version 450 core
+layout(location = 0) in vec3 aPos;
+uniform mat4 uModel;
+uniform vec4 uTint;
+uniform float uTime;
+layout(std140) uniform FrameData
+{
+    mat4 model;
+    vec4 tint;
+    float time;
+} frame;
+out vec4 vColor;
+void main()
+{
+    gl_Position = uModel * frame.model * vec4(aPos, 1.0);
+    vColor = uTint * frame.tint * (uTime + frame.time);
+})";
+
+static const char *FragmentSource = R"(#version 450 core
+in vec4 vColor;
+out vec4 outColor;
+void main() { outColor = vColor; })";
+
+struct FrameData
+{
+    mat4 model;
+    vec4 tint;
+    float time;
+    float pad[3];
+};
+
+static Bench::Register uniformBench("program-uniforms", [](const std::vector<std::string> &args)
+{
+    const size_t iterations = Bench::ArgOr(args, 0, 200000);
+    Bench::GLContext context;
+    if (!context.Ok())
+        return 1;
+
+    Program program({{eVertex, VertexSource}, {eFragment, FragmentSource}}, true);
+    const GLuint handle = program.GetHandle();
+    const mat4 model(1.0f);
+    const vec4 tint(1.0f);
+
+    double legacyMs = Bench::BestMs(3, [&]()
+    {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            const float time = float(i);
+            glUseProgram(handle);
+            glUniformMatrix4fv(glGetUniformLocation(handle, "uModel"), 1, GL_FALSE, &model[0][0]);
+            glUseProgram(0);
+            glUseProgram(handle);
+            glUniform4fv(glGetUniformLocation(handle, "uTint"), 1, &tint.x);
+            glUseProgram(0);
+            glUseProgram(handle);
+            glUniform1fv(glGetUniformLocation(handle, "uTime"), 1, &time);
+            glUseProgram(0);
+        }
+        glFinish();
+    });
+
+    double cachedMs = Bench::BestMs(3, [&]()
+    {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            program.PushUniform("uModel", model);
+            program.PushUniform("uTint", tint);
+            program.PushUniform("uTime", float(i));
+        }
+        glFinish();
+    });
+
+    UniformBuffer ubo(sizeof(FrameData));
+    ubo.BindBase(0);
+    program.BindUniformBlock("FrameData", 0);
+    double blockMs = Bench::BestMs(3, [&]()
+    {
+        FrameData data{model, tint, 0, {}};
+        for (size_t i = 0; i < iterations; i++)
+        {
+            data.time = float(i);
+            ubo.Update(data);
+        }
+        glFinish();
+    });
+
+    auto perSecond = [&](double ms) { return iterations * 3 / (ms / 1000.0) / 1e6; };
+    printf("program-uniforms: %zu frames x 3 uniforms\n", iterations);
+    printf("  legacy PushUniform : %8.2f ms  (%.2f M uniforms/s)\n", legacyMs, perSecond(legacyMs));
+    printf("  cached PushUniform : %8.2f ms  (%.2f M uniforms/s)\n", cachedMs, perSecond(cachedMs));
+    printf("  uniform block      : %8.2f ms  (%.2f M uniforms/s)\n", blockMs, perSecond(blockMs));
+    return 0;
+});
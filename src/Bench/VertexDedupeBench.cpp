@@ -0,0 +1,81 @@
+#include "Bench.h"
+#include "Extra/ObjParser.h"
+#include "Extra/VertexDedupeMap.h"
+#include <array>
+#include <cctype>
+#include <map>
+
+using namespace ImguiBase;
+
+// Face corner dedupe as done by Mesh::FromOBJ: the old std::map find + operator[]
+// against VertexDedupeMap. Uses the corners of an OBJ file when one is given,
+// otherwise a generated grid of `side` x `side` quads with a texcoord seam per row.
+static std::vector<std::array<uint32_t, 3>> GridCorners(uint32_t side)
+{
+    std::vector<std::array<uint32_t, 3>> corners;
+    corners.reserve(size_t(side) * side * 6);
+    auto at = [&](uint32_t x, uint32_t y) -> std::array<uint32_t, 3>
+    {
+        const uint32_t p = y * (side + 1) + x;
+        return {p, x == side ? p + side * side : p, 0};
+    };
+    for (uint32_t y = 0; y < side; y++)
+        for (uint32_t x = 0; x < side; x++)
+            for (auto c : {at(x, y), at(x + 1, y), at(x + 1, y + 1), at(x, y), at(x + 1, y + 1), at(x, y + 1)})
+                corners.push_back(c);
+    return corners;
+}
+
+static Bench::Register vertexDedupeBench("vertex-dedupe", [](const std::vector<std::string>& args)
+{
+    std::vector<std::array<uint32_t, 3>> corners;
+    if (!args.empty() && !std::isdigit((unsigned char)args[0][0]))
+        corners = Obj::ParseFile(args[0]).corners;
+    else
+        corners = GridCorners(uint32_t(Bench::ArgOr(args, 0, 1000)));
+
+    std::vector<uint32_t> mapIndices, flatIndices;
+    size_t mapVertices = 0, flatVertices = 0;
+
+    double mapMs = Bench::BestMs(3, [&]()
+    {
+        std::map<std::array<uint32_t, 3>, size_t> entries;
+        mapIndices.clear();
+        mapIndices.reserve(corners.size());
+        size_t vertices = 0;
+        for (const auto& key : corners)
+        {
+            const auto entry = entries.find(key);
+            if (entry != entries.end())
+            {
+                mapIndices.push_back(entry->second);
+                continue;
+            }
+            entries[key] = vertices;
+            mapIndices.push_back(uint32_t(vertices++));
+        }
+        mapVertices = vertices;
+    });
+
+    size_t flatBytes = 0;
+    double flatMs = Bench::BestMs(3, [&]()
+    {
+        VertexDedupeMap entries(corners.size() / 3);
+        flatIndices.clear();
+        flatIndices.reserve(corners.size());
+        uint32_t vertices = 0;
+        for (const auto& key : corners)
+        {
+            bool inserted;
+            flatIndices.push_back(entries.FindOrInsert(key, vertices, inserted));
+            vertices += inserted;
+        }
+        flatVertices = vertices;
+        flatBytes = entries.MemoryBytes();
+    });
+
+    printf("vertex-dedupe: %zu corners, %zu unique vertices\n", corners.size(), flatVertices);
+    printf("  std::map        : %8.2f ms\n", mapMs);
+    printf("  VertexDedupeMap : %8.2f ms  (%.1f MiB table)\n", flatMs, flatBytes / (1024.0 * 1024.0));
+    return mapIndices == flatIndices && mapVertices == flatVertices ? 0 : 1;
+});
@@ -13,12 +13,17 @@ void ButtonsWindow::Render()
   ImGui::Separator();
   // --- UI for Refresh and Categorize ---
   if (ImGui::Button("Refresh"))
-    ReloadScripts(true);
+    ReloadScriptsAsync(true);
   ImGui::SameLine();
   if (ImGui::Button("Categorize Mode"))
   {
     ToggleCategorizeMode();
-    ReloadScripts(true);
+    ReloadScriptsAsync(true);
+  }
+  if (IsReloading())
+  {
+    ImGui::SameLine();
+    ImGui::TextDisabled("Loading...");
   }
   ImGui::Separator();
   // --- Script buttons ---
@@ -27,22 +32,51 @@ void ButtonsWindow::Render()
 
 void ButtonsWindow::ReloadScripts(bool ParseMetadata)
 {
-  scripts.clear();
+  if (scriptSearchPaths.empty())
+    LoadSearchPaths(*config, scriptSearchPaths);
 
+  SetScripts(ScanScripts(scriptSearchPaths, ParseMetadata));
+}
+
+void ButtonsWindow::ReloadScriptsAsync(bool ParseMetadata)
+{
   if (scriptSearchPaths.empty())
-    LoadSearchPaths(scriptSearchPaths);
+    LoadSearchPaths(*config, scriptSearchPaths);
+
+  reloadsPending++;
+  const uint64_t generation = ++reloadGeneration;
+  ioWorker->Submit([paths = scriptSearchPaths, ParseMetadata]()
+                   { return ScanScripts(paths, ParseMetadata); },
+                   [this, generation](std::vector<ScriptMacro> &loaded)
+                   {
+                     reloadsPending--;
+                     // a newer reload or a list set since then wins over this scan
+                     if (generation == reloadGeneration)
+                       SetScripts(std::move(loaded));
+                   },
+                   [this](std::exception_ptr error)
+                   {
+                     reloadsPending--;
+                     IOWorker::LogError("Script reload failed", error);
+                   });
+}
+
+std::vector<ScriptMacro> ButtonsWindow::ScanScripts(const std::vector<std::string> &searchPaths, bool ParseMetadata)
+{
+  std::vector<ScriptMacro> found;
 
   namespace fs = std::filesystem;
   fs::path base = fs::current_path();
 
-  for (const auto &rel : scriptSearchPaths)
+  for (const auto &rel : searchPaths)
   {
     fs::path dir = base / rel;
 
-    if (!fs::exists(dir) || !fs::is_directory(dir))
+    std::error_code ec;
+    if (!fs::exists(dir, ec) || !fs::is_directory(dir, ec))
       continue;
 
-    for (auto &entry : fs::directory_iterator(dir))
+    for (auto &entry : fs::directory_iterator(dir, ec))
     {
       if (entry.path().extension() == ".sh")
       {
@@ -65,24 +99,28 @@ void ButtonsWindow::ReloadScripts(bool ParseMetadata)
         if (ParseMetadata)
           ParseScriptMetadata(macro.content, macro);
 
-        scripts.push_back(std::move(macro));
+        found.push_back(std::move(macro));
       }
     }
   }
+  return found;
 }
 
 
 bool IsWSL()
 {
 #ifdef __linux__
-  std::ifstream f("/proc/version");
-  if (f.is_open())
+  static const bool isWSL = []
   {
+    std::ifstream f("/proc/version");
+    if (!f.is_open())
+      return false;
     std::string version;
     std::getline(f, version);
     return (version.find("Microsoft") != std::string::npos ||
             version.find("WSL") != std::string::npos);
-  }
+  }();
+  return isWSL;
 #endif
   return false;
 }
@@ -112,65 +150,105 @@ void ButtonsWindow::OpenInEditor(const std::string &path)
 
     // Try opening in Windows default editor (like Notepad)
     std::string command = "cmd.exe /C start \"\" \"" + winPath + "\"";
-    std::system(command.c_str());
+    PlatformOpen::Run(command);
     return;
   }
-  else
-  {
-    // Native Linux
-    std::string command = "xdg-open \"" + path + "\"";
-  }
+  // Native Linux
+  std::string command = "xdg-open \"" + path + "\"";
 #endif
 
-  // std::system(command.c_str());
+  PlatformOpen::Run(command);
 }
 
 void ButtonsWindow::ClearScripts()
 {
-  scripts.clear();
+  reloadGeneration++;
+  scripts = std::make_shared<ScriptList>();
+  selected = -1;
+  revision++;
+}
+
+void ButtonsWindow::SetScripts(ScriptList &&loaded)
+{
+  reloadGeneration++;
+  scripts = std::make_shared<ScriptList>(std::move(loaded));
   selected = -1;
+  revision++;
+}
+
+void ButtonsWindow::SetScripts(std::shared_ptr<const ScriptList> list)
+{
+  reloadGeneration++;
+  scripts = list ? std::move(list) : std::make_shared<ScriptList>();
+  selected = -1;
+  revision++;
+}
+
+ButtonsWindow::ScriptList &ButtonsWindow::EditScripts()
+{
+  if (scripts.use_count() > 1)
+    scripts = std::make_shared<ScriptList>(*scripts);
+  revision++; // every caller edits the list next
+  // every list is created non-const through make_shared, only shared as const
+  return const_cast<ScriptList &>(*scripts);
 }
 
 json ButtonsWindow::Serialize() const
 {
   json j;
-  for (const auto &s : scripts)
+  for (const auto &s : *scripts)
   {
-    j["scripts"].push_back({{"name", s.name}});
+    j["scripts"].push_back({{"name", s.name}, {"path", s.path}});
   }
   return j;
 }
 
 void ButtonsWindow::Deserialize(const json &j)
 {
-  scripts.clear();
+  SetScripts(LoadScriptReferences(j, scriptSearchPaths));
+}
+
+std::vector<ScriptMacro> ButtonsWindow::LoadScriptReferences(const json &j, const std::vector<std::string> &searchPaths)
+{
+  std::vector<ScriptMacro> loaded;
   if (!j.contains("scripts"))
-    return;
+    return loaded;
 
   for (auto &item : j["scripts"])
-  {
-    ScriptMacro sm;
-    sm.name = item.value("name", "");
-
-    // Load the actual content from file
-    std::string path = "Scripts/" + sm.name + ".sh";
-    if (std::filesystem::exists(path))
-    {
-      std::ifstream file(path);
-      sm.content.assign(
-          std::istreambuf_iterator<char>(file),
-          std::istreambuf_iterator<char>());
-    }
-    else
-    {
-      sm.content = "# Missing script file\n";
-      fprintf(stderr, "[WARN] Missing script: %s\n", path.c_str());
-    }
+    loaded.push_back(ResolveScriptReference(item.value("name", ""), item.value("path", ""), searchPaths));
+  return loaded;
+}
 
-    ParseScriptMetadata(sm.content, sm);
+ScriptMacro ButtonsWindow::ResolveScriptReference(const std::string &name, std::string path, const std::vector<std::string> &searchPaths)
+{
+  ScriptMacro sm;
+  sm.name = name;
 
-    scripts.push_back(sm);
+  // Prefer the recorded path, then the search paths, then the old Scripts/ default
+  if (path.empty() || !std::filesystem::exists(path))
+  {
+    auto found = FindScriptByPath(sm.name, searchPaths);
+    std::string dir = found.value_or("Scripts");
+    if (!dir.empty() && dir.back() != '/')
+      dir.append("/");
+    path = dir + sm.name + ".sh";
   }
+  sm.path = path;
+  if (std::filesystem::exists(path))
+  {
+    std::ifstream file(path);
+    sm.content.assign(
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+  }
+  else
+  {
+    sm.content = "# Missing script file\n";
+    fprintf(stderr, "[WARN] Missing script: %s\n", path.c_str());
+  }
+
+  ParseScriptMetadata(sm.content, sm);
+  return sm;
 }
 
 
@@ -181,7 +259,7 @@ void ButtonsWindow::RenderScriptList()
 
   // --- Group scripts by category ---
   std::unordered_map<std::string, std::vector<ScriptMacro>> categorized;
-  for (const auto &script : scripts)
+  for (const auto &script : *scripts)
   {
     if (!categorizeMode)
     {
@@ -219,7 +297,7 @@ void ButtonsWindow::RenderScriptList()
         std::string buttonId = script.name;
 
         if (ImGui::Button(buttonId.c_str(), ImVec2(maxButtonWidth, 0)))
-          LaunchScript(script);
+          LaunchScript(script, config->Get<std::string>("/launcher/terminal", "auto"));
 
         // Tooltip
         if (ImGui::IsItemHovered() && !script.description.empty())
@@ -251,10 +329,11 @@ void ButtonsWindow::RenderScriptList()
         if (ImGui::Button(("Remove##" + script.name).c_str()))
         {
           // Remove reference from main scripts list
-          auto it = std::find_if(scripts.begin(), scripts.end(), [&](const auto &s)
+          auto &list = EditScripts();
+          auto it = std::find_if(list.begin(), list.end(), [&](const auto &s)
                                  { return s.name == script.name; });
-          if (it != scripts.end())
-            scripts.erase(it);
+          if (it != list.end())
+            list.erase(it);
           break;
         }
       }
@@ -303,7 +382,7 @@ void ButtonsWindow::RenderAddNewScript()
       std::filesystem::perms::owner_read |
       std::filesystem::perms::owner_write);
       
-      ReloadScripts(true);
+      ReloadScriptsAsync(true);
       OpenInEditor(path);
       printf("[INFO] Created new stub: %s\n", path.c_str());
     }
@@ -314,11 +393,11 @@ void ButtonsWindow::RenderAddNewScript()
 
 void ButtonsWindow::SaveButtonSearchPaths()
 {
-  SaveSearchPaths(scriptSearchPaths);
+  SaveSearchPaths(*config, scriptSearchPaths);
 }
 
 void ButtonsWindow::LoadButtonSearchPaths()
 {
-  LoadSearchPaths(scriptSearchPaths);
+  LoadSearchPaths(*config, scriptSearchPaths);
 }
 
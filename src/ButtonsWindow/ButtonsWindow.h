@@ -9,23 +9,42 @@
 #include <future>
 #include <nlohmann/json.hpp>
 #include "ScriptMacro.h"
+#include "IO/IOWorker.h"
+#include "IO/ConfigStore.h"
 using json = nlohmann::json;
 
 
 class ButtonsWindow
 {
 public:
+  using ScriptList = std::vector<ScriptMacro>;
+
+  ButtonsWindow(IOWorker *io, ConfigStore *cfg) : ioWorker(io), config(cfg) {}
 
-  std::vector<ScriptMacro> scripts;
   int selected = -1;
   char nameBuffer[128 * 2] = "";
   std::string editBuffer;
 
   void Render();
   void ReloadScripts(bool ParseMetadata = false);
+  // Scans the search paths on the IO worker and swaps the list in when done.
+  void ReloadScriptsAsync(bool ParseMetadata = false);
+  bool IsReloading() const { return reloadsPending > 0; }
+  // Changes with anything Render() shows that does not come from input (list, mode, reload state).
+  uint64_t GetRevision() const { return revision * 2 + (IsReloading() ? 1 : 0); }
   void ClearScripts();
+  void SetScripts(ScriptList &&loaded);
+  // Shares the list (e.g. a cached workspace); the first edit makes a private copy.
+  void SetScripts(std::shared_ptr<const ScriptList> list);
+  const ScriptList &GetScripts() const { return *scripts; }
+  const std::shared_ptr<const ScriptList> &GetScriptsShared() const { return scripts; }
   json Serialize() const;
   void Deserialize(const json &j);
+
+  // File reads behind ReloadScripts/Deserialize; safe to call off the UI thread.
+  static std::vector<ScriptMacro> ScanScripts(const std::vector<std::string> &searchPaths, bool ParseMetadata);
+  static std::vector<ScriptMacro> LoadScriptReferences(const json &j, const std::vector<std::string> &searchPaths);
+  static ScriptMacro ResolveScriptReference(const std::string &name, std::string path, const std::vector<std::string> &searchPaths);
   
   void LoadButtonSearchPaths();
   void SaveButtonSearchPaths();
@@ -37,7 +56,18 @@ public:
   void RenderScriptList();
   void OpenInEditor(const std::string &path);
   void AddExistingScriptPopup();
-  void ToggleCategorizeMode() { categorizeMode = !categorizeMode; }
+  void ToggleCategorizeMode()
+  {
+    categorizeMode = !categorizeMode;
+    revision++;
+  }
+  ScriptList &EditScripts();
+  std::shared_ptr<const ScriptList> scripts = std::make_shared<ScriptList>();
   std::vector<std::string> scriptSearchPaths;
   bool categorizeMode = false;
+  IOWorker *ioWorker;
+  ConfigStore *config;
+  int reloadsPending = 0;
+  uint64_t reloadGeneration = 0; // scans started before the latest reload or SetScripts are dropped
+  uint64_t revision = 0;
 };
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
+#include <cstdint>
 #include <filesystem>
+#include "IO/HelperExecutor.h"
+#include "IO/ConfigStore.h"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -13,6 +16,11 @@ struct ScriptMacro
   std::string title;
   std::string description;
   std::string category;
+
+  // file identity recorded in binary saves; zero when unknown
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  uint64_t hash = 0;
 };
 
 static void ParseScriptMetadata(const std::string &content, ScriptMacro &macro)
@@ -52,7 +60,8 @@ static void ParseScriptMetadata(const std::string &content, ScriptMacro &macro)
 }
 
 
-static void LaunchScript(const ScriptMacro &script)
+// terminal: "auto" picks the first installed emulator, otherwise that emulator is tried first
+static void LaunchScript(const ScriptMacro &script, const std::string &terminal = "auto")
 {
   std::string scriptPath = script.path;
 
@@ -82,14 +91,32 @@ static void LaunchScript(const ScriptMacro &script)
   }
   else
   {
-    if (std::system("command -v konsole > /dev/null 2>&1") == 0)
+    // cached PATH probes instead of a shell per candidate on every launch
+    auto &helpers = HelperExecutor::Shared();
+    std::string chosen;
+    if (terminal != "auto")
+    {
+      if (helpers.CommandExists(terminal))
+        chosen = terminal;
+      else
+        fprintf(stderr, "[WARN] Preferred terminal '%s' not found, falling back\n", terminal.c_str());
+    }
+    if (chosen.empty())
+      for (const char *candidate : {"konsole", "gnome-terminal", "xfce4-terminal", "x-terminal-emulator"})
+        if (helpers.CommandExists(candidate))
+        {
+          chosen = candidate;
+          break;
+        }
+
+    if (chosen == "konsole")
       command = "konsole --hold -e bash \"" + scriptPath + "\"";
-    else if (std::system("command -v gnome-terminal > /dev/null 2>&1") == 0)
+    else if (chosen == "gnome-terminal")
       command = "gnome-terminal -- bash -c 'bash \"" + scriptPath + "\"; exec bash'";
-    else if (std::system("command -v xfce4-terminal > /dev/null 2>&1") == 0)
+    else if (chosen == "xfce4-terminal")
       command = "xfce4-terminal --hold -e bash \"" + scriptPath + "\"";
-    else if (std::system("command -v x-terminal-emulator > /dev/null 2>&1") == 0)
-      command = "x-terminal-emulator -e bash \"" + scriptPath + "\"";
+    else if (!chosen.empty())
+      command = chosen + " -e bash \"" + scriptPath + "\"";
     else
       command = "bash \"" + scriptPath + "\"";
   }
@@ -102,62 +129,21 @@ static void LaunchScript(const ScriptMacro &script)
       .detach();
 }
 
-static void SaveSearchPaths(std::vector<std::string>& scriptSearchPaths)
+// Search paths live in the ConfigStore; writes are debounced and atomic.
+static void SaveSearchPaths(ConfigStore &config, const std::vector<std::string> &scriptSearchPaths)
 {
-  fs::path configDir = fs::current_path() / "Config";
-  fs::path configPath = configDir / "paths.json";
-
-  if (!fs::exists(configDir))
-    fs::create_directory(configDir);
-
-  json j;
-  j["scriptPaths"] = scriptSearchPaths;
-
-  std::ofstream f(configPath);
-  if (f.is_open())
-    f << std::setw(2) << j;
+  config.Set("/scriptPaths", scriptSearchPaths);
 }
 
-static void LoadSearchPaths(std::vector<std::string>& scriptSearchPaths)
+static void LoadSearchPaths(ConfigStore &config, std::vector<std::string> &scriptSearchPaths)
 {
-  fs::path configDir = fs::current_path() / "Config";
-  fs::path configPath = configDir / "paths.json";
-
-  if (!fs::exists(configDir))
-    fs::create_directory(configDir);
-
-  scriptSearchPaths.clear();
-
-  if (!fs::exists(configPath))
-  {
-    // Default: just the Scripts folder
-    scriptSearchPaths.push_back("Scripts");
-    SaveSearchPaths(scriptSearchPaths);
-    return;
-  }
-
-  std::ifstream f(configPath);
-  if (!f.is_open())
-  {
-    // Fallback: default
-    scriptSearchPaths.push_back("Scripts");
-    return;
-  }
-
-  json j;
-  f >> j;
-
-  if (j.contains("scriptPaths") && j["scriptPaths"].is_array())
-  {
-    for (auto &p : j["scriptPaths"])
-      scriptSearchPaths.push_back(p.get<std::string>());
-  }
+  scriptSearchPaths = config.Get<std::vector<std::string>>("/scriptPaths", {});
 
   if (scriptSearchPaths.empty())
     scriptSearchPaths.push_back("Scripts");
 }
 
-static void AddSearchPath(const std::string &relPath, std::vector<std::string>& scriptSearchPaths)
+static void AddSearchPath(ConfigStore &config, const std::string &relPath, std::vector<std::string>& scriptSearchPaths)
 {
   if (relPath.empty())
   return;
@@ -168,10 +154,10 @@ static void AddSearchPath(const std::string &relPath, std::vector<std::string>&
   return;
   
   scriptSearchPaths.push_back(relPath);
-  SaveSearchPaths(scriptSearchPaths);
+  SaveSearchPaths(config, scriptSearchPaths);
 }
 
-static void RemoveSearchPath(size_t index, std::vector<std::string>& scriptSearchPaths)
+static void RemoveSearchPath(ConfigStore &config, size_t index, std::vector<std::string>& scriptSearchPaths)
 {
   if (index >= scriptSearchPaths.size())
   return;
@@ -180,5 +166,5 @@ static void RemoveSearchPath(size_t index, std::vector<std::string>& scriptSearc
   if (scriptSearchPaths.empty())
   scriptSearchPaths.push_back("Scripts");
   
-  SaveSearchPaths(scriptSearchPaths);
-}
+  SaveSearchPaths(config, scriptSearchPaths);
+}
\ No newline at end of file
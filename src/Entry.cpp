@@ -1,10 +1,14 @@
 #include "MainWindow/MainWindow.h"
 #include "MyApp.hpp"
-int main(void)
+#include "Bench/Bench.h"
+int main(int argc, char **argv)
 {
+  if (argc > 2 && std::string(argv[1]) == "--bench")
+    return Bench::Run(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+
   //MyApp app;
   //app.Run();
 
   MainWindow mainwnd;
   mainwnd.Run();
-}
\ No newline at end of file
+}
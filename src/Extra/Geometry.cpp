@@ -0,0 +1,193 @@
+#include "Geometry.h"
+#include <algorithm>
+#include <thread>
+
+namespace ImguiBase::Geometry
+{
+    static_assert(sizeof(vec3) == 3 * sizeof(float), "position streams are read as packed floats");
+
+    // Below these a chunk is not worth a thread of its own.
+    static constexpr size_t MinStreamChunk = 1 << 16;
+    static constexpr size_t MinTriangleChunk = 1 << 14;
+
+    // The stream loops run over the positions as floats, 12 at a time (4 vertices), with one
+    // accumulator per lane: no per-component shuffles or loop-carried dependency, so the
+    // compiler turns them into plain vector min/max/add/mul.
+    static constexpr size_t Lanes = 12;
+
+    size_t ChunkCount(size_t count, size_t minChunk, unsigned threads)
+    {
+        if (count == 0)
+            return 0;
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        return std::clamp<size_t>(count / std::max<size_t>(minChunk, 1), 1, threads);
+    }
+
+    static Bounds BoundsOf(const vec3 *positions, size_t count)
+    {
+        const float *f = &positions->x;
+        const size_t n = count * 3;
+        float lo[Lanes], hi[Lanes];
+        std::fill(lo, lo + Lanes, INFINITY);
+        std::fill(hi, hi + Lanes, -INFINITY);
+        size_t i = 0;
+        for (; i + Lanes <= n; i += Lanes)
+            for (size_t k = 0; k < Lanes; k++)
+            {
+                lo[k] = f[i + k] < lo[k] ? f[i + k] : lo[k];
+                hi[k] = f[i + k] > hi[k] ? f[i + k] : hi[k];
+            }
+
+        Bounds bounds;
+        for (size_t k = 0; k < Lanes; k++)
+        {
+            bounds.min[k % 3] = std::min(bounds.min[k % 3], lo[k]);
+            bounds.max[k % 3] = std::max(bounds.max[k % 3], hi[k]);
+        }
+        for (; i < n; i++)
+        {
+            bounds.min[i % 3] = std::min(bounds.min[i % 3], f[i]);
+            bounds.max[i % 3] = std::max(bounds.max[i % 3], f[i]);
+        }
+        return bounds;
+    }
+
+    Bounds ComputeBounds(std::span<const vec3> positions, unsigned threads)
+    {
+        std::vector<Bounds> partial(ChunkCount(positions.size(), MinStreamChunk, threads));
+        ParallelFor(positions.size(), MinStreamChunk, threads, [&](size_t begin, size_t end, size_t chunk)
+                    { partial[chunk] = BoundsOf(positions.data() + begin, end - begin); });
+
+        Bounds bounds;
+        for (const Bounds &b : partial)
+        {
+            bounds.min = min(bounds.min, b.min);
+            bounds.max = max(bounds.max, b.max);
+        }
+        return bounds;
+    }
+
+    static dvec3 SumOf(const vec3 *positions, size_t count)
+    {
+        const float *f = &positions->x;
+        const size_t n = count * 3;
+        double sum[Lanes] = {};
+        size_t i = 0;
+        for (; i + Lanes <= n; i += Lanes)
+            for (size_t k = 0; k < Lanes; k++)
+                sum[k] += f[i + k];
+
+        dvec3 total(0.0);
+        for (size_t k = 0; k < Lanes; k++)
+            total[k % 3] += sum[k];
+        for (; i < n; i++)
+            total[i % 3] += f[i];
+        return total;
+    }
+
+    vec3 ComputeCentroid(std::span<const vec3> positions, unsigned threads)
+    {
+        if (positions.empty())
+            return vec3(0);
+        std::vector<dvec3> partial(ChunkCount(positions.size(), MinStreamChunk, threads));
+        ParallelFor(positions.size(), MinStreamChunk, threads, [&](size_t begin, size_t end, size_t chunk)
+                    { partial[chunk] = SumOf(positions.data() + begin, end - begin); });
+
+        dvec3 total(0.0);
+        for (const dvec3 &sum : partial)
+            total += sum;
+        return vec3(total / double(positions.size()));
+    }
+
+    void Translate(std::span<vec3> positions, vec3 offset, unsigned threads)
+    {
+        float pattern[Lanes];
+        for (size_t k = 0; k < Lanes; k++)
+            pattern[k] = offset[k % 3];
+        ParallelFor(positions.size(), MinStreamChunk, threads, [&](size_t begin, size_t end, size_t)
+        {
+            float *f = &positions[begin].x;
+            const size_t n = (end - begin) * 3;
+            size_t i = 0;
+            for (; i + Lanes <= n; i += Lanes)
+                for (size_t k = 0; k < Lanes; k++)
+                    f[i + k] += pattern[k];
+            for (; i < n; i++)
+                f[i] += pattern[i % 3];
+        });
+    }
+
+    void Scale(std::span<vec3> positions, float factor, unsigned threads)
+    {
+        ParallelFor(positions.size(), MinStreamChunk, threads, [&](size_t begin, size_t end, size_t)
+        {
+            float *f = &positions[begin].x;
+            const size_t n = (end - begin) * 3;
+            for (size_t i = 0; i < n; i++)
+                f[i] *= factor;
+        });
+    }
+
+    static void AccumulateNormals(const vec3 *positions, const uint32_t *indices, size_t triBegin, size_t triEnd, vec3 *normals)
+    {
+        for (size_t t = triBegin; t < triEnd; t++)
+        {
+            const uint32_t i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+            const vec3 ab = positions[i0] - positions[i1];
+            const vec3 ac = positions[i0] - positions[i2];
+            const vec3 bc = positions[i1] - positions[i2];
+            const float ab2 = dot(ab, ab), ac2 = dot(ac, ac), bc2 = dot(bc, bc);
+            if (ab2 == 0.0f || ac2 == 0.0f || bc2 == 0.0f)
+                continue;
+
+            // |cross| is twice the area, so dividing by the two edge lengths that meet at a
+            // corner gives the unit face normal scaled by that corner's sine: one cross product
+            // and three square roots instead of two crosses and six normalizations
+            const vec3 n = cross(ab, ac);
+            const float iab = inversesqrt(ab2), iac = inversesqrt(ac2), ibc = inversesqrt(bc2);
+            normals[i0] += n * (iab * iac);
+            normals[i1] += n * (iab * ibc);
+            normals[i2] += n * (iac * ibc);
+        }
+    }
+
+    static void NormalizeRange(vec3 *normals, size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; v++)
+        {
+            const float len2 = dot(normals[v], normals[v]);
+            normals[v] = len2 > 0.0f ? normals[v] * inversesqrt(len2) : vec3(0);
+        }
+    }
+
+    void ComputeNormals(std::span<const vec3> positions, std::span<const uint32_t> indices, std::span<vec3> normals, unsigned threads)
+    {
+        const size_t vertexCount = std::min(positions.size(), normals.size());
+        const size_t triCount = indices.size() / 3;
+        std::fill(normals.begin(), normals.begin() + vertexCount, vec3(0));
+
+        // triangles share vertices across chunks, so every chunk but the first accumulates
+        // into its own array and the arrays are summed per vertex range afterwards
+        const size_t chunks = ChunkCount(triCount, MinTriangleChunk, threads);
+        std::vector<std::vector<vec3>> scratch(chunks > 1 ? chunks - 1 : 0);
+        ParallelFor(triCount, MinTriangleChunk, threads, [&](size_t begin, size_t end, size_t chunk)
+        {
+            vec3 *target = normals.data();
+            if (chunk > 0)
+            {
+                scratch[chunk - 1].assign(vertexCount, vec3(0));
+                target = scratch[chunk - 1].data();
+            }
+            AccumulateNormals(positions.data(), indices.data(), begin, end, target);
+        });
+
+        ParallelFor(vertexCount, MinStreamChunk, threads, [&](size_t begin, size_t end, size_t)
+        {
+            for (const auto &partial : scratch)
+                for (size_t v = begin; v < end; v++)
+                    normals[v] += partial[v];
+            NormalizeRange(normals.data(), begin, end);
+        });
+    }
+}
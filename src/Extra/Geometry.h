@@ -0,0 +1,54 @@
+#pragma once
+#include "../lib_include.h"
+#include <cstdint>
+#include <span>
+
+namespace ImguiBase::Geometry
+{
+    // Kernels over a contiguous position stream (12 bytes per vertex instead of the 48 of a
+    // Vertex). Large inputs are split into chunks that each accumulate privately and are then
+    // reduced, so results do not depend on scheduling. threads = 0 uses every core.
+
+    struct Bounds
+    {
+        vec3 min{INFINITY};
+        vec3 max{-INFINITY};
+        bool Empty() const { return min.x > max.x; }
+    };
+
+    Bounds ComputeBounds(std::span<const vec3> positions, unsigned threads = 0);
+    /// @brief Mean position, accumulated in double; zero for an empty stream.
+    vec3 ComputeCentroid(std::span<const vec3> positions, unsigned threads = 0);
+    void Translate(std::span<vec3> positions, vec3 offset, unsigned threads = 0);
+    void Scale(std::span<vec3> positions, float factor, unsigned threads = 0);
+
+    /// @brief Smooth vertex normals: face normals weighted by the sine of each corner's angle,
+    /// as Mesh::CalculateNormals always has. Degenerate triangles are skipped and vertices
+    /// without any face get a zero normal. `normals` must be as long as `positions`.
+    void ComputeNormals(std::span<const vec3> positions, std::span<const uint32_t> indices, std::span<vec3> normals, unsigned threads = 0);
+
+    /// @brief Calls fn(begin, end, chunk) over [0, count) split into at most `threads` chunks of
+    /// at least `minChunk` items; the first chunk runs on the calling thread. Returns the chunk count.
+    template <typename Fn>
+    size_t ParallelFor(size_t count, size_t minChunk, unsigned threads, Fn &&fn);
+    size_t ChunkCount(size_t count, size_t minChunk, unsigned threads);
+}
+
+#include <future>
+#include <vector>
+
+template <typename Fn>
+size_t ImguiBase::Geometry::ParallelFor(size_t count, size_t minChunk, unsigned threads, Fn &&fn)
+{
+    const size_t chunks = ChunkCount(count, minChunk, threads);
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks);
+    for (size_t c = 1; c < chunks; c++)
+        pending.push_back(std::async(std::launch::async, [&fn, c, count, chunks]
+                                     { fn(count * c / chunks, count * (c + 1) / chunks, c); }));
+    if (chunks)
+        fn(size_t(0), count / chunks, size_t(0));
+    for (auto &p : pending)
+        p.get();
+    return chunks;
+}
@@ -0,0 +1,407 @@
+#include "GeometryCompute.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+namespace ImguiBase
+{
+    static constexpr GLuint GroupSize = 256;
+    // the reduction walks the vertices grid-stride, so its partials stay small to read back
+    static constexpr size_t MaxReduceGroups = 1024;
+
+    // SSBO binding points shared by the shaders below
+    static constexpr GLuint VertexBinding = 0, IndexBinding = 1, AccumulatorBinding = 2, PartialBinding = 3, ValenceBinding = 4;
+
+    // Shared by the shaders: raw buffer access, since the vertex layout (float or packed)
+    // and the index type (16 or 32 bit) are only known at dispatch time.
+    static const char *CommonSource = R"(
+layout(local_size_x = 256) in;
+uniform int uStride; // vertex stride in 32 bit words
+uint InvocationIndex() { return gl_GlobalInvocationID.y * gl_NumWorkGroups.x * 256u + gl_GlobalInvocationID.x; }
+)";
+
+    // Normals are summed as fixed point, each face adding at most 1 per component. 20 fractional
+    // bits leave room for 2047 faces per vertex in an int; the valence pass records the highest
+    // power of two reached from 2048 on, and every bit past that comes off the scale.
+    static const char *NormalsCommonSource = R"(
+layout(std430, binding = 1) readonly buffer Indices { uint indexData[]; };
+layout(std430, binding = 4) buffer Valence { int maxValence; int valence[]; };
+uniform int uTriangleCount;
+uniform bool uShortIndices;
+
+uint FetchIndex(uint i)
+{
+    return uShortIndices ? (indexData[i >> 1] >> ((i & 1u) * 16u)) & 0xFFFFu : indexData[i];
+}
+float FixedScale() { return exp2(float(min(20, 30 - findMSB(max(maxValence, 1))))); }
+)";
+
+    static const char *ValenceSource = R"(
+void main()
+{
+    uint t = InvocationIndex();
+    if (t >= uint(uTriangleCount))
+        return;
+    for (uint c = 0u; c < 3u; c++)
+    {
+        // only the crossings change the scale, which keeps the shared counter nearly uncontended
+        int faces = atomicAdd(valence[FetchIndex(t * 3u + c)], 1) + 1;
+        if (faces >= 2048 && (faces & (faces - 1)) == 0)
+            atomicMax(maxValence, faces);
+    }
+}
+)";
+
+    static const char *AccumulateSource = R"(
+layout(std430, binding = 0) readonly buffer Vertices { uint vertexData[]; };
+layout(std430, binding = 2) buffer Accumulator { int accumulator[]; };
+
+vec3 FetchPosition(uint v)
+{
+    uint base = v * uint(uStride);
+    return uintBitsToFloat(uvec3(vertexData[base], vertexData[base + 1], vertexData[base + 2]));
+}
+void Add(uint v, vec3 n, float scale)
+{
+    ivec3 q = ivec3(round(n * scale));
+    atomicAdd(accumulator[v * 3], q.x);
+    atomicAdd(accumulator[v * 3 + 1], q.y);
+    atomicAdd(accumulator[v * 3 + 2], q.z);
+}
+
+// same weighting as Geometry::ComputeNormals: the face normal scaled by each corner's sine
+void main()
+{
+    uint t = InvocationIndex();
+    if (t >= uint(uTriangleCount))
+        return;
+    uint i0 = FetchIndex(t * 3), i1 = FetchIndex(t * 3 + 1), i2 = FetchIndex(t * 3 + 2);
+    vec3 a = FetchPosition(i0), b = FetchPosition(i1), c = FetchPosition(i2);
+    vec3 ab = a - b, ac = a - c, bc = b - c;
+    float ab2 = dot(ab, ab), ac2 = dot(ac, ac), bc2 = dot(bc, bc);
+    if (ab2 == 0.0 || ac2 == 0.0 || bc2 == 0.0)
+        return;
+    vec3 n = cross(ab, ac);
+    float iab = inversesqrt(ab2), iac = inversesqrt(ac2), ibc = inversesqrt(bc2);
+    float scale = FixedScale();
+    Add(i0, n * (iab * iac), scale);
+    Add(i1, n * (iab * ibc), scale);
+    Add(i2, n * (iac * ibc), scale);
+}
+)";
+
+    static const char *WriteSource = R"(
+layout(std430, binding = 0) buffer Vertices { uint vertexData[]; };
+layout(std430, binding = 2) readonly buffer Accumulator { int accumulator[]; };
+uniform int uVertexCount;
+uniform bool uPacked;
+
+// matches glm::packSnorm3x10_1x2 with w = 0, what GL_Mesh uploads for packed normals
+uint PackSnorm10(float v) { return uint(int(round(clamp(v, -1.0, 1.0) * 511.0))) & 0x3FFu; }
+
+void main()
+{
+    uint v = InvocationIndex();
+    if (v >= uint(uVertexCount))
+        return;
+    vec3 n = vec3(accumulator[v * 3], accumulator[v * 3 + 1], accumulator[v * 3 + 2]) / FixedScale();
+    float len2 = dot(n, n);
+    n = len2 > 0.0 ? n * inversesqrt(len2) : vec3(0);
+
+    uint base = v * uint(uStride) + 3;
+    if (uPacked)
+        vertexData[base] = PackSnorm10(n.x) | PackSnorm10(n.y) << 10 | PackSnorm10(n.z) << 20;
+    else
+    {
+        vertexData[base] = floatBitsToUint(n.x);
+        vertexData[base + 1] = floatBitsToUint(n.y);
+        vertexData[base + 2] = floatBitsToUint(n.z);
+    }
+}
+)";
+
+    static const char *ReduceSource = R"(
+layout(std430, binding = 0) readonly buffer Vertices { uint vertexData[]; };
+layout(std430, binding = 3) writeonly buffer Partials { float partials[]; }; // min, max, sum per group
+uniform int uVertexCount;
+
+shared vec3 sMin[256], sMax[256], sSum[256];
+
+void main()
+{
+    vec3 lo = vec3(3.402823e38), hi = vec3(-3.402823e38), sum = vec3(0);
+    for (uint v = gl_GlobalInvocationID.x; v < uint(uVertexCount); v += gl_NumWorkGroups.x * 256u)
+    {
+        uint base = v * uint(uStride);
+        vec3 p = uintBitsToFloat(uvec3(vertexData[base], vertexData[base + 1], vertexData[base + 2]));
+        lo = min(lo, p);
+        hi = max(hi, p);
+        sum += p;
+    }
+    uint i = gl_LocalInvocationID.x;
+    sMin[i] = lo;
+    sMax[i] = hi;
+    sSum[i] = sum;
+    for (uint stride = 128u; stride > 0u; stride >>= 1)
+    {
+        barrier();
+        if (i < stride)
+        {
+            sMin[i] = min(sMin[i], sMin[i + stride]);
+            sMax[i] = max(sMax[i], sMax[i + stride]);
+            sSum[i] += sSum[i + stride];
+        }
+    }
+    if (i == 0u)
+    {
+        uint base = gl_WorkGroupID.x * 9u;
+        for (int c = 0; c < 3; c++)
+        {
+            partials[base + c] = sMin[0][c];
+            partials[base + 3 + c] = sMax[0][c];
+            partials[base + 6 + c] = sSum[0][c];
+        }
+    }
+}
+)";
+
+    static std::unique_ptr<Program> BuildCompute(const std::string &body)
+    {
+        const std::string source = std::string("#version 430 core\n") + CommonSource + body;
+        auto program = std::make_unique<Program>(std::vector<std::pair<Shader_Stage, std::string>>{{eCompute, source}}, true);
+        if (!program->IsLinked())
+            return nullptr;
+        return program;
+    }
+
+    bool GeometryCompute::Supported()
+    {
+        return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+    }
+
+    GeometryCompute::GeometryCompute()
+    {
+        if (!Supported())
+        {
+            fprintf(stderr, "[WARN] Compute shaders unavailable, geometry runs on the CPU\n");
+            return;
+        }
+        normalsValence = BuildCompute(std::string(NormalsCommonSource) + ValenceSource);
+        normalsAccumulate = BuildCompute(std::string(NormalsCommonSource) + AccumulateSource);
+        normalsWrite = BuildCompute(std::string(NormalsCommonSource) + WriteSource);
+        reduce = BuildCompute(ReduceSource);
+        if (!normalsValence || !normalsAccumulate || !normalsWrite || !reduce)
+        {
+            fprintf(stderr, "[ERROR] Geometry compute shaders failed to build, geometry runs on the CPU\n");
+            normalsValence.reset();
+            normalsAccumulate.reset();
+            normalsWrite.reset();
+            reduce.reset();
+        }
+    }
+
+    GeometryCompute::~GeometryCompute()
+    {
+        if (accumulator)
+            glDeleteBuffers(1, &accumulator);
+        if (valenceBuffer)
+            glDeleteBuffers(1, &valenceBuffer);
+        if (partialBuffer)
+            glDeleteBuffers(1, &partialBuffer);
+    }
+
+    void GeometryCompute::EnsureBuffer(GLuint &buffer, size_t &capacity, size_t bytes)
+    {
+        if (buffer && capacity >= bytes)
+            return;
+        if (buffer)
+            glDeleteBuffers(1, &buffer);
+        capacity = std::max(bytes, capacity * 2);
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, capacity, nullptr, 0);
+    }
+
+    void GeometryCompute::Dispatch(size_t invocations)
+    {
+        Profiler::Scope scope("glDispatchCompute");
+        // 65535 groups per dimension is all GL guarantees, so large counts spill into y
+        const size_t groups = (invocations + GroupSize - 1) / GroupSize;
+        const GLuint x = GLuint(std::min<size_t>(groups, 65535));
+        const GLuint y = GLuint((groups + x - 1) / x);
+        glDispatchCompute(x, y, 1);
+    }
+
+    bool GeometryCompute::CanDispatch(const GL_Mesh &mesh) const
+    {
+        return UsesGpu() && !mesh.GetFormat().persistent && mesh.GetVertexCount() > 0;
+    }
+
+    // Positions from the CPU copy, or from the vertex buffer when the mesh dropped it
+    static std::vector<vec3> ReadPositions(const GL_Mesh &mesh, std::vector<char> *raw = nullptr)
+    {
+        std::vector<vec3> positions(mesh.GetVertexCount());
+        const auto &verticies = mesh.GetVerticies();
+        if (verticies.size() == positions.size() && !raw)
+        {
+            for (size_t i = 0; i < positions.size(); i++)
+                positions[i] = verticies[i].Position;
+            return positions;
+        }
+        const size_t stride = GL_Mesh::VertexStride(mesh.GetFormat().layout);
+        std::vector<char> bytes(positions.size() * stride);
+        glGetNamedBufferSubData(mesh.GetVertexBuffer(), 0, bytes.size(), bytes.data());
+        for (size_t i = 0; i < positions.size(); i++)
+            memcpy(&positions[i], bytes.data() + i * stride, sizeof(vec3));
+        if (raw)
+            *raw = std::move(bytes);
+        return positions;
+    }
+
+    void GeometryCompute::CalculateNormalsCpu(GL_Mesh &mesh)
+    {
+        if (mesh.GetVerticies().size() == mesh.GetVertexCount())
+        {
+            mesh.CalculateNormals();
+            return;
+        }
+        if (mesh.GetFormat().persistent)
+        {
+            fprintf(stderr, "[WARN] GeometryCompute: persistent mesh without a CPU copy, normals left as they are\n");
+            return;
+        }
+
+        // no CPU copy: read both buffers back, patch the normals in place and upload once
+        std::vector<char> raw;
+        const std::vector<vec3> positions = ReadPositions(mesh, &raw);
+        std::vector<uint32_t> indices(mesh.GetIndexCount());
+        if (mesh.GetIndexType() == GL_UNSIGNED_SHORT)
+        {
+            std::vector<uint16_t> narrow(indices.size());
+            glGetNamedBufferSubData(mesh.GetIndexBuffer(), 0, narrow.size() * 2, narrow.data());
+            std::copy(narrow.begin(), narrow.end(), indices.begin());
+        }
+        else
+            glGetNamedBufferSubData(mesh.GetIndexBuffer(), 0, indices.size() * 4, indices.data());
+
+        std::vector<vec3> normals(positions.size());
+        Geometry::ComputeNormals(positions, indices, normals);
+
+        const size_t stride = GL_Mesh::VertexStride(mesh.GetFormat().layout);
+        const bool packed = mesh.GetFormat().layout == VertexLayout::Packed;
+        for (size_t i = 0; i < normals.size(); i++)
+        {
+            char *normal = raw.data() + i * stride + sizeof(vec3);
+            if (packed)
+            {
+                const uint32_t bits = packSnorm3x10_1x2(vec4(normals[i], 0));
+                memcpy(normal, &bits, sizeof(bits));
+            }
+            else
+                memcpy(normal, &normals[i], sizeof(vec3));
+        }
+        glNamedBufferSubData(mesh.GetVertexBuffer(), 0, raw.size(), raw.data());
+    }
+
+    void GeometryCompute::CalculateNormals(GL_Mesh &mesh)
+    {
+        Profiler::Scope scope("GeometryCompute::CalculateNormals");
+        if (!CanDispatch(mesh))
+        {
+            CalculateNormalsCpu(mesh);
+            return;
+        }
+
+        const size_t vertexCount = mesh.GetVertexCount();
+        const size_t triangleCount = mesh.GetIndexCount() / 3;
+        const int stride = int(GL_Mesh::VertexStride(mesh.GetFormat().layout) / 4);
+        EnsureBuffer(accumulator, accumulatorBytes, vertexCount * 3 * sizeof(GLint));
+        glClearNamedBufferSubData(accumulator, GL_R32I, 0, vertexCount * 3 * sizeof(GLint), GL_RED_INTEGER, GL_INT, nullptr);
+        EnsureBuffer(valenceBuffer, valenceBytes, (vertexCount + 1) * sizeof(GLint));
+        glClearNamedBufferSubData(valenceBuffer, GL_R32I, 0, (vertexCount + 1) * sizeof(GLint), GL_RED_INTEGER, GL_INT, nullptr);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VertexBinding, mesh.GetVertexBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndexBinding, mesh.GetIndexBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, AccumulatorBinding, accumulator);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ValenceBinding, valenceBuffer);
+
+        if (triangleCount > 0)
+        {
+            const bool shortIndices = mesh.GetIndexType() == GL_UNSIGNED_SHORT;
+            normalsValence->PushUniform("uTriangleCount", int(triangleCount));
+            normalsValence->PushUniform("uShortIndices", shortIndices);
+            normalsValence->Use();
+            Dispatch(triangleCount);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+            normalsAccumulate->PushUniform("uStride", stride);
+            normalsAccumulate->PushUniform("uTriangleCount", int(triangleCount));
+            normalsAccumulate->PushUniform("uShortIndices", shortIndices);
+            normalsAccumulate->Use();
+            Dispatch(triangleCount);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        normalsWrite->PushUniform("uStride", stride);
+        normalsWrite->PushUniform("uVertexCount", int(vertexCount));
+        normalsWrite->PushUniform("uPacked", mesh.GetFormat().layout == VertexLayout::Packed);
+        normalsWrite->Use();
+        Dispatch(vertexCount);
+        normalsWrite->Unuse();
+
+        // the next draw fetches the rewritten normals as vertex attributes
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+
+    GeometryCompute::PendingReduction GeometryCompute::Reduce(const GL_Mesh &mesh)
+    {
+        Profiler::Scope scope("GeometryCompute::Reduce");
+        PendingReduction pending;
+        pending.vertexCount = mesh.GetVertexCount();
+        if (!CanDispatch(mesh))
+        {
+            const std::vector<vec3> positions = ReadPositions(mesh);
+            pending.result.bounds = Geometry::ComputeBounds(positions);
+            pending.result.centroid = Geometry::ComputeCentroid(positions);
+            pending.done = true;
+            return pending;
+        }
+
+        pending.groups = std::min(MaxReduceGroups, (pending.vertexCount + GroupSize - 1) / GroupSize);
+        const size_t bytes = pending.groups * 9 * sizeof(float);
+        EnsureBuffer(partialBuffer, partialBytes, bytes);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VertexBinding, mesh.GetVertexBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PartialBinding, partialBuffer);
+        reduce->PushUniform("uStride", int(GL_Mesh::VertexStride(mesh.GetFormat().layout) / 4));
+        reduce->PushUniform("uVertexCount", int(pending.vertexCount));
+        reduce->Use();
+        {
+            Profiler::Scope dispatch("glDispatchCompute");
+            glDispatchCompute(GLuint(pending.groups), 1, 1);
+        }
+        reduce->Unuse();
+
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        pending.partials = Readback::FromBuffer(partialBuffer, 0, bytes);
+        return pending;
+    }
+
+    GeometryCompute::Reduction GeometryCompute::PendingReduction::Get()
+    {
+        if (done)
+            return result;
+        const float *p = static_cast<const float *>(partials.Wait());
+        dvec3 sum(0.0);
+        for (size_t g = 0; g < groups; g++, p += 9)
+        {
+            result.bounds.min = min(result.bounds.min, vec3(p[0], p[1], p[2]));
+            result.bounds.max = max(result.bounds.max, vec3(p[3], p[4], p[5]));
+            sum += dvec3(vec3(p[6], p[7], p[8]));
+        }
+        result.centroid = vertexCount ? vec3(sum / double(vertexCount)) : vec3(0);
+        partials = Readback();
+        done = true;
+        return result;
+    }
+}
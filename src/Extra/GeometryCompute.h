@@ -0,0 +1,68 @@
+#pragma once
+#include "Geometry.h"
+#include "Mesh.h"
+#include "Program.h"
+#include "Readback.h"
+#include <memory>
+
+namespace ImguiBase
+{
+    /// @brief Normal generation and bounds/centroid reductions run by compute shaders directly on a
+    /// GL_Mesh's vertex and index buffers, so large meshes skip the CalculateNormals + upload round
+    /// trip. Falls back to the Geometry CPU kernels where compute shaders are unavailable (GL < 4.3)
+    /// and for persistent meshes, whose vertices live in a CPU-written ring.
+    class GeometryCompute
+    {
+    public:
+        struct Reduction
+        {
+            Geometry::Bounds bounds;
+            vec3 centroid{0};
+        };
+
+        /// @brief A reduction in flight; the per-workgroup partials are read back behind a fence.
+        class PendingReduction
+        {
+            friend class GeometryCompute;
+            Readback partials;
+            size_t groups = 0;
+            size_t vertexCount = 0;
+            Reduction result;
+            bool done = false;
+
+        public:
+            bool Ready() const { return done || partials.Ready(); }
+            /// @brief Blocks until the partials have landed when called before Ready().
+            Reduction Get();
+        };
+
+        /// @brief Needs a current GL context; compiles the shaders when compute is supported.
+        GeometryCompute();
+        ~GeometryCompute();
+        GeometryCompute(const GeometryCompute &) = delete;
+        GeometryCompute &operator=(const GeometryCompute &) = delete;
+
+        static bool Supported();
+        /// @brief True when work is dispatched to the GPU rather than handled by the fallback.
+        bool UsesGpu() const { return normalsAccumulate != nullptr; }
+
+        /// @brief Rewrites the normals in the vertex buffer. The CPU copy is left as it was, so a
+        /// later CPU edit of a vertex uploads its old normal again.
+        void CalculateNormals(GL_Mesh &mesh);
+        PendingReduction Reduce(const GL_Mesh &mesh);
+
+    private:
+        std::unique_ptr<Program> normalsValence, normalsAccumulate, normalsWrite, reduce;
+        GLuint accumulator = 0; // 3 fixed-point ints per vertex
+        size_t accumulatorBytes = 0;
+        GLuint valenceBuffer = 0; // the highest valence, then a face count per vertex
+        size_t valenceBytes = 0;
+        GLuint partialBuffer = 0;
+        size_t partialBytes = 0;
+
+        bool CanDispatch(const GL_Mesh &mesh) const;
+        void CalculateNormalsCpu(GL_Mesh &mesh);
+        static void Dispatch(size_t invocations);
+        static void EnsureBuffer(GLuint &buffer, size_t &capacity, size_t bytes);
+    };
+}
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ImguiBase
+{
+#if defined(_WIN32)
+    MappedFile::MappedFile(const std::string &filepath)
+    {
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Could not open file");
+        fileHandle = file;
+
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        length = (size_t)fileSize.QuadPart;
+        if (length == 0)
+            return;
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            Release();
+            throw std::runtime_error("Could not map file");
+        }
+        mappingHandle = mapping;
+        bytes = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!bytes)
+        {
+            Release();
+            throw std::runtime_error("Could not map file");
+        }
+    }
+
+    void MappedFile::Release()
+    {
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        if (fileHandle)
+            CloseHandle(fileHandle);
+        bytes = nullptr;
+        mappingHandle = fileHandle = nullptr;
+        length = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string &filepath)
+    {
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Could not open file");
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("Could not open file");
+        }
+        length = (size_t)st.st_size;
+        if (length > 0)
+        {
+            void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("Could not map file");
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char *>(mapped);
+        }
+        // the mapping keeps the file alive
+        close(fd);
+    }
+
+    void MappedFile::Release()
+    {
+        if (bytes)
+            munmap(const_cast<char *>(bytes), length);
+        bytes = nullptr;
+        length = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile()
+    {
+        Release();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            std::swap(bytes, other.bytes);
+            std::swap(length, other.length);
+#if defined(_WIN32)
+            std::swap(fileHandle, other.fileHandle);
+            std::swap(mappingHandle, other.mappingHandle);
+#endif
+        }
+        return *this;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace ImguiBase
+{
+    /// @brief Read-only memory mapping of a whole file. Throws std::runtime_error if it cannot be opened.
+    class MappedFile
+    {
+        const char *bytes = nullptr;
+        size_t length = 0;
+#if defined(_WIN32)
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+        void Release();
+
+    public:
+        explicit MappedFile(const std::string &filepath);
+        ~MappedFile();
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        const char *data() const { return bytes; }
+        size_t size() const { return length; }
+    };
+}
@@ -1,318 +1,780 @@
 #include "Mesh.h"
+#include "Geometry.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "Profiler.h"
+#include "VertexDedupeMap.h"
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <array>
 #include <algorithm>
 #include <filesystem>
-#define OBJ_JUMP_VALUE(x, y) (uint16_t(x) << 8) + y
+#include <cstddef>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
 
-static std::vector<std::string> split(const std::string &str, char divider, bool AddEmpties = false)
+namespace ImguiBase
 {
-    std::vector<std::string> result;
-    std::string temp;
+    Mesh::Mesh(Mesh &&other) noexcept : verticies(std::move(other.verticies)), indicies(std::move(other.indicies))
+    {
+        // a range into the emptied vectors must not be flushed by the source's open batch
+        other.ClearDirty();
+    }
 
-    for (char ch : str)
+    Mesh &Mesh::operator=(const Mesh &other)
     {
-        if (ch == divider)
-        {
-            if (!temp.empty() || AddEmpties)
-            {
-                result.push_back(temp);
-                temp.clear();
-            }
-        }
-        else
-        {
-            temp += ch; // Add character to the current substring
-        }
+        if (this == &other)
+            return *this;
+        ClearDirty();
+        Batch batch(*this);
+        SetVerticies(other.verticies);
+        SetIndicies(other.indicies);
+        return *this;
     }
 
-    if (!temp.empty())
+    Mesh &Mesh::operator=(Mesh &&other)
     {
-        result.push_back(temp); // Add the last substring
+        if (this == &other)
+            return *this;
+        ClearDirty();
+        Batch batch(*this);
+        SetVerticies(std::move(other.verticies));
+        SetIndicies(std::move(other.indicies));
+        other.ClearDirty();
+        return *this;
     }
 
-    return result;
-}
-namespace ImguiBase
-{
-    void Mesh::Centerize()
+    void Mesh::SetVerticies(const decltype(verticies) &_v)
     {
-        vec3 pos = {0, 0, 0};
-        for (const Vertex &v : verticies)
-            pos += v.Position;
-        pos /= verticies.size();
-        for (auto &v : verticies)
-            v.Position -= pos;
+        verticies = _v;
+        MarkVerticiesDirty(0, verticies.size());
+    }
+    void Mesh::SetVerticies(decltype(verticies) &&_v)
+    {
+        verticies = std::move(_v);
+        MarkVerticiesDirty(0, verticies.size());
+    }
+    void Mesh::SetIndicies(const decltype(indicies) &_i)
+    {
+        indicies = _i;
+        MarkIndiciesDirty();
+    }
+    void Mesh::SetIndicies(decltype(indicies) &&_i)
+    {
+        indicies = std::move(_i);
+        MarkIndiciesDirty();
+    }
+
+    void Mesh::UpdateVerticies(size_t first, const Vertex *data, size_t count)
+    {
+        if (first + count > verticies.size())
+            verticies.resize(first + count);
+        std::copy(data, data + count, verticies.begin() + first);
+        MarkVerticiesDirty(first, count);
+    }
 
-        SetVerticies(GetVerticies());
+    void Mesh::MarkVerticiesDirty(size_t first, size_t count)
+    {
+        dirtyBegin = std::min(dirtyBegin, first);
+        dirtyEnd = std::max(dirtyEnd, first + count);
+        if (batchDepth == 0)
+            FlushChanges();
+    }
+    void Mesh::MarkIndiciesDirty()
+    {
+        indiciesDirty = true;
+        if (batchDepth == 0)
+            FlushChanges();
+    }
+
+    void Mesh::EndBatch()
+    {
+        if (--batchDepth == 0 && (dirtyEnd > dirtyBegin || indiciesDirty))
+            FlushChanges();
+    }
+
+    void Mesh::ClearDirty()
+    {
+        dirtyBegin = SIZE_MAX;
+        dirtyEnd = 0;
+        indiciesDirty = false;
+    }
+
+    // Geometry kernels work on positions alone; a Vertex is four times wider
+    static std::vector<vec3> GatherPositions(const std::vector<Vertex> &verticies)
+    {
+        std::vector<vec3> positions(verticies.size());
+        Geometry::ParallelFor(verticies.size(), 1 << 16, 0, [&](size_t begin, size_t end, size_t)
+                              {
+            for (size_t i = begin; i < end; i++)
+                positions[i] = verticies[i].Position; });
+        return positions;
+    }
+
+    void Mesh::Centerize()
+    {
+        if (verticies.empty())
+            return;
+        const vec3 pos = Geometry::ComputeCentroid(GatherPositions(verticies));
+        Geometry::ParallelFor(verticies.size(), 1 << 16, 0, [&](size_t begin, size_t end, size_t)
+                              {
+            for (size_t i = begin; i < end; i++)
+                verticies[i].Position -= pos; });
+
+        MarkVerticiesDirty(0, verticies.size());
     }
 
     void Mesh::FitToBounds(const float size)
     {
-        vec3 minSize, maxSize;
-        for (const auto &v : verticies)
-        {
-            minSize = min(v.Position, minSize);
-            maxSize = max(v.Position, maxSize);
-        }
+        const Geometry::Bounds bounds = Geometry::ComputeBounds(GatherPositions(verticies));
+        if (bounds.Empty())
+            return;
         float largest = -INFINITY;
         for (int i = 0; i < 3; i++)
-            largest = max(maxSize[i], largest);
+            largest = max(bounds.max[i], largest);
         float smallest = INFINITY;
         for (int i = 0; i < 3; i++)
-            smallest = min(minSize[i], smallest);
+            smallest = min(bounds.min[i], smallest);
 
         const float finalScale = abs(largest) >= abs(smallest) ? abs(largest) : abs(smallest);
+        if (finalScale == 0.0f)
+            return;
+
+        const float factor = size / finalScale;
+        Geometry::ParallelFor(verticies.size(), 1 << 16, 0, [&](size_t begin, size_t end, size_t)
+                              {
+            for (size_t i = begin; i < end; i++)
+                verticies[i].Position *= factor; });
+        MarkVerticiesDirty(0, verticies.size());
+    }
+
+    void Mesh::CalculateNormals()
+    {
+        const std::vector<vec3> positions = GatherPositions(verticies);
+        std::vector<vec3> normals(positions.size());
+        Geometry::ComputeNormals(positions, indicies, normals);
+        Geometry::ParallelFor(verticies.size(), 1 << 16, 0, [&](size_t begin, size_t end, size_t)
+                              {
+            for (size_t i = begin; i < end; i++)
+                verticies[i].Normal = normals[i]; });
+
+        MarkVerticiesDirty(0, verticies.size());
+    }
+
+    void Mesh::Optimize(bool reduceOverdraw)
+    {
+        MeshOptimizer::OptimizeVertexCache(indicies, verticies.size());
+        if (reduceOverdraw)
+            MeshOptimizer::OptimizeOverdraw(indicies, verticies);
+        MeshOptimizer::OptimizeVertexFetch(verticies, indicies);
+
+        Batch batch(*this);
+        MarkVerticiesDirty(0, verticies.size());
+        MarkIndiciesDirty();
+    }
 
-        for (auto &v : verticies)
+    static Mesh ParseOBJ(const std::string &filepath, bool &colorsFound)
+    {
+        // parsing is memory-mapped and split across cores; assembly below stays serial
+        // so vertex order (first use of each pos/tex/normal triple) is deterministic
+        const Obj::Data data = Obj::ParseFile(filepath);
+        colorsFound = data.colorsFound;
+
+        // closed meshes have about half as many vertices as faces, seams push that up;
+        // one slot per face covers the common case without rehashing
+        VertexDedupeMap vertexEntries(std::max(data.corners.size() / 3, data.positions.size()));
+        std::vector<Vertex> verticies;
+        std::vector<uint32_t> indicies;
+        indicies.reserve(data.corners.size());
+
+        for (const auto &key : data.corners)
         {
-            v.Position /= (finalScale / size);
+            bool inserted;
+            const uint32_t vertIndex = vertexEntries.FindOrInsert(key, uint32_t(verticies.size()), inserted);
+            indicies.push_back(vertIndex);
+            if (!inserted)
+                continue;
+
+            Vertex v;
+            v.Position = {0, 0, 0};
+            v.Normal = {0, 0, 0};
+            v.Color = {0, 0, 0, 0};
+            v.TexCoord = {0, 0};
+
+            // vertex_index/texture_index/normal_index
+            if (key[0] != Obj::Missing)
+                v.Position = data.positions[key[0]];
+            if (key[1] != Obj::Missing)
+                v.TexCoord = data.texCoords[key[1]];
+            if (key[2] != Obj::Missing)
+                v.Normal = data.normals[key[2]];
+
+            verticies.push_back(v);
         }
-        SetVerticies(GetVerticies());
+
+        Mesh mesh;
+        mesh.SetVerticies(std::move(verticies));
+        mesh.SetIndicies(std::move(indicies));
+        return mesh;
     }
 
-    void Mesh::CalculateNormals()
+    Mesh ImguiBase::Mesh::FromOBJ(const std::string &filepath, bool &colorsFound)
     {
-        for (auto &v : verticies)
-            v.Normal = {0, 0, 0};
+        if (auto cached = MeshCache::Open(filepath))
+        {
+            colorsFound = cached->header->flags & MeshCache::FlagColorsFound;
+            Mesh mesh;
+            mesh.verticies.assign(cached->vertices, cached->vertices + cached->header->vertexCount);
+            mesh.indicies.assign(cached->indices, cached->indices + cached->header->indexCount);
+            return mesh;
+        }
+        Mesh mesh = ParseOBJ(filepath, colorsFound);
+        MeshCache::Write(filepath, mesh, colorsFound);
+        return mesh;
+    }
+    void GL_Mesh::Init()
+    {
+        glCreateVertexArrays(1, &vao);
+        glCreateBuffers(1, &vbo);
+        glCreateBuffers(1, &ebo);
+        glVertexArrayElementBuffer(vao, ebo);
+
+        // every attribute reads buffer binding 0, which BindRegion points at the vertex buffer
+        auto attribute = [&](GLuint index, GLint size, GLenum type, GLboolean normalized, size_t offset)
+        {
+            glEnableVertexArrayAttrib(vao, index);
+            glVertexArrayAttribFormat(vao, index, size, type, normalized, GLuint(offset));
+            glVertexArrayAttribBinding(vao, index, 0);
+        };
+        if (format.layout == VertexLayout::Float)
+        {
+            attribute(pos_binding, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position));
+            attribute(normal_binding, 3, GL_FLOAT, GL_TRUE, offsetof(Vertex, Normal));
+            attribute(texcoord_binding, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, TexCoord));
+            attribute(color_binding, 4, GL_FLOAT, GL_FALSE, offsetof(Vertex, Color));
+        }
+        else
+        {
+            // same shader inputs, the fixed function fetch unpacks to float
+            attribute(pos_binding, 3, GL_FLOAT, GL_FALSE, offsetof(PackedVertex, Position));
+            attribute(normal_binding, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, Normal));
+            attribute(texcoord_binding, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, TexCoord));
+            attribute(color_binding, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(PackedVertex, Color));
+        }
+        for (int r = 0; r < RingSize; r++)
+        {
+            pendingBegin[r] = SIZE_MAX;
+            pendingEnd[r] = 0;
+        }
+        BindRegion(0);
+
+        if (!verticies.empty())
+            ReplaceVertices(verticies.data(), verticies.size());
+        if (!indicies.empty())
+            UploadIndices(indicies.data(), indicies.size());
+        ClearDirty();
+    }
+    GL_Mesh::GL_Mesh(MeshFormat _format) : format(_format)
+    {
+        Init();
+    }
+
+    GL_Mesh::GL_Mesh(const Mesh &mesh, MeshFormat _format) : Mesh(mesh), format(_format)
+    {
+        Init();
+    }
+
+    GL_Mesh::GL_Mesh(Mesh &&mesh, MeshFormat _format) : Mesh(std::move(mesh)), format(_format)
+    {
+        Init();
+    }
+
+    GL_Mesh &GL_Mesh::operator=(const Mesh &mesh)
+    {
+        cpuCopy = true;
+        Mesh::operator=(mesh);
+        return *this;
+    }
+
+    GL_Mesh &GL_Mesh::operator=(Mesh &&mesh)
+    {
+        cpuCopy = true;
+        Mesh::operator=(std::move(mesh));
+        return *this;
+    }
 
-        for (int i = 0; i < indicies.size(); i += 3)
+    GL_Mesh::~GL_Mesh()
+    {
+        for (GLsync &fence : fences)
+            if (fence)
+                glDeleteSync(fence);
+        if (mapped)
+            glUnmapNamedBuffer(vbo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+    }
+
+    void GL_Mesh::LoadOBJ(const std::string &filepath, bool &colorsFound, bool keepCpuCopy)
+    {
+        if (auto cached = MeshCache::Open(filepath))
         {
-            vec3 verts[] = {
-                verticies[indicies[i]].Position,
-                verticies[indicies[i + 1]].Position,
-                verticies[indicies[i + 2]].Position};
-
-            vec3 edges[3] = {// AC AB BC
-                             normalize(verts[0] - verts[2]),
-                             normalize(verts[0] - verts[1]),
-                             normalize(verts[1] - verts[2])};
-            const vec3 normal = normalize(cross(edges[1], edges[0]));
-            for (int v = 0; v < 3; v++)
+            // straight from the mapping into the buffers, no std::vector in between
+            // unless the packed layout has to convert first
+            colorsFound = cached->header->flags & MeshCache::FlagColorsFound;
+            const size_t vCount = cached->header->vertexCount, iCount = cached->header->indexCount;
+            ReplaceVertices(cached->vertices, vCount);
+            UploadIndices(cached->indices, iCount);
+
+            if (keepCpuCopy)
             {
-                Vertex &vert = verticies[indicies[i + v]];
-                vert.Normal += normal * length(cross(edges[v], edges[(v + 1) % 3]));
+                verticies.assign(cached->vertices, cached->vertices + vCount);
+                indicies.assign(cached->indices, cached->indices + iCount);
             }
+            else
+            {
+                verticies = {};
+                indicies = {};
+            }
+            cpuCopy = keepCpuCopy;
+            ClearDirty();
+            return;
         }
-        for (auto &v : verticies)
-            v.Normal = normalize(v.Normal);
 
-        SetVerticies(GetVerticies());
+        *this = Mesh::FromOBJ(filepath, colorsFound);
+        if (!keepCpuCopy)
+        {
+            verticies = {};
+            indicies = {};
+        }
+        cpuCopy = keepCpuCopy;
     }
 
-    Mesh ImguiBase::Mesh::FromOBJ(const std::string &filepath, bool &colorsFound)
+    size_t GL_Mesh::VertexStride(VertexLayout layout)
     {
-        std::vector<vec3> Positions;
-        std::vector<vec3> Normals;
-        std::vector<vec4> Colors;
-        std::vector<vec2> TexCoords;
+        return layout == VertexLayout::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+    }
 
-        std::map<std::array<uint32_t, 3>, size_t> vertexEntries;
-        std::vector<Vertex> verticies;
+    size_t GL_Mesh::GpuBytes() const
+    {
+        const size_t vertexBytes = (format.persistent ? ringCapacity * RingSize : vertexCapacity) * VertexStride(format.layout);
+        return vertexBytes + (indexCapacity + lodIndexCount) * (indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+    }
 
-        std::vector<uint32_t> indicies;
-        colorsFound = false;
-        std::ifstream file(filepath); // Open the file
-        if (!file.is_open())
+    void GL_Mesh::FlushChanges()
+    {
+        if (!cpuCopy)
         {
-            throw std::runtime_error("Could not open file");
+            // the empty vectors would otherwise replace the buffers with nothing while
+            // indexCount still draws from them
+            if (!warnedNoCpuCopy)
+                fprintf(stderr, "[WARN] GL_Mesh: edit dropped, the mesh has no CPU copy (LoadOBJ keepCpuCopy = false)\n");
+            warnedNoCpuCopy = true;
+            ClearDirty();
+            return;
         }
+        if (verticies.size() != vertexCount)
+            ReplaceVertices(verticies.data(), verticies.size());
+        else if (dirtyEnd > dirtyBegin)
+            UpdateVertexRange(dirtyBegin, std::min(dirtyEnd, verticies.size()));
+        if (indiciesDirty)
+            UploadIndices(indicies.data(), indicies.size());
+        ClearDirty();
+    }
 
-        std::string line;
-
-        while (std::getline(file, line))
-        { // Read each line
-            if (line.empty())
-                continue;
+    void GL_Mesh::WriteVertices(void *dst, const Vertex *src, size_t count) const
+    {
+        ConvertVertices(format.layout, dst, src, count);
+    }
 
-            std::replace(line.begin(), line.end(), '\t', ' ');
-            const uint16_t jumpValue = OBJ_JUMP_VALUE(line[0], line[1]);
+    void GL_Mesh::ConvertVertices(VertexLayout layout, void *dst, const Vertex *src, size_t count)
+    {
+        if (layout == VertexLayout::Float)
+        {
+            memcpy(dst, src, count * sizeof(Vertex));
+            return;
+        }
+        PackedVertex *packed = static_cast<PackedVertex *>(dst);
+        for (size_t i = 0; i < count; i++)
+        {
+            packed[i].Position = src[i].Position;
+            packed[i].Normal = packSnorm3x10_1x2(vec4(src[i].Normal, 0));
+            packed[i].TexCoord = packHalf2x16(src[i].TexCoord);
+            packed[i].Color = packUnorm4x8(src[i].Color);
+        }
+    }
 
-            switch (jumpValue)
-            {
-            case OBJ_JUMP_VALUE('v', ' '): // POSITION + COLOR
+    void GL_Mesh::ReplaceVertices(const Vertex *data, size_t count)
+    {
+        const size_t stride = VertexStride(format.layout);
+        if (format.persistent)
+        {
+            if (count > ringCapacity)
+                AllocateRing(std::max(count, ringCapacity * 2));
+            // every region gets the new contents, so wait for the GPU to let go of all of them
+            for (int r = 0; r < RingSize; r++)
             {
-                const std::vector<std::string> splits = split(line, ' ');
-                {
-                    vec3 pos;
-                    for (int i = 0; i < 3; i++)
-                        pos[i] = std::stof(splits[i + 1]);
-                    Positions.push_back(pos);
-                }
-                if (splits.size() <= 4)
-                    continue;
-                {
-                    colorsFound = true;
-                    vec4 color;
-                    color.w = 1;
-                    // w component is optional as specified by the obj file format
-                    const int compCount = splits.size() == 7 ? 3 : 4;
-                    for (int i = 0; i < compCount; i++)
-                        color[i] = std::stof(splits[i + 4]);
-
-                    Colors.push_back(color);
-                }
+                WaitRegion(r);
+                if (count > 0)
+                    WriteVertices(mapped + r * ringCapacity * stride, data, count);
+                pendingBegin[r] = SIZE_MAX;
+                pendingEnd[r] = 0;
             }
-            /* code */
-            break;
-            case OBJ_JUMP_VALUE('v', 'n'): // NORMALS
-            {
+            vertexCount = count;
+            WidenIndicesIfNeeded();
+            return;
+        }
 
-                const std::vector<std::string> splits = split(line, ' ');
-                vec3 normal;
-                for (int i = 0; i < 3; i++)
-                    normal[i] = std::stof(splits[i + 1]);
-                Normals.push_back(normal);
-            }
-            /* code */
-            break;
-            case OBJ_JUMP_VALUE('v', 't'): // TexCoords
-            {
+        std::vector<char> packed;
+        const void *bytes = data;
+        if (format.layout != VertexLayout::Float)
+        {
+            packed.resize(count * stride);
+            WriteVertices(packed.data(), data, count);
+            bytes = packed.data();
+        }
+        if (vertexCount != count)
+        {
+            glNamedBufferData(vbo, count * stride, bytes, GL_STATIC_DRAW);
+            vertexCapacity = count;
+        }
+        else
+            glNamedBufferSubData(vbo, 0, count * stride, bytes);
+        vertexCount = count;
+        WidenIndicesIfNeeded();
+    }
 
-                const std::vector<std::string> splits = split(line, ' ');
-                vec2 texCoord;
-                for (int i = 0; i < 2; i++)
-                    texCoord[i] = std::stof(splits[i + 1]);
-                TexCoords.push_back(texCoord);
-            }
-            /* code */
-            break;
-            case OBJ_JUMP_VALUE('f', ' '): // COMPOSITION
-            {
+    void GL_Mesh::WidenIndicesIfNeeded()
+    {
+        // 16 bit was picked for the old vertex count and cannot address the new vertices
+        if (indexType != GL_UNSIGNED_SHORT || vertexCount <= 0x10000 || indexCount == 0)
+            return;
+        if (cpuCopy)
+        {
+            UploadIndices(indicies.data(), indicies.size());
+            return;
+        }
+        std::vector<uint16_t> narrow(indexCount);
+        glGetNamedBufferSubData(ebo, 0, indexCount * sizeof(uint16_t), narrow.data());
+        const std::vector<GLuint> wide(narrow.begin(), narrow.end());
+        UploadIndices(wide.data(), wide.size());
+    }
 
-                const std::vector<std::string> splits = split(line, ' ');
-
-                for (int i = 0; i < 3; i++)
-                {
-                    const std::vector<std::string> comps = split(splits[i + 1], '/', true);
-                    uint32_t posInd = comps[0].empty() ? -1 : std::stoi(comps[0]) - 1;
-                    uint32_t texInd = comps.size() <= 1 || comps[1].empty() ? -1 : std::stoi(comps[1]) - 1;
-                    uint32_t norInd = comps.size() <= 2 || comps[2].empty() ? -1 : std::stoi(comps[2]) - 1;
-
-                    const decltype(vertexEntries)::iterator entry = vertexEntries.find({posInd, texInd, norInd});
-                    if (entry != vertexEntries.end())
-                    {
-                        indicies.push_back((*entry).second);
-                        continue;
-                    }
-                    Vertex v;
-                    v.Position = {0, 0, 0};
-                    v.Normal = {0, 0, 0};
-                    v.Color = {0, 0, 0, 0};
-                    v.TexCoord = {0, 0};
-
-                    // vertex_index/texture_index/normal_index
-                    if (posInd != -1)
-                        v.Position = Positions[posInd];
-                    if (texInd != -1)
-                        v.TexCoord = TexCoords[texInd];
-                    if (norInd != -1)
-                        v.Normal = Normals[norInd];
-
-                    uint32_t vertIndex = verticies.size();
-                    verticies.push_back(v);
-                    vertexEntries[{posInd, texInd, norInd}] = vertIndex;
-                    indicies.push_back(vertIndex);
-                }
+    void GL_Mesh::UpdateVertexRange(size_t begin, size_t end)
+    {
+        if (begin >= end)
+            return;
+        const size_t stride = VertexStride(format.layout);
+        if (format.persistent)
+        {
+            // the next region also needs whatever changed while the GPU was reading the others
+            for (int r = 0; r < RingSize; r++)
+            {
+                pendingBegin[r] = std::min(pendingBegin[r], begin);
+                pendingEnd[r] = std::max(pendingEnd[r], end);
             }
-            /* code */
-            break;
+            const int next = (ringRegion + 1) % RingSize;
+            WaitRegion(next);
+            const size_t from = pendingBegin[next], to = std::min(pendingEnd[next], verticies.size());
+            WriteVertices(mapped + (next * ringCapacity + from) * stride, verticies.data() + from, to - from);
+            pendingBegin[next] = SIZE_MAX;
+            pendingEnd[next] = 0;
+            BindRegion(next);
+            return;
+        }
 
-            default:
-                break;
-            }
+        std::vector<char> packed;
+        const void *bytes = verticies.data() + begin;
+        if (format.layout != VertexLayout::Float)
+        {
+            packed.resize((end - begin) * stride);
+            WriteVertices(packed.data(), verticies.data() + begin, end - begin);
+            bytes = packed.data();
         }
+        glNamedBufferSubData(vbo, begin * stride, (end - begin) * stride, bytes);
+    }
 
-        file.close(); // Close the file
+    void GL_Mesh::UploadIndices(const GLuint *data, size_t count)
+    {
+        // 16 bit only while every index fits
+        const GLenum type = format.shortIndices && vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        std::vector<uint16_t> narrow;
+        const void *bytes = data;
+        size_t size = count * 4;
+        if (type == GL_UNSIGNED_SHORT)
+        {
+            // padded to whole words so compute shaders can read the buffer as uint[]
+            narrow.assign(data, data + count);
+            narrow.resize((count + 1) & ~size_t(1));
+            bytes = narrow.data();
+            size = narrow.size() * 2;
+        }
 
-        Mesh mesh;
-        mesh.SetVerticies(verticies);
-        mesh.SetIndicies(indicies);
-        return mesh;
+        // the LOD chain was built from the old indices and sits after them
+        if (indexCount != count || indexType != type || !lods.empty())
+        {
+            DropLods();
+            glNamedBufferData(ebo, size, bytes, GL_STATIC_DRAW);
+            indexCapacity = count;
+        }
+        else
+            glNamedBufferSubData(ebo, 0, size, bytes);
+        indexCount = count;
+        indexType = type;
     }
-    void GL_Mesh::Init()
+
+    // a new buffer of `bytes` with the first `keepBytes` copied over on the GPU; the old one is deleted
+    static GLuint ResizeBuffer(GLuint buffer, size_t keepBytes, size_t bytes)
     {
-        glCreateVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-        glCreateBuffers(1, &vbo);
-        glCreateBuffers(1, &ebo);
+        GLuint grown;
+        glCreateBuffers(1, &grown);
+        glNamedBufferData(grown, bytes, nullptr, GL_STATIC_DRAW);
+        if (keepBytes > 0)
+            glCopyNamedBufferSubData(buffer, grown, 0, 0, keepBytes);
+        glDeleteBuffers(1, &buffer);
+        return grown;
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        if (!verticies.empty())
-            glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * verticies.size(), verticies.data(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        if (!indicies.empty())
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indicies.size(), indicies.data(), GL_STATIC_DRAW);
+    void GL_Mesh::ReserveGpu(size_t vertices, size_t indices)
+    {
+        if (format.persistent)
+            return;
+        if (cpuCopy)
+        {
+            // from here on the buffers are written directly
+            verticies = {};
+            indicies = {};
+            cpuCopy = false;
+        }
+        if (indexType != GL_UNSIGNED_INT)
+        {
+            // progressive meshes start empty; 16 bit indices cannot be known to fit in advance
+            indexType = GL_UNSIGNED_INT;
+            indexCount = indexCapacity = 0;
+        }
+        if (vertices > vertexCapacity)
+        {
+            const size_t stride = VertexStride(format.layout);
+            vbo = ResizeBuffer(vbo, vertexCount * stride, vertices * stride);
+            vertexCapacity = vertices;
+            BindRegion(0);
+        }
+        if (indices > indexCapacity)
+        {
+            DropLods();
+            ebo = ResizeBuffer(ebo, indexCount * sizeof(GLuint), indices * sizeof(GLuint));
+            indexCapacity = indices;
+            glVertexArrayElementBuffer(vao, ebo);
+        }
+    }
 
-        glEnableVertexAttribArray(pos_binding);
-        glVertexAttribPointer(pos_binding, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+    void GL_Mesh::WriteGpuVertices(size_t first, const void *data, size_t count)
+    {
+        if (first + count > vertexCapacity)
+            ReserveGpu(std::max(first + count, vertexCapacity + vertexCapacity / 2), indexCapacity);
+        const size_t stride = VertexStride(format.layout);
+        glNamedBufferSubData(vbo, first * stride, count * stride, data);
+        vertexCount = std::max(vertexCount, first + count);
+    }
 
-        glEnableVertexAttribArray(normal_binding);
-        glVertexAttribPointer(normal_binding, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), (void *)sizeof(vec3));
+    void GL_Mesh::WriteGpuIndices(size_t first, const GLuint *data, size_t count)
+    {
+        if (first + count > indexCapacity || indexType != GL_UNSIGNED_INT)
+            ReserveGpu(vertexCapacity, std::max(first + count, indexCapacity + indexCapacity / 2));
+        DropLods();
+        glNamedBufferSubData(ebo, first * sizeof(GLuint), count * sizeof(GLuint), data);
+        indexCount = std::max(indexCount, first + count);
+    }
 
-        glEnableVertexAttribArray(texcoord_binding);
-        glVertexAttribPointer(texcoord_binding, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(sizeof(vec3) * 2));
+    void GL_Mesh::ShrinkGpuToFit()
+    {
+        if (format.persistent)
+            return;
+        const size_t stride = VertexStride(format.layout);
+        if (vertexCapacity > vertexCount)
+        {
+            vbo = ResizeBuffer(vbo, vertexCount * stride, vertexCount * stride);
+            vertexCapacity = vertexCount;
+            BindRegion(0);
+        }
+        // 16 bit index buffers are always sized exactly by UploadIndices
+        if (indexCapacity > indexCount && indexType == GL_UNSIGNED_INT)
+        {
+            DropLods();
+            ebo = ResizeBuffer(ebo, indexCount * sizeof(GLuint), indexCount * sizeof(GLuint));
+            indexCapacity = indexCount;
+            glVertexArrayElementBuffer(vao, ebo);
+        }
+    }
 
-        glEnableVertexAttribArray(color_binding);
-        glVertexAttribPointer(color_binding, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(sizeof(vec3) * 2 + sizeof(vec2)));
+    void GL_Mesh::AllocateRing(size_t capacity)
+    {
+        // immutable storage cannot grow; the old buffer is released once the GPU is done with it
+        for (int r = 0; r < RingSize; r++)
+            WaitRegion(r);
+        if (mapped)
+            glUnmapNamedBuffer(vbo);
+        glDeleteBuffers(1, &vbo);
+        glCreateBuffers(1, &vbo);
 
-        glBindVertexArray(0);
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const size_t bytes = capacity * RingSize * VertexStride(format.layout);
+        glNamedBufferStorage(vbo, bytes, nullptr, flags);
+        mapped = static_cast<char *>(glMapNamedBufferRange(vbo, 0, bytes, flags));
+        ringCapacity = capacity;
+        BindRegion(ringRegion);
     }
-    GL_Mesh::GL_Mesh()
+
+    void GL_Mesh::BindRegion(int region)
     {
-        Init();
+        ringRegion = region;
+        const size_t stride = VertexStride(format.layout);
+        glVertexArrayVertexBuffer(vao, 0, vbo, region * ringCapacity * stride, GLsizei(stride));
     }
 
-    GL_Mesh::GL_Mesh(const Mesh &mesh) : Mesh(mesh)
+    void GL_Mesh::WaitRegion(int region)
     {
-        Init();
+        GLsync &fence = fences[region];
+        if (!fence)
+            return;
+        GLenum result;
+        do
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        while (result == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        fence = nullptr;
     }
 
-    GL_Mesh &GL_Mesh::operator=(const Mesh &mesh)
+    void GL_Mesh::Draw() const
     {
-        SetVerticies(mesh.GetVerticies());
-        SetIndicies(mesh.GetIndicies());
-        return *this;
+        DrawLod(0);
     }
 
-    GL_Mesh::~GL_Mesh()
+    void GL_Mesh::DrawLod(size_t level) const
     {
-        glDeleteVertexArrays(1, &vao);
-        glDeleteBuffers(1, &vbo);
-        glDeleteBuffers(1, &ebo);
+        Profiler::Scope scope("GL_Mesh::Draw");
+        const MeshLod lod = GetLod(level);
+        const size_t indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        Use();
+        glDrawElements(GL_TRIANGLES, GLsizei(lod.indexCount), indexType, reinterpret_cast<const void *>(lod.firstIndex * indexSize));
+        UnUse();
+        if (format.persistent)
+        {
+            // the region stays untouched by the CPU until this draw retires
+            if (fences[ringRegion])
+                glDeleteSync(fences[ringRegion]);
+            fences[ringRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
     }
 
-    void GL_Mesh::SetVerticies(const decltype(verticies) &_v)
+    void GL_Mesh::DropLods()
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        lods.clear();
+        lodIndexCount = 0;
+    }
 
-        if (verticies.size() != _v.size())
-            glBufferData(GL_ARRAY_BUFFER, _v.size() * sizeof(Vertex), _v.data(), GL_STATIC_DRAW);
+    size_t GL_Mesh::GenerateLods(size_t maxLevels, float reduction, float maxError)
+    {
+        Profiler::Scope scope("GL_Mesh::GenerateLods", false);
+        std::vector<vec3> positions;
+        std::vector<GLuint> readIndices;
+        const std::vector<GLuint> *base = &indicies;
+        if (verticies.size() == vertexCount && indicies.size() == indexCount && dirtyEnd <= dirtyBegin && !indiciesDirty)
+            positions = GatherPositions(verticies);
         else
-            glBufferSubData(GL_ARRAY_BUFFER, 0, _v.size() * sizeof(Vertex), _v.data());
+        {
+            // no CPU copy (LoadOBJ, MeshLoader): a one-off synchronous readback
+            const size_t stride = VertexStride(format.layout);
+            const size_t offset = format.layout == VertexLayout::Packed ? offsetof(PackedVertex, Position) : offsetof(Vertex, Position);
+            std::vector<char> bytes(vertexCount * stride);
+            glGetNamedBufferSubData(vbo, format.persistent ? ringRegion * ringCapacity * stride : 0, bytes.size(), bytes.data());
+            positions.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+                memcpy(&positions[i], bytes.data() + i * stride + offset, sizeof(vec3));
+
+            readIndices.resize(indexCount);
+            if (indexType == GL_UNSIGNED_SHORT)
+            {
+                std::vector<uint16_t> narrow(indexCount);
+                glGetNamedBufferSubData(ebo, 0, indexCount * 2, narrow.data());
+                std::copy(narrow.begin(), narrow.end(), readIndices.begin());
+            }
+            else
+                glGetNamedBufferSubData(ebo, 0, indexCount * sizeof(GLuint), readIndices.data());
+            base = &readIndices;
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        verticies = _v;
+        DropLods();
+        const std::vector<MeshSimplifier::Lod> chain = MeshSimplifier::BuildLodChain(positions, *base, maxLevels, reduction, maxError);
+        if (chain.empty())
+            return 0;
+
+        vec3 lo = positions[0], hi = positions[0];
+        for (const vec3 &p : positions)
+        {
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        boundsCenter = (lo + hi) * 0.5f;
+        boundsRadius = glm::length(hi - lo) * 0.5f;
+        const float extent = MeshSimplifier::Extent(positions);
+
+        // the full range keeps its place (and its padding), the chain goes after it
+        const size_t indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        const size_t baseSlots = indexType == GL_UNSIGNED_SHORT ? (indexCount + 1) & ~size_t(1) : indexCount;
+        size_t total = baseSlots;
+        for (const MeshSimplifier::Lod &lod : chain)
+            total += lod.indices.size();
+        ebo = ResizeBuffer(ebo, baseSlots * indexSize, total * indexSize);
+        glVertexArrayElementBuffer(vao, ebo);
+        indexCapacity = indexCount;
+
+        size_t first = baseSlots;
+        std::vector<uint16_t> narrow;
+        for (const MeshSimplifier::Lod &lod : chain)
+        {
+            const void *bytes = lod.indices.data();
+            if (indexType == GL_UNSIGNED_SHORT)
+            {
+                narrow.assign(lod.indices.begin(), lod.indices.end());
+                bytes = narrow.data();
+            }
+            glNamedBufferSubData(ebo, first * indexSize, lod.indices.size() * indexSize, bytes);
+            lods.push_back({first, lod.indices.size(), lod.error * extent});
+            first += lod.indices.size();
+        }
+        lodIndexCount = total - baseSlots;
+        return lods.size();
     }
-    void GL_Mesh::SetIndicies(const decltype(indicies) &_i)
-    {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 
-        if (indicies.size() != _i.size())
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _i.size() * sizeof(GLuint), _i.data(), GL_STATIC_DRAW);
-        else
-            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, _i.size() * sizeof(GLuint), _i.data());
+    MeshLod GL_Mesh::GetLod(size_t level) const
+    {
+        if (level == 0 || lods.empty())
+            return {0, indexCount, 0};
+        return lods[std::min(level, lods.size()) - 1];
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        indicies = _i;
+    size_t GL_Mesh::SelectLod(float distance, float viewportHeight, float fovY, float maxPixelError) const
+    {
+        if (lods.empty() || distance <= 0)
+            return 0;
+        const float pixelsPerUnit = viewportHeight / (2 * std::tan(fovY * 0.5f) * distance);
+        for (size_t level = lods.size(); level > 0; level--)
+            if (lods[level - 1].error * pixelsPerUnit <= maxPixelError)
+                return level;
+        return 0;
     }
 
-    void GL_Mesh::Draw() const
+    size_t GL_Mesh::SelectLod(const mat4 &modelView, float viewportHeight, float fovY, float maxPixelError) const
     {
-        Use();
-        glDrawElements(GL_TRIANGLES, indicies.size(), GL_UNSIGNED_INT, 0);
-        UnUse();
+        const float scale = std::max(glm::length(vec3(modelView[0])), std::max(glm::length(vec3(modelView[1])), glm::length(vec3(modelView[2]))));
+        if (lods.empty() || scale <= 0)
+            return 0;
+        // nearest point of the bounding sphere; from inside it every error is up close
+        const float distance = glm::length(vec3(modelView * vec4(boundsCenter, 1))) - boundsRadius * scale;
+        return SelectLod(distance, viewportHeight, fovY, maxPixelError / scale);
     }
-}
\ No newline at end of file
+}
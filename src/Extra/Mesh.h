@@ -2,6 +2,7 @@
 #include <vector>
 #include "../lib_include.h"
 #include <string>
+#include <cstdint>
 namespace ImguiBase
 {
     struct Vertex
@@ -11,44 +12,186 @@ namespace ImguiBase
         vec2 TexCoord;
         vec4 Color;
     };
+    /// @brief Vertex as uploaded by VertexLayout::Packed, 24 bytes instead of 48.
+    struct PackedVertex
+    {
+        vec3 Position;
+        uint32_t Normal;   // snorm 10:10:10:2
+        uint32_t TexCoord; // half x2
+        uint32_t Color;    // unorm 8x4
+    };
+
+    enum class VertexLayout
+    {
+        Float,
+        Packed
+    };
+
+    struct MeshFormat
+    {
+        VertexLayout layout = VertexLayout::Float;
+        bool shortIndices = false; // GL_UNSIGNED_SHORT while the vertex count allows it
+        bool persistent = false;   // vertices in a persistently mapped, fenced ring; for meshes edited every frame
+    };
+
     class Mesh
     {
     protected:
         std::vector<Vertex> verticies;
         std::vector<GLuint> indicies;
 
+        // [dirtyBegin, dirtyEnd) of verticies changed since the last flush
+        size_t dirtyBegin = SIZE_MAX, dirtyEnd = 0;
+        bool indiciesDirty = false;
+        int batchDepth = 0;
+
+        /// @brief Runs once per outermost batch with pending changes; GL_Mesh uploads them.
+        virtual void FlushChanges() { ClearDirty(); }
+        void ClearDirty();
+
     public:
         Mesh() {}
+        /// @brief Copies and moves take the geometry only; the batch depth and dirty range
+        /// belong to the object they were recorded on. Assigning marks everything dirty.
+        Mesh(const Mesh &other) : verticies(other.verticies), indicies(other.indicies) {}
+        Mesh(Mesh &&other) noexcept;
+        Mesh &operator=(const Mesh &other);
+        Mesh &operator=(Mesh &&other);
         const decltype(verticies) &GetVerticies() const { return verticies; }
-        virtual void SetVerticies(const decltype(verticies) &_v) { verticies = _v; }
+        void SetVerticies(const decltype(verticies) &_v);
+        void SetVerticies(decltype(verticies) &&_v);
         const decltype(indicies) &GetIndicies() const { return indicies; }
-        virtual void SetIndicies(const decltype(indicies) &_i) { indicies = _i; }
+        void SetIndicies(const decltype(indicies) &_i);
+        void SetIndicies(decltype(indicies) &&_i);
+
+        /// @brief Overwrites `count` vertices from `first`; only that range is reuploaded.
+        void UpdateVerticies(size_t first, const Vertex *data, size_t count);
+        void MarkVerticiesDirty(size_t first, size_t count);
+        void MarkIndiciesDirty();
+
+        /// @brief Edits between Begin and End are flushed together, one upload per buffer.
+        void BeginBatch() { batchDepth++; }
+        void EndBatch();
+        struct Batch
+        {
+            Mesh &mesh;
+            Batch(Mesh &_mesh) : mesh(_mesh) { mesh.BeginBatch(); }
+            ~Batch() { mesh.EndBatch(); }
+        };
 
         void Centerize();
         void FitToBounds(const float size);
         void CalculateNormals();
+        /// @brief Reorders triangles for the vertex cache (and overdraw), then vertices for fetch locality.
+        void Optimize(bool reduceOverdraw = true);
 
+        /// @brief Parses the OBJ, or reads Cache/Meshes/ when the file is unchanged since the last parse.
         static Mesh FromOBJ(const std::string &filepath,bool& colorsFound);
     };
 
+    /// @brief A range of a GL_Mesh's index buffer drawing the mesh at lower detail.
+    struct MeshLod
+    {
+        size_t firstIndex = 0, indexCount = 0;
+        float error = 0; // how far the surface may be from the full mesh, in model units
+    };
+
     class GL_Mesh : public Mesh
     {
+        static constexpr int RingSize = 3;
+
         GLuint vao = -1, vbo = -1, ebo = -1;
+        size_t vertexCount = 0, indexCount = 0; // what the buffers hold, the CPU copy may be dropped
+        size_t vertexCapacity = 0, indexCapacity = 0; // room in the buffers, set by ReserveGpu
+        GLenum indexType = GL_UNSIGNED_INT;
+        // false while the buffers hold data the vectors do not mirror (LoadOBJ without
+        // keepCpuCopy, progressive uploads); edits are then dropped instead of uploaded
+        bool cpuCopy = true;
+        bool warnedNoCpuCopy = false;
         const GLuint pos_binding = 0, normal_binding = 1, texcoord_binding = 2, color_binding = 3;
+        const MeshFormat format;
+
+        // after the full index range in the same buffer; level i + 1 is lods[i]
+        std::vector<MeshLod> lods;
+        size_t lodIndexCount = 0;
+        vec3 boundsCenter = vec3(0);
+        float boundsRadius = 0;
+
+        // persistent mode: RingSize regions of ringCapacity vertices, Draw reads ringRegion
+        char *mapped = nullptr;
+        size_t ringCapacity = 0;
+        int ringRegion = 0;
+        size_t pendingBegin[RingSize], pendingEnd[RingSize]; // ranges a region has not seen yet
+        mutable GLsync fences[RingSize] = {};
 
         void Init();
+        void FlushChanges() override;
+        void WriteVertices(void *dst, const Vertex *src, size_t count) const;
+        void ReplaceVertices(const Vertex *data, size_t count);
+        void UpdateVertexRange(size_t begin, size_t end);
+        void UploadIndices(const GLuint *data, size_t count);
+        void WidenIndicesIfNeeded();
+        void AllocateRing(size_t capacity);
+        void BindRegion(int region);
+        void WaitRegion(int region);
+        void DropLods();
 
     public:
-        GL_Mesh();
-        GL_Mesh(const Mesh &mesh);
+        explicit GL_Mesh(MeshFormat _format = {});
+        GL_Mesh(const Mesh &mesh, MeshFormat _format = {});
+        GL_Mesh(Mesh &&mesh, MeshFormat _format = {});
         GL_Mesh &operator=(const Mesh &mesh);
+        GL_Mesh &operator=(Mesh &&mesh);
         ~GL_Mesh();
         void Use() const { glBindVertexArray(vao); }
         void UnUse() const { glBindVertexArray(0); }
-        void SetVerticies(const decltype(verticies) &_v) override;
-        void SetIndicies(const decltype(indicies) &_i) override;
+
+        /// @brief Loads through the binary mesh cache, uploading straight from the mapped file.
+        /// Without keepCpuCopy GetVerticies/GetIndicies stay empty and CPU-side edits are dropped
+        /// with a warning rather than uploaded; assigning a whole Mesh brings the copy back.
+        void LoadOBJ(const std::string &filepath, bool &colorsFound, bool keepCpuCopy = false);
 
         void Draw() const;
+        /// @brief Draws level `level` of the LOD chain, 0 being the full mesh; clamped to the coarsest.
+        void DrawLod(size_t level) const;
+
+        /// @brief Simplifies the mesh into up to `maxLevels` LODs (MeshSimplifier::BuildLodChain) and
+        /// appends their indices to the index buffer, so they share the vertices and the VAO.
+        /// Without a CPU copy the positions and indices are read back from the buffers.
+        /// Replacing the indices drops the chain. Returns the number of levels built.
+        size_t GenerateLods(size_t maxLevels = 4, float reduction = 0.5f, float maxError = 0.05f);
+        /// @brief The coarsest level whose error, projected at the mesh's bounding sphere, stays
+        /// under `maxPixelError` pixels. `modelView` may scale; `fovY` is in radians.
+        size_t SelectLod(const mat4 &modelView, float viewportHeight, float fovY, float maxPixelError = 1.0f) const;
+        /// @brief Same as SelectLod, for a mesh `distance` units from the eye.
+        size_t SelectLod(float distance, float viewportHeight, float fovY, float maxPixelError = 1.0f) const;
+        size_t GetLodCount() const { return lods.size() + 1; }
+        /// @brief Level 0 is the full index range with no error.
+        MeshLod GetLod(size_t level) const;
+
+        // progressive upload (MeshLoader); not for persistent meshes. Indices stay 32 bit and the
+        // CPU copy is dropped, as with LoadOBJ without keepCpuCopy.
+        /// @brief Grows the buffers to hold at least this many vertices and indices, keeping their contents on the GPU.
+        void ReserveGpu(size_t vertices, size_t indices);
+        /// @brief Writes vertices already in this mesh's layout at `first`, growing the drawn range to cover them.
+        void WriteGpuVertices(size_t first, const void *data, size_t count);
+        void WriteGpuIndices(size_t first, const GLuint *data, size_t count);
+        /// @brief Drops reserved room that was never written.
+        void ShrinkGpuToFit();
+        /// @brief Converts to `layout`, as uploads do; safe off the GL thread.
+        static void ConvertVertices(VertexLayout layout, void *dst, const Vertex *src, size_t count);
+
+        static size_t VertexStride(VertexLayout layout);
+        /// @brief Bytes held by the vertex and index buffers.
+        size_t GpuBytes() const;
+
+        // buffer access for GPU-side processing (GeometryCompute)
+        GLuint GetVertexBuffer() const { return vbo; }
+        GLuint GetIndexBuffer() const { return ebo; }
+        size_t GetVertexCount() const { return vertexCount; }
+        size_t GetIndexCount() const { return indexCount; }
+        GLenum GetIndexType() const { return indexType; }
+        const MeshFormat &GetFormat() const { return format; }
     };
 
 };
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "MeshBatch.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+
+namespace ImguiBase
+{
+    // matches the layout glMultiDrawElementsIndirect reads
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    static constexpr GLuint VertexBufferBinding = 0, InstanceIndexBinding = 1;
+    static constexpr GLuint InstanceAttribute = 4;
+
+    size_t MeshBatch::Arena::Allocate(size_t count)
+    {
+        if (count == 0)
+            return 0;
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+        {
+            if (it->second < count)
+                continue;
+            const size_t offset = it->first;
+            const size_t rest = it->second - count;
+            freeBlocks.erase(it);
+            if (rest)
+                freeBlocks[offset + count] = rest;
+            used += count;
+            return offset;
+        }
+        return SIZE_MAX;
+    }
+
+    void MeshBatch::Arena::Release(size_t offset, size_t count)
+    {
+        used -= count;
+        Free(offset, count);
+    }
+
+    void MeshBatch::Arena::Free(size_t offset, size_t count)
+    {
+        if (count == 0)
+            return;
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.end() && offset + count == next->first)
+        {
+            count += next->second;
+            next = freeBlocks.erase(next);
+        }
+        if (next != freeBlocks.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += count;
+                return;
+            }
+        }
+        freeBlocks[offset] = count;
+    }
+
+    void MeshBatch::Arena::Grow(size_t minCapacity)
+    {
+        const size_t newCapacity = std::max({minCapacity, capacity * 2, size_t(4096)});
+        GLuint newBuffer;
+        glCreateBuffers(1, &newBuffer);
+        glNamedBufferStorage(newBuffer, newCapacity * elementSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        if (buffer)
+        {
+            glCopyNamedBufferSubData(buffer, newBuffer, 0, 0, capacity * elementSize);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = newBuffer;
+
+        // the new tail joins a free block that ran up to the old end
+        Free(capacity, newCapacity - capacity);
+        capacity = newCapacity;
+    }
+
+    MeshBatch::MeshBatch(GLuint _instanceBinding) : instanceBinding(_instanceBinding)
+    {
+        vertices.elementSize = sizeof(Vertex);
+        indices.elementSize = sizeof(GLuint);
+        glCreateVertexArrays(1, &vao);
+
+        auto attribute = [&](GLuint index, GLint size, size_t offset)
+        {
+            glEnableVertexArrayAttrib(vao, index);
+            glVertexArrayAttribFormat(vao, index, size, GL_FLOAT, GL_FALSE, GLuint(offset));
+            glVertexArrayAttribBinding(vao, index, VertexBufferBinding);
+        };
+        attribute(0, 3, offsetof(Vertex, Position));
+        attribute(1, 3, offsetof(Vertex, Normal));
+        attribute(2, 2, offsetof(Vertex, TexCoord));
+        attribute(3, 4, offsetof(Vertex, Color));
+
+        // an identity array read once per instance: baseInstance offsets instanced attributes,
+        // which gives the shader its index into the instance buffer without GL 4.6 gl_BaseInstance
+        glEnableVertexArrayAttrib(vao, InstanceAttribute);
+        glVertexArrayAttribIFormat(vao, InstanceAttribute, 1, GL_UNSIGNED_INT, 0);
+        glVertexArrayAttribBinding(vao, InstanceAttribute, InstanceIndexBinding);
+        glVertexArrayBindingDivisor(vao, InstanceIndexBinding, 1);
+
+        vertices.Grow(0);
+        indices.Grow(0);
+        BindArenas();
+    }
+
+    MeshBatch::~MeshBatch()
+    {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vertices.buffer);
+        glDeleteBuffers(1, &indices.buffer);
+        if (instanceBuffer)
+            glDeleteBuffers(1, &instanceBuffer);
+        if (instanceIndexBuffer)
+            glDeleteBuffers(1, &instanceIndexBuffer);
+        if (commandBuffer)
+            glDeleteBuffers(1, &commandBuffer);
+    }
+
+    void MeshBatch::BindArenas()
+    {
+        glVertexArrayVertexBuffer(vao, VertexBufferBinding, vertices.buffer, 0, sizeof(Vertex));
+        glVertexArrayElementBuffer(vao, indices.buffer);
+    }
+
+    MeshBatch::MeshId MeshBatch::AddMesh(const Mesh &mesh)
+    {
+        const auto &meshVertices = mesh.GetVerticies();
+        const auto &meshIndices = mesh.GetIndicies();
+
+        MeshEntry entry;
+        entry.vertexCount = meshVertices.size();
+        entry.indexCount = meshIndices.size();
+        entry.live = true;
+        entry.firstVertex = vertices.Allocate(entry.vertexCount);
+        entry.firstIndex = indices.Allocate(entry.indexCount);
+        bool grew = false;
+        if (entry.firstVertex == SIZE_MAX)
+        {
+            vertices.Grow(vertices.capacity + entry.vertexCount);
+            entry.firstVertex = vertices.Allocate(entry.vertexCount);
+            grew = true;
+        }
+        if (entry.firstIndex == SIZE_MAX)
+        {
+            indices.Grow(indices.capacity + entry.indexCount);
+            entry.firstIndex = indices.Allocate(entry.indexCount);
+            grew = true;
+        }
+        if (grew)
+            BindArenas();
+
+        // indices stay mesh-local; the command's baseVertex offsets them
+        if (entry.vertexCount)
+            glNamedBufferSubData(vertices.buffer, entry.firstVertex * sizeof(Vertex), entry.vertexCount * sizeof(Vertex), meshVertices.data());
+        if (entry.indexCount)
+            glNamedBufferSubData(indices.buffer, entry.firstIndex * sizeof(GLuint), entry.indexCount * sizeof(GLuint), meshIndices.data());
+
+        MeshId id;
+        if (!freeMeshIds.empty())
+        {
+            id = freeMeshIds.back();
+            freeMeshIds.pop_back();
+            meshes[id] = entry;
+        }
+        else
+        {
+            id = MeshId(meshes.size());
+            meshes.push_back(entry);
+        }
+        stats.meshes++;
+        return id;
+    }
+
+    void MeshBatch::RemoveMesh(MeshId id)
+    {
+        if (id >= meshes.size() || !meshes[id].live)
+        {
+            fprintf(stderr, "[WARN] MeshBatch: no mesh %u\n", id);
+            return;
+        }
+        for (size_t i = instances.size(); i-- > 0;)
+            if (instances[i].mesh == id)
+                RemoveInstance(idOf[i]);
+
+        MeshEntry &entry = meshes[id];
+        vertices.Release(entry.firstVertex, entry.vertexCount);
+        indices.Release(entry.firstIndex, entry.indexCount);
+        entry = {};
+        freeMeshIds.push_back(id);
+        stats.meshes--;
+        commandsDirty = true;
+    }
+
+    MeshBatch::InstanceId MeshBatch::AddInstance(MeshId mesh, const Instance &instance)
+    {
+        if (mesh >= meshes.size() || !meshes[mesh].live)
+        {
+            fprintf(stderr, "[WARN] MeshBatch: no mesh %u\n", mesh);
+            return Invalid;
+        }
+        InstanceId id;
+        if (!freeInstanceIds.empty())
+        {
+            id = freeInstanceIds.back();
+            freeInstanceIds.pop_back();
+        }
+        else
+        {
+            id = InstanceId(slotOf.size());
+            slotOf.push_back(Invalid);
+        }
+        slotOf[id] = uint32_t(instances.size());
+        idOf.push_back(id);
+        instances.push_back({mesh, instance});
+        meshes[mesh].instanceCount++;
+        commandsDirty = true;
+        return id;
+    }
+
+    void MeshBatch::SetInstance(InstanceId id, const Instance &instance)
+    {
+        if (id >= slotOf.size() || slotOf[id] == Invalid)
+            return;
+        instances[slotOf[id]].data = instance;
+        instancesDirty = true;
+    }
+
+    void MeshBatch::RemoveInstance(InstanceId id)
+    {
+        if (id >= slotOf.size() || slotOf[id] == Invalid)
+            return;
+        const uint32_t slot = slotOf[id];
+        meshes[instances[slot].mesh].instanceCount--;
+        const uint32_t last = uint32_t(instances.size() - 1);
+        if (slot != last)
+        {
+            instances[slot] = instances[last];
+            idOf[slot] = idOf[last];
+            slotOf[idOf[slot]] = slot;
+        }
+        instances.pop_back();
+        idOf.pop_back();
+        slotOf[id] = Invalid;
+        freeInstanceIds.push_back(id);
+        commandsDirty = true;
+    }
+
+    void MeshBatch::Rebuild()
+    {
+        // instances grouped by mesh, so each mesh is one command over a contiguous range
+        std::vector<uint32_t> first(meshes.size() + 1, 0);
+        for (size_t m = 0; m < meshes.size(); m++)
+            first[m + 1] = first[m] + meshes[m].instanceCount;
+        std::vector<uint32_t> cursor(first.begin(), first.end() - 1);
+        std::vector<Instance> sorted(instances.size());
+        for (const InstanceEntry &instance : instances)
+            sorted[cursor[instance.mesh]++] = instance.data;
+
+        std::vector<DrawElementsIndirectCommand> commands;
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            const MeshEntry &entry = meshes[m];
+            if (!entry.live || entry.instanceCount == 0 || entry.indexCount == 0)
+                continue;
+            commands.push_back({GLuint(entry.indexCount), entry.instanceCount, GLuint(entry.firstIndex),
+                                GLint(entry.firstVertex), first[m]});
+        }
+        commandCount = commands.size();
+
+        if (sorted.size() > instanceCapacity)
+        {
+            instanceCapacity = std::max(sorted.size(), instanceCapacity * 2);
+            if (!instanceBuffer)
+            {
+                glCreateBuffers(1, &instanceBuffer);
+                glCreateBuffers(1, &instanceIndexBuffer);
+            }
+            glNamedBufferData(instanceBuffer, instanceCapacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+            std::vector<GLuint> identity(instanceCapacity);
+            std::iota(identity.begin(), identity.end(), 0u);
+            glNamedBufferData(instanceIndexBuffer, identity.size() * sizeof(GLuint), identity.data(), GL_STATIC_DRAW);
+            glVertexArrayVertexBuffer(vao, InstanceIndexBinding, instanceIndexBuffer, 0, sizeof(GLuint));
+        }
+        if (!sorted.empty())
+            glNamedBufferSubData(instanceBuffer, 0, sorted.size() * sizeof(Instance), sorted.data());
+
+        if (commands.size() > commandCapacity)
+        {
+            commandCapacity = std::max(commands.size(), commandCapacity * 2);
+            if (!commandBuffer)
+                glCreateBuffers(1, &commandBuffer);
+            glNamedBufferData(commandBuffer, commandCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (!commands.empty())
+            glNamedBufferSubData(commandBuffer, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+
+        commandsDirty = false;
+        instancesDirty = false;
+    }
+
+    void MeshBatch::Draw()
+    {
+        Profiler::Scope scope("MeshBatch::Draw");
+        const auto start = std::chrono::steady_clock::now();
+        // commands depend only on which instances exist, but their data moves with the grouping,
+        // so any change re-uploads the grouped instances
+        if (commandsDirty || instancesDirty)
+            Rebuild();
+
+        stats.drawCalls = 0;
+        if (commandCount)
+        {
+            glBindVertexArray(vao);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, instanceBinding, instanceBuffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(commandCount), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            glBindVertexArray(0);
+            stats.drawCalls = 1;
+        }
+
+        stats.instances = instances.size();
+        stats.commands = commandCount;
+        stats.vertexArenaUsed = vertices.used;
+        stats.vertexArenaCapacity = vertices.capacity;
+        stats.indexArenaUsed = indices.used;
+        stats.indexArenaCapacity = indices.capacity;
+        stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
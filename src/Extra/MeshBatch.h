@@ -0,0 +1,109 @@
+#pragma once
+#include "Mesh.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace ImguiBase
+{
+    /// @brief Draws many meshes and instances with one glMultiDrawElementsIndirect.
+    /// Meshes are sub-allocated into shared vertex and index arenas behind a single VAO, and
+    /// per-instance data lives in an SSBO. Shader interface:
+    ///   locations 0-3   position, normal, texcoord, color, as for GL_Mesh
+    ///   location 4      in uint aInstance, index into the instance buffer
+    ///   binding N       layout(std430) readonly buffer Instances { Instance instances[]; };
+    ///                   struct Instance { mat4 transform; vec4 color; };
+    class MeshBatch
+    {
+    public:
+        using MeshId = uint32_t;
+        using InstanceId = uint32_t;
+        static constexpr uint32_t Invalid = UINT32_MAX;
+
+        struct Instance
+        {
+            mat4 transform{1.0f};
+            vec4 color{1.0f};
+        };
+
+        struct Stats
+        {
+            size_t meshes = 0;
+            size_t instances = 0;
+            size_t commands = 0;  // indirect commands, one per mesh with instances
+            size_t drawCalls = 0; // GL draw calls in the last Draw
+            double submitMs = 0;  // CPU time of the last Draw, rebuilds included
+            size_t vertexArenaUsed = 0, vertexArenaCapacity = 0;
+            size_t indexArenaUsed = 0, indexArenaCapacity = 0;
+        };
+
+        /// @brief Needs a current GL context. Instances are bound to SSBO `instanceBinding` in Draw().
+        explicit MeshBatch(GLuint instanceBinding = 0);
+        ~MeshBatch();
+        MeshBatch(const MeshBatch &) = delete;
+        MeshBatch &operator=(const MeshBatch &) = delete;
+
+        /// @brief Copies the mesh into the arenas; the Mesh itself is not referenced afterwards.
+        MeshId AddMesh(const Mesh &mesh);
+        /// @brief Frees the mesh's arena ranges and removes its instances.
+        void RemoveMesh(MeshId mesh);
+
+        InstanceId AddInstance(MeshId mesh, const Instance &instance);
+        InstanceId AddInstance(MeshId mesh) { return AddInstance(mesh, Instance()); }
+        void SetInstance(InstanceId id, const Instance &instance);
+        void RemoveInstance(InstanceId id);
+
+        /// @brief Bind the program first. Uploads changed instances and commands, then issues one draw.
+        void Draw();
+        const Stats &GetStats() const { return stats; }
+
+    private:
+        // first-fit over [0, capacity), coalescing on release; units are vertices or indices
+        struct Arena
+        {
+            GLuint buffer = 0;
+            size_t capacity = 0;
+            size_t used = 0;
+            size_t elementSize = 0;
+            std::map<size_t, size_t> freeBlocks; // offset -> size
+
+            size_t Allocate(size_t count); // SIZE_MAX when full
+            void Release(size_t offset, size_t count);
+            void Free(size_t offset, size_t count); // back into freeBlocks without touching `used`
+            void Grow(size_t minCapacity);
+        };
+        struct MeshEntry
+        {
+            size_t firstVertex = 0, vertexCount = 0;
+            size_t firstIndex = 0, indexCount = 0;
+            uint32_t instanceCount = 0;
+            bool live = false;
+        };
+        struct InstanceEntry
+        {
+            MeshId mesh;
+            Instance data;
+        };
+
+        GLuint vao = 0;
+        GLuint instanceBinding;
+        Arena vertices, indices;
+        std::vector<MeshEntry> meshes;
+        std::vector<MeshId> freeMeshIds;
+
+        // dense instances, swap-removed; ids stay stable through slotOf/idOf
+        std::vector<InstanceEntry> instances;
+        std::vector<uint32_t> slotOf; // id -> dense index, Invalid when free
+        std::vector<InstanceId> idOf;  // dense index -> id
+        std::vector<InstanceId> freeInstanceIds;
+
+        GLuint instanceBuffer = 0, instanceIndexBuffer = 0, commandBuffer = 0;
+        size_t instanceCapacity = 0, commandCapacity = 0;
+        size_t commandCount = 0;
+        bool commandsDirty = true, instancesDirty = true;
+        Stats stats;
+
+        void BindArenas();
+        void Rebuild();
+    };
+}
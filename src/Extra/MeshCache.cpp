@@ -0,0 +1,267 @@
+#include "MeshCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace ImguiBase::MeshCache
+{
+    static const fs::path CacheDir = "Cache/Meshes";
+
+    static constexpr size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static bool StatSource(const std::string &path, uint64_t &size, int64_t &mtime)
+    {
+        std::error_code ec;
+        size = fs::file_size(path, ec);
+        if (ec)
+            return false;
+        auto time = fs::last_write_time(path, ec);
+        if (ec)
+            return false;
+        mtime = time.time_since_epoch().count();
+        return true;
+    }
+
+    static uint64_t HashFile(const std::string &path)
+    {
+        MappedFile file(path);
+        return HashBytes(file.data(), file.size());
+    }
+
+    fs::path PathFor(const std::string &objPath)
+    {
+        std::error_code ec;
+        fs::path absolute = fs::absolute(objPath, ec);
+        const std::string key = (ec ? fs::path(objPath) : absolute).lexically_normal().string();
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "-%016llx.mesh", (unsigned long long)HashBytes(key.data(), key.size()));
+        return CacheDir / (fs::path(objPath).stem().string() + suffix);
+    }
+
+    uint64_t HashBytes(const char *data, size_t size)
+    {
+        // FNV style, but eight bytes per step so hashing a large OBJ stays well under the parse cost
+        uint64_t h = 0xcbf29ce484222325ull ^ size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            h = (h ^ word) * 0x100000001b3ull;
+            h ^= h >> 29;
+        }
+        for (; i < size; i++)
+            h = (h ^ (unsigned char)data[i]) * 0x100000001b3ull;
+        return h;
+    }
+
+    std::optional<View> Open(const std::string &objPath)
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        const fs::path cachePath = PathFor(objPath);
+        std::error_code ec;
+        if (!StatSource(objPath, size, mtime) || !fs::exists(cachePath, ec))
+            return std::nullopt;
+
+        try
+        {
+            View view{MappedFile(cachePath.string()), nullptr, nullptr, nullptr};
+            const char *bytes = view.file.data();
+            const size_t length = view.file.size();
+            if (length < sizeof(Header))
+                return std::nullopt;
+
+            const Header *header = reinterpret_cast<const Header *>(bytes);
+            if (memcmp(header->magic, Magic, 4) != 0 || header->version != Version || header->vertexStride != sizeof(Vertex))
+                return std::nullopt;
+            if (header->vertexOffset + header->vertexCount * sizeof(Vertex) > length ||
+                header->indexOffset + header->indexCount * sizeof(GLuint) > length)
+                return std::nullopt;
+            if (header->sourceSize != size)
+                return std::nullopt;
+
+            if (header->sourceMtime != mtime)
+            {
+                // touched but maybe not changed (checkout, copy); trust the content hash
+                if (HashFile(objPath) != header->sourceHash)
+                    return std::nullopt;
+                std::fstream patch(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+                patch.seekp(offsetof(Header, sourceMtime));
+                patch.write(reinterpret_cast<const char *>(&mtime), sizeof(mtime));
+            }
+
+            view.header = header;
+            view.vertices = reinterpret_cast<const Vertex *>(bytes + header->vertexOffset);
+            view.indices = reinterpret_cast<const GLuint *>(bytes + header->indexOffset);
+            return view;
+        }
+        catch (const std::exception &e)
+        {
+            fprintf(stderr, "[WARN] Could not read mesh cache %s: %s\n", cachePath.string().c_str(), e.what());
+            return std::nullopt;
+        }
+    }
+
+    static Header MakeHeader(bool colorsFound, size_t vertexCount, size_t indexCount, vec3 lo, vec3 hi)
+    {
+        Header header{};
+        memcpy(header.magic, Magic, 4);
+        header.version = Version;
+        header.vertexStride = sizeof(Vertex);
+        header.flags = colorsFound ? FlagColorsFound : 0;
+        header.vertexCount = vertexCount;
+        header.indexCount = indexCount;
+        header.vertexOffset = AlignUp(sizeof(Header), 16);
+        header.indexOffset = AlignUp(header.vertexOffset + vertexCount * sizeof(Vertex), 16);
+        if (vertexCount == 0)
+            lo = hi = vec3(0);
+        for (int i = 0; i < 3; i++)
+        {
+            header.boundsMin[i] = lo[i];
+            header.boundsMax[i] = hi[i];
+        }
+        return header;
+    }
+
+    bool Write(const std::string &objPath, const Mesh &mesh, bool colorsFound)
+    {
+        const auto &vertices = mesh.GetVerticies();
+        const auto &indices = mesh.GetIndicies();
+
+        vec3 lo(INFINITY), hi(-INFINITY);
+        for (const Vertex &v : vertices)
+        {
+            lo = min(lo, v.Position);
+            hi = max(hi, v.Position);
+        }
+        Header header = MakeHeader(colorsFound, vertices.size(), indices.size(), lo, hi);
+
+        const fs::path path = PathFor(objPath);
+        const fs::path temp = path.string() + ".tmp";
+        try
+        {
+            if (!StatSource(objPath, header.sourceSize, header.sourceMtime))
+                return false;
+            header.sourceHash = HashFile(objPath);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            static const char zeros[16] = {};
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(zeros, header.vertexOffset - sizeof(header));
+            out.write(reinterpret_cast<const char *>(vertices.data()), vertices.size() * sizeof(Vertex));
+            out.write(zeros, header.indexOffset - (header.vertexOffset + vertices.size() * sizeof(Vertex)));
+            out.write(reinterpret_cast<const char *>(indices.data()), indices.size() * sizeof(GLuint));
+            out.close();
+            if (!out)
+                throw std::runtime_error("write failed");
+
+            fs::rename(temp, path);
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            std::error_code ec;
+            fs::remove(temp, ec);
+            fprintf(stderr, "[WARN] Could not write mesh cache %s: %s\n", path.string().c_str(), e.what());
+            return false;
+        }
+    }
+
+    Writer::Writer(const std::string &_objPath) : objPath(_objPath), path(PathFor(_objPath))
+    {
+        temp = path.string() + ".tmp";
+        indexTemp = path.string() + ".idx.tmp";
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        out.open(temp, std::ios::binary | std::ios::trunc);
+        indexOut.open(indexTemp, std::ios::binary | std::ios::trunc);
+        // the real header once the counts are known
+        static const char zeros[AlignUp(sizeof(Header), 16)] = {};
+        out.write(zeros, sizeof(zeros));
+    }
+
+    Writer::~Writer()
+    {
+        if (!finished)
+            Discard();
+    }
+
+    void Writer::AddVertices(const Vertex *vertices, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            lo = min(lo, vertices[i].Position);
+            hi = max(hi, vertices[i].Position);
+        }
+        out.write(reinterpret_cast<const char *>(vertices), count * sizeof(Vertex));
+        header.vertexCount += count;
+    }
+
+    void Writer::AddIndices(const GLuint *indices, size_t count)
+    {
+        indexOut.write(reinterpret_cast<const char *>(indices), count * sizeof(GLuint));
+        header.indexCount += count;
+    }
+
+    bool Writer::Finish(bool colorsFound)
+    {
+        try
+        {
+            header = MakeHeader(colorsFound, header.vertexCount, header.indexCount, lo, hi);
+            if (!StatSource(objPath, header.sourceSize, header.sourceMtime))
+            {
+                Discard();
+                return false;
+            }
+            header.sourceHash = HashFile(objPath);
+
+            static const char zeros[16] = {};
+            out.write(zeros, header.indexOffset - (header.vertexOffset + header.vertexCount * sizeof(Vertex)));
+            indexOut.close();
+            if (!indexOut)
+                throw std::runtime_error("write failed");
+            if (header.indexCount)
+            {
+                std::ifstream indices(indexTemp, std::ios::binary);
+                out << indices.rdbuf();
+            }
+            out.seekp(0);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.close();
+            if (!out)
+                throw std::runtime_error("write failed");
+
+            std::error_code ec;
+            fs::remove(indexTemp, ec);
+            fs::rename(temp, path);
+            finished = true;
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            Discard();
+            fprintf(stderr, "[WARN] Could not write mesh cache %s: %s\n", path.string().c_str(), e.what());
+            return false;
+        }
+    }
+
+    void Writer::Discard()
+    {
+        out.close();
+        indexOut.close();
+        std::error_code ec;
+        fs::remove(temp, ec);
+        fs::remove(indexTemp, ec);
+        finished = true;
+    }
+}
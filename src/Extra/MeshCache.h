@@ -0,0 +1,79 @@
+#pragma once
+#include "Mesh.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+namespace ImguiBase::MeshCache
+{
+    // Cache/Meshes/<name>-<path hash>.mesh, little endian:
+    //   Header | Vertex[vertexCount] at vertexOffset | GLuint[indexCount] at indexOffset
+    // Both arrays are 16 byte aligned and laid out exactly as GL_Mesh uploads them.
+    constexpr char Magic[4] = {'I', 'M', 'S', 'H'};
+    constexpr uint32_t Version = 1;
+    constexpr uint32_t FlagColorsFound = 1;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexStride; // sizeof(Vertex) when written, guards against layout changes
+        uint32_t flags;
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t sourceHash;
+    };
+
+    /// @brief A validated cache file, mapped read-only. The pointers live as long as the view.
+    struct View
+    {
+        MappedFile file;
+        const Header *header;
+        const Vertex *vertices;
+        const GLuint *indices;
+    };
+
+    std::filesystem::path PathFor(const std::string &objPath);
+    uint64_t HashBytes(const char *data, size_t size);
+
+    /// @brief Maps the cache for `objPath` if it exists and still matches the source.
+    /// Size and mtime are compared first; the source is only rehashed when they differ.
+    std::optional<View> Open(const std::string &objPath);
+    /// @brief Writes the cache for `objPath` next to the others. Failures are logged, never thrown.
+    bool Write(const std::string &objPath, const Mesh &mesh, bool colorsFound);
+
+    /// @brief Writes the cache a piece at a time, for loaders that never hold the whole mesh.
+    /// Vertices go straight to the file; indices to a side file appended by Finish, since their
+    /// offset depends on the final vertex count. Unfinished files are removed on destruction.
+    class Writer
+    {
+    public:
+        explicit Writer(const std::string &objPath);
+        ~Writer();
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        void AddVertices(const Vertex *vertices, size_t count);
+        void AddIndices(const GLuint *indices, size_t count);
+        /// @brief Completes the file and moves it into place. Failures are logged, never thrown.
+        bool Finish(bool colorsFound);
+
+    private:
+        std::string objPath;
+        std::filesystem::path path, temp, indexTemp;
+        std::ofstream out, indexOut;
+        Header header{};
+        vec3 lo{INFINITY}, hi{-INFINITY};
+        bool finished = false;
+
+        void Discard();
+    };
+}
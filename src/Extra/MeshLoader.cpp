@@ -0,0 +1,437 @@
+#include "MeshLoader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "Profiler.h"
+#include "VertexDedupeMap.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace ImguiBase
+{
+    MeshLoader::Progress MeshLoader::Request::GetProgress() const
+    {
+        Progress progress;
+        progress.state = state;
+        const uint64_t total = fileBytes, parsed = parsedBytes, produced = producedBytes;
+        progress.parsed = total ? float(double(parsed) / double(total)) : 0.0f;
+        // until the worker is done the final size is only extrapolated from what it read so far
+        const double uploadedOfProduced = produced ? double(uploadedBytes) / double(produced) : 0.0;
+        progress.uploaded = float(parsingDone ? uploadedOfProduced : uploadedOfProduced * progress.parsed);
+        if (state == State::Done)
+            progress.parsed = progress.uploaded = 1.0f;
+        progress.vertices = uploadedVertices;
+        progress.indices = uploadedIndices;
+        if (state == State::Failed)
+            progress.error = error;
+        return progress;
+    }
+
+    MeshLoader::MeshLoader(unsigned workers, size_t _chunkBytes, size_t _maxQueuedBytes)
+        : chunkBytes(std::max<size_t>(_chunkBytes, 4096)), maxQueuedBytes(_maxQueuedBytes)
+    {
+        for (unsigned i = 0; i < std::max(1u, workers); i++)
+            threads.emplace_back(&MeshLoader::WorkerLoop, this);
+    }
+
+    MeshLoader::~MeshLoader()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        spaceFreed.notify_all();
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    std::shared_ptr<MeshLoader::Request> MeshLoader::Load(const std::string &path, MeshFormat format, Callback done)
+    {
+        if (format.persistent)
+        {
+            fprintf(stderr, "[WARN] MeshLoader: %s is loaded as a static mesh, persistent meshes are not streamed\n", path.c_str());
+            format.persistent = false;
+        }
+        auto request = std::make_shared<Request>();
+        request->path = path;
+        request->mesh = std::make_shared<GL_Mesh>(format);
+        request->done = std::move(done);
+        {
+            std::lock_guard lock(mutex);
+            requests.push_back(request);
+            active++;
+        }
+        wake.notify_one();
+        return request;
+    }
+
+    void MeshLoader::Cancel(const std::shared_ptr<Request> &request)
+    {
+        request->cancelled = true;
+        {
+            std::lock_guard lock(mutex); // a worker between its check and its wait must see the flag
+        }
+        spaceFreed.notify_all();
+    }
+
+    void MeshLoader::WorkerLoop()
+    {
+        while (true)
+        {
+            std::shared_ptr<Request> request;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || !requests.empty(); });
+                if (stopping)
+                    return;
+                request = std::move(requests.front());
+                requests.pop_front();
+            }
+
+            if (!request->cancelled)
+            {
+                request->state = State::Loading;
+                try
+                {
+                    if (auto cached = MeshCache::Open(request->path))
+                        LoadCached(request, *cached);
+                    else
+                        LoadParsed(request);
+                }
+                catch (const std::exception &e)
+                {
+                    request->error = e.what();
+                    fprintf(stderr, "[ERROR] MeshLoader: %s: %s\n", request->path.c_str(), e.what());
+                }
+            }
+            request->parsingDone = true;
+
+            // always queued, so the render thread finishes requests in order, cancelled ones included.
+            // It takes the worker's reference: the request may own the last reference to its mesh,
+            // which must be deleted on the render thread
+            Chunk last;
+            last.request = std::move(request);
+            last.last = true;
+            Push(std::move(last));
+        }
+    }
+
+    bool MeshLoader::Push(Chunk &&chunk)
+    {
+        std::unique_lock lock(mutex);
+        // the final chunk is queued even while stopping, so the loader's owner releases it
+        if (stopping && !chunk.last)
+            return false;
+        const size_t bytes = chunk.Bytes();
+        if (!chunk.last)
+        {
+            auto fits = [&] { return queuedBytes == 0 || queuedBytes + bytes <= maxQueuedBytes; };
+            if (!fits())
+                workerWaits++;
+            spaceFreed.wait(lock, [&] { return stopping || chunk.request->cancelled || fits(); });
+            if (stopping || chunk.request->cancelled)
+                return false;
+        }
+        chunk.request->producedBytes += bytes;
+        queuedBytes += bytes;
+        chunks.push_back(std::move(chunk));
+        return true;
+    }
+
+    void MeshLoader::LoadCached(const std::shared_ptr<Request> &request, const MeshCache::View &cached)
+    {
+        request->colorsFound = cached.header->flags & MeshCache::FlagColorsFound;
+        const size_t vertexCount = cached.header->vertexCount, indexCount = cached.header->indexCount;
+        const VertexLayout layout = request->mesh->GetFormat().layout;
+        const size_t stride = GL_Mesh::VertexStride(layout);
+        const size_t total = vertexCount * sizeof(Vertex) + indexCount * sizeof(GLuint);
+        request->fileBytes = total;
+
+        // optimized meshes index vertices anywhere in the buffer, so all vertices go first;
+        // nothing draws until the indices start arriving
+        const size_t verticesPerChunk = std::max<size_t>(1, chunkBytes / sizeof(Vertex));
+        const size_t indicesPerChunk = std::max<size_t>(1, chunkBytes / sizeof(GLuint));
+        bool first = true;
+        uint64_t done = 0;
+        for (size_t v = 0; v < vertexCount; v += verticesPerChunk)
+        {
+            Chunk chunk;
+            chunk.request = request;
+            chunk.firstVertex = v;
+            chunk.vertexCount = std::min(verticesPerChunk, vertexCount - v);
+            chunk.vertexBytes.resize(chunk.vertexCount * stride);
+            GL_Mesh::ConvertVertices(layout, chunk.vertexBytes.data(), cached.vertices + v, chunk.vertexCount);
+            if (first)
+            {
+                chunk.reserveVertices = vertexCount;
+                chunk.reserveIndices = indexCount;
+                first = false;
+            }
+            done += chunk.vertexCount * sizeof(Vertex);
+            if (request->cancelled || !Push(std::move(chunk)))
+                return;
+            request->parsedBytes = done;
+        }
+        for (size_t i = 0; i < indexCount; i += indicesPerChunk)
+        {
+            Chunk chunk;
+            chunk.request = request;
+            chunk.firstVertex = vertexCount;
+            chunk.firstIndex = i;
+            chunk.indices.assign(cached.indices + i, cached.indices + std::min(indexCount, i + indicesPerChunk));
+            if (first)
+            {
+                chunk.reserveVertices = vertexCount;
+                chunk.reserveIndices = indexCount;
+                first = false;
+            }
+            done += chunk.indices.size() * sizeof(GLuint);
+            if (request->cancelled || !Push(std::move(chunk)))
+                return;
+            request->parsedBytes = done;
+        }
+    }
+
+    void MeshLoader::LoadParsed(const std::shared_ptr<Request> &request)
+    {
+        MappedFile file(request->path);
+        const char *begin = file.data(), *end = begin + file.size();
+        request->fileBytes = file.size();
+        const VertexLayout layout = request->mesh->GetFormat().layout;
+        const size_t stride = GL_Mesh::VertexStride(layout);
+
+        // attributes of everything parsed so far, in file order
+        std::vector<vec3> positions, normals;
+        std::vector<vec2> texCoords;
+        struct Parsed
+        {
+            Obj::Chunk chunk;
+            size_t base[3]; // positions, texcoords, normals before this chunk, for relative indices
+            const char *begin, *end;
+        };
+        std::deque<Parsed> parsed;
+        const char *cursor = begin;
+        bool colorsFound = false;
+
+        auto parseNext = [&]() -> bool
+        {
+            if (cursor >= end)
+                return false;
+            const char *cut = cursor + std::min(chunkBytes, size_t(end - cursor));
+            if (cut < end)
+            {
+                const char *nl = static_cast<const char *>(memchr(cut, '\n', end - cut));
+                cut = nl ? nl + 1 : end;
+            }
+            Parsed next{Obj::ParseChunk(cursor, cut), {positions.size(), texCoords.size(), normals.size()}, cursor, cut};
+            positions.insert(positions.end(), next.chunk.positions.begin(), next.chunk.positions.end());
+            texCoords.insert(texCoords.end(), next.chunk.texCoords.begin(), next.chunk.texCoords.end());
+            normals.insert(normals.end(), next.chunk.normals.begin(), next.chunk.normals.end());
+            next.chunk.positions = {};
+            next.chunk.texCoords = {};
+            next.chunk.normals = {};
+            colorsFound |= next.chunk.colorsFound;
+            parsed.push_back(std::move(next));
+            cursor = cut;
+            request->parsedBytes = uint64_t(cursor - begin);
+            return true;
+        };
+
+        // the cache gets each chunk as it is queued, in the order FromOBJ would write the full mesh
+        VertexDedupeMap vertexEntries;
+        MeshCache::Writer cache(request->path);
+        std::vector<Vertex> vertices; // the current chunk's new vertices
+        size_t vertexTotal = 0, indexTotal = 0;
+        bool first = true;
+
+        while (!request->cancelled)
+        {
+            if (parsed.empty() && !parseNext())
+                break;
+
+            // faces may name attributes further down the file; read ahead until they exist
+            Parsed &current = parsed.front();
+            std::array<size_t, 3> needed{0, 0, 0};
+            for (const Obj::Corner &corner : current.chunk.corners)
+                for (int slot = 0; slot < 3; slot++)
+                    if (corner.index[slot] != Obj::Corner::Missing)
+                    {
+                        const int64_t index = corner.index[slot] + (corner.relative & (1u << slot) ? int64_t(current.base[slot]) : 0);
+                        if (index < 0)
+                            throw std::runtime_error("OBJ face index out of range");
+                        needed[slot] = std::max(needed[slot], size_t(index) + 1);
+                    }
+            while ((needed[0] > positions.size() || needed[1] > texCoords.size() || needed[2] > normals.size()) && parseNext())
+            {
+            }
+            if (needed[0] > positions.size() || needed[1] > texCoords.size() || needed[2] > normals.size())
+                throw std::runtime_error("OBJ face index out of range");
+
+            Chunk chunk;
+            chunk.request = request;
+            chunk.firstVertex = vertexTotal;
+            chunk.firstIndex = indexTotal;
+            vertices.clear();
+            chunk.indices.reserve(current.chunk.corners.size());
+            for (const Obj::Corner &corner : current.chunk.corners)
+            {
+                VertexDedupeMap::Key key;
+                for (int slot = 0; slot < 3; slot++)
+                    key[slot] = corner.index[slot] == Obj::Corner::Missing
+                                    ? Obj::Missing
+                                    : uint32_t(corner.index[slot] + (corner.relative & (1u << slot) ? int64_t(current.base[slot]) : 0));
+
+                bool inserted;
+                const uint32_t vertIndex = vertexEntries.FindOrInsert(key, uint32_t(vertexTotal + vertices.size()), inserted);
+                chunk.indices.push_back(vertIndex);
+                if (!inserted)
+                    continue;
+
+                // as ParseOBJ builds them
+                Vertex v;
+                v.Position = {0, 0, 0};
+                v.Normal = {0, 0, 0};
+                v.Color = {0, 0, 0, 0};
+                v.TexCoord = {0, 0};
+                if (key[0] != Obj::Missing)
+                    v.Position = positions[key[0]];
+                if (key[1] != Obj::Missing)
+                    v.TexCoord = texCoords[key[1]];
+                if (key[2] != Obj::Missing)
+                    v.Normal = normals[key[2]];
+                vertices.push_back(v);
+            }
+            const double remaining = double(end - current.begin) / double(current.end - current.begin);
+            parsed.pop_front();
+            if (chunk.indices.empty())
+                continue; // attributes only, nothing to draw yet
+
+            chunk.vertexCount = vertices.size();
+            chunk.vertexBytes.resize(chunk.vertexCount * stride);
+            GL_Mesh::ConvertVertices(layout, chunk.vertexBytes.data(), vertices.data(), chunk.vertexCount);
+            cache.AddVertices(vertices.data(), vertices.size());
+            cache.AddIndices(chunk.indices.data(), chunk.indices.size());
+            vertexTotal += vertices.size();
+            indexTotal += chunk.indices.size();
+            if (first && chunk.vertexCount > 0)
+            {
+                // the first slice with faces, extrapolated over the rest of the file with some slack;
+                // attributes usually come first, so the file size alone would undercount
+                chunk.reserveVertices = chunk.firstVertex + size_t(double(chunk.vertexCount) * remaining * 1.1) + 1024;
+                chunk.reserveIndices = chunk.firstIndex + size_t(double(chunk.indices.size()) * remaining * 1.1) + 3072;
+                first = false;
+            }
+            request->colorsFound = colorsFound;
+            if (!Push(std::move(chunk)))
+                return;
+        }
+        if (request->cancelled)
+            return;
+        cache.Finish(colorsFound);
+    }
+
+    void MeshLoader::Update(size_t budgetBytes)
+    {
+        Profiler::Scope scope("MeshLoader::Update");
+        size_t spent = 0;
+        while (true)
+        {
+            Chunk *chunk;
+            {
+                std::lock_guard lock(mutex);
+                if (chunks.empty())
+                    break;
+                // only this thread pops, and push_back keeps references to other elements valid
+                chunk = &chunks.front();
+            }
+            Request &request = *chunk->request;
+
+            bool complete = true;
+            if (!request.cancelled && !chunk->last)
+            {
+                GL_Mesh &mesh = *request.mesh;
+                if (chunk->reserveVertices || chunk->reserveIndices)
+                {
+                    mesh.ReserveGpu(chunk->reserveVertices, chunk->reserveIndices);
+                    chunk->reserveVertices = chunk->reserveIndices = 0;
+                }
+
+                // vertices before indices, so every index on the GPU points at an uploaded vertex
+                const size_t stride = GL_Mesh::VertexStride(mesh.GetFormat().layout);
+                if (chunk->verticesDone < chunk->vertexCount && (spent < budgetBytes || spent == 0))
+                {
+                    const size_t count = std::min(chunk->vertexCount - chunk->verticesDone,
+                                                  std::max<size_t>(1, (budgetBytes - std::min(spent, budgetBytes)) / stride));
+                    mesh.WriteGpuVertices(chunk->firstVertex + chunk->verticesDone, chunk->vertexBytes.data() + chunk->verticesDone * stride, count);
+                    chunk->verticesDone += count;
+                    spent += count * stride;
+                }
+                if (chunk->verticesDone == chunk->vertexCount && chunk->indicesDone < chunk->indices.size() &&
+                    (spent < budgetBytes || spent == 0))
+                {
+                    const size_t count = std::min(chunk->indices.size() - chunk->indicesDone,
+                                                  std::max<size_t>(1, (budgetBytes - std::min(spent, budgetBytes)) / sizeof(GLuint)));
+                    mesh.WriteGpuIndices(chunk->firstIndex + chunk->indicesDone, chunk->indices.data() + chunk->indicesDone, count);
+                    chunk->indicesDone += count;
+                    spent += count * sizeof(GLuint);
+                }
+                complete = chunk->verticesDone == chunk->vertexCount && chunk->indicesDone == chunk->indices.size();
+                request.uploadedVertices = mesh.GetVertexCount();
+                request.uploadedIndices = mesh.GetIndexCount();
+            }
+            if (!complete)
+                break; // budget spent part way through this chunk
+
+            const std::shared_ptr<Request> owner = chunk->request;
+            const bool last = chunk->last;
+            if (!request.cancelled)
+            {
+                request.uploadedBytes += chunk->Bytes();
+                bytesUploaded += chunk->Bytes();
+            }
+            {
+                std::lock_guard lock(mutex);
+                queuedBytes -= chunk->Bytes();
+                chunks.pop_front();
+            }
+            spaceFreed.notify_all();
+            if (last)
+                Finish(*owner, owner->cancelled ? State::Cancelled : owner->error.empty() ? State::Done : State::Failed);
+            if (spent >= budgetBytes)
+                break;
+        }
+    }
+
+    void MeshLoader::Finish(Request &request, State state)
+    {
+        // the estimate usually lands within a few percent; only a bad one is worth the copy
+        const GL_Mesh &mesh = *request.mesh;
+        const size_t used = mesh.GetVertexCount() * GL_Mesh::VertexStride(mesh.GetFormat().layout) + mesh.GetIndexCount() * sizeof(GLuint);
+        if (state == State::Done && mesh.GpuBytes() > used + used / 4)
+            request.mesh->ShrinkGpuToFit();
+        request.uploadedVertices = request.mesh->GetVertexCount();
+        request.uploadedIndices = request.mesh->GetIndexCount();
+        request.state = state;
+        {
+            std::lock_guard lock(mutex);
+            active--;
+        }
+        if (request.done)
+            request.done(request);
+    }
+
+    MeshLoader::Stats MeshLoader::GetStats() const
+    {
+        std::lock_guard lock(mutex);
+        Stats stats;
+        stats.active = active;
+        stats.queuedChunks = chunks.size();
+        stats.queuedBytes = queuedBytes;
+        stats.bytesUploaded = bytesUploaded;
+        stats.workerWaits = workerWaits;
+        return stats;
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "Mesh.h"
+#include "MeshCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ImguiBase
+{
+    /// @brief Loads OBJ files into GL_Meshes without blocking the render thread.
+    /// A worker parses the file front to back in line-aligned slices and assembles vertices in
+    /// the same order as Mesh::FromOBJ, so every chunk it queues only references vertices from
+    /// itself or earlier chunks. Update() uploads queued chunks within a byte budget per frame;
+    /// the mesh draws whatever has arrived so far. Unchanged files load from the mesh cache,
+    /// parsed ones write it like FromOBJ does. The finished mesh keeps no CPU copy.
+    class MeshLoader
+    {
+    public:
+        enum class State
+        {
+            Queued,
+            Loading,
+            Done,
+            Failed,
+            Cancelled,
+        };
+
+        struct Progress
+        {
+            State state = State::Queued;
+            float parsed = 0;   // fraction of the file read by the worker
+            float uploaded = 0; // fraction of the mesh on the GPU, an estimate until parsing ends
+            size_t vertices = 0, indices = 0; // uploaded so far
+            std::string error;
+        };
+
+        class Request;
+        using Callback = std::function<void(Request &request)>;
+
+        /// @brief One load. The mesh exists from the start and grows as chunks are uploaded.
+        class Request
+        {
+        public:
+            const std::shared_ptr<GL_Mesh> &GetMesh() const { return mesh; }
+            const std::string &GetPath() const { return path; }
+            Progress GetProgress() const;
+            State GetState() const { return state; }
+            bool Finished() const { return state >= State::Done; }
+            bool ColorsFound() const { return colorsFound; }
+
+        private:
+            friend class MeshLoader;
+            std::string path;
+            std::shared_ptr<GL_Mesh> mesh;
+            Callback done;
+
+            std::atomic<State> state{State::Queued};
+            std::atomic<bool> cancelled{false};
+            std::atomic<bool> colorsFound{false};
+            std::atomic<uint64_t> fileBytes{0}, parsedBytes{0};
+            std::atomic<uint64_t> producedBytes{0}; // handed to the render thread
+            std::atomic<bool> parsingDone{false};
+            std::string error; // set by the worker before it queues the final chunk
+
+            // render thread
+            uint64_t uploadedBytes = 0;
+            size_t uploadedVertices = 0, uploadedIndices = 0;
+        };
+
+        struct Stats
+        {
+            size_t active = 0;        // queued or loading
+            size_t queuedChunks = 0;
+            size_t queuedBytes = 0;
+            uint64_t bytesUploaded = 0;
+            uint64_t workerWaits = 0; // times a worker waited because maxQueuedBytes were queued
+        };
+
+        /// @brief `chunkBytes` of OBJ text are parsed per chunk; workers stop parsing while
+        /// `maxQueuedBytes` of chunks wait for upload.
+        explicit MeshLoader(unsigned workers = 1, size_t chunkBytes = 4ull << 20, size_t maxQueuedBytes = 256ull << 20);
+        ~MeshLoader();
+        MeshLoader(const MeshLoader &) = delete;
+        MeshLoader &operator=(const MeshLoader &) = delete;
+
+        /// @brief Needs a current GL context for the mesh. `done` runs on the render thread in Update()
+        /// once the request is Done, Failed or Cancelled. Persistent formats load as static meshes.
+        std::shared_ptr<Request> Load(const std::string &path, MeshFormat format = {}, Callback done = nullptr);
+        /// @brief Stops parsing and drops queued chunks; the mesh keeps what was already uploaded.
+        void Cancel(const std::shared_ptr<Request> &request);
+
+        /// @brief Render thread, once per frame. Uploads at most `budgetBytes` (at least one slice
+        /// so a small budget still makes progress) and never waits on the workers.
+        void Update(size_t budgetBytes = 8ull << 20);
+        Stats GetStats() const;
+
+    private:
+        // vertices in the mesh's layout, then indices; both continue where the previous chunk ended
+        struct Chunk
+        {
+            std::shared_ptr<Request> request;
+            std::vector<char> vertexBytes;
+            size_t firstVertex = 0, vertexCount = 0;
+            std::vector<GLuint> indices;
+            size_t firstIndex = 0;
+            size_t reserveVertices = 0, reserveIndices = 0; // capacity hint, 0 for none
+            bool last = false;
+
+            size_t verticesDone = 0, indicesDone = 0; // render thread, partial uploads
+            size_t Bytes() const { return vertexBytes.size() + indices.size() * sizeof(GLuint); }
+        };
+
+        size_t chunkBytes, maxQueuedBytes;
+
+        mutable std::mutex mutex;
+        std::condition_variable wake;       // workers: new requests or stop
+        std::condition_variable spaceFreed; // workers waiting on maxQueuedBytes
+        std::deque<std::shared_ptr<Request>> requests;
+        std::deque<Chunk> chunks;
+        size_t queuedBytes = 0;
+        size_t active = 0;
+        bool stopping = false;
+        uint64_t workerWaits = 0;
+        std::vector<std::thread> threads;
+
+        uint64_t bytesUploaded = 0; // render thread
+
+        void WorkerLoop();
+        void LoadCached(const std::shared_ptr<Request> &request, const MeshCache::View &cached);
+        void LoadParsed(const std::shared_ptr<Request> &request);
+        /// @brief Worker side: waits for queue space, false once the request is cancelled or the loader stops.
+        bool Push(Chunk &&chunk);
+        void Finish(Request &request, State state);
+    };
+}
@@ -0,0 +1,250 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace ImguiBase::MeshOptimizer
+{
+    // Forsyth's tuning; the cache is modelled as LRU with 32 entries
+    static constexpr int CacheSize = 32;
+    static constexpr int MaxValence = 32;
+
+    struct ScoreTables
+    {
+        float cache[CacheSize];
+        float valence[MaxValence + 1];
+
+        ScoreTables()
+        {
+            for (int i = 0; i < CacheSize; i++)
+                cache[i] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / (CacheSize - 3), 1.5f);
+            valence[0] = 0;
+            for (int i = 1; i <= MaxValence; i++)
+                valence[i] = 2.0f / std::sqrt(float(i));
+        }
+    };
+
+    static float VertexScore(const ScoreTables &tables, int cachePos, uint32_t remaining)
+    {
+        if (remaining == 0)
+            return -1.0f;
+        const float cache = cachePos >= 0 ? tables.cache[cachePos] : 0.0f;
+        return cache + tables.valence[std::min<uint32_t>(remaining, MaxValence)];
+    }
+
+    void OptimizeVertexCache(std::vector<GLuint> &indices, size_t vertexCount)
+    {
+        const size_t triCount = indices.size() / 3;
+        if (triCount == 0)
+            return;
+        static const ScoreTables tables;
+
+        // triangles around each vertex; `remaining` counts the ones not emitted yet
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (size_t i = 0; i < triCount * 3; i++)
+            remaining[indices[i]]++;
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] = offsets[v] + remaining[v];
+        std::vector<uint32_t> adjacency(triCount * 3);
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triCount; t++)
+                for (int k = 0; k < 3; k++)
+                    adjacency[fill[indices[t * 3 + k]]++] = uint32_t(t);
+        }
+
+        std::vector<int> cachePos(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            vertexScore[v] = VertexScore(tables, -1, remaining[v]);
+        std::vector<float> triScore(triCount);
+        for (size_t t = 0; t < triCount; t++)
+            triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        std::vector<uint8_t> emitted(triCount, 0);
+        std::vector<GLuint> out;
+        out.reserve(triCount * 3);
+        uint32_t cache[CacheSize + 3];
+        int cacheCount = 0;
+        size_t scanCursor = 0;
+
+        int64_t best = std::max_element(triScore.begin(), triScore.end()) - triScore.begin();
+        while (best >= 0)
+        {
+            emitted[best] = 1;
+            const GLuint *tri = &indices[best * 3];
+            out.insert(out.end(), tri, tri + 3);
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t *list = &adjacency[offsets[tri[k]]];
+                uint32_t &count = remaining[tri[k]];
+                auto it = std::find(list, list + count, uint32_t(best));
+                *it = list[--count];
+            }
+
+            // emitted vertices move to the front, the rest shift back and may fall out
+            uint32_t next[CacheSize + 3];
+            int nextCount = 0;
+            for (int k = 0; k < 3; k++)
+                if (std::find(next, next + nextCount, tri[k]) == next + nextCount)
+                    next[nextCount++] = tri[k];
+            for (int i = 0; i < cacheCount; i++)
+                if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+                    next[nextCount++] = cache[i];
+
+            for (int i = 0; i < nextCount; i++)
+            {
+                const uint32_t v = next[i];
+                cachePos[v] = i < CacheSize ? i : -1;
+                const float score = VertexScore(tables, cachePos[v], remaining[v]);
+                const float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                for (uint32_t j = 0; j < remaining[v]; j++)
+                    triScore[adjacency[offsets[v] + j]] += delta;
+            }
+            cacheCount = std::min(nextCount, CacheSize);
+            std::copy(next, next + cacheCount, cache);
+
+            best = -1;
+            float bestScore = -1e30f;
+            for (int i = 0; i < cacheCount; i++)
+            {
+                const uint32_t v = cache[i];
+                for (uint32_t j = 0; j < remaining[v]; j++)
+                {
+                    const uint32_t t = adjacency[offsets[v] + j];
+                    if (triScore[t] > bestScore)
+                    {
+                        bestScore = triScore[t];
+                        best = t;
+                    }
+                }
+            }
+            if (best < 0)
+            {
+                // nothing left around the cache, continue with the next untouched triangle
+                while (scanCursor < triCount && emitted[scanCursor])
+                    scanCursor++;
+                if (scanCursor < triCount)
+                    best = scanCursor;
+            }
+        }
+        indices.swap(out);
+    }
+
+    void OptimizeOverdraw(std::vector<GLuint> &indices, const std::vector<Vertex> &vertices, unsigned cacheSize)
+    {
+        const size_t triCount = indices.size() / 3;
+        if (triCount == 0)
+            return;
+
+        // a cluster starts wherever all three corners miss the FIFO cache, so reordering
+        // whole clusters leaves the cache behaviour inside them untouched
+        std::vector<size_t> clusterStart;
+        std::vector<uint32_t> stamp(vertices.size(), 0);
+        uint32_t time = cacheSize + 1;
+        for (size_t t = 0; t < triCount; t++)
+        {
+            int misses = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t &s = stamp[indices[t * 3 + k]];
+                if (time - s > cacheSize)
+                {
+                    s = time++;
+                    misses++;
+                }
+            }
+            if (misses == 3 || t == 0)
+                clusterStart.push_back(t);
+        }
+        clusterStart.push_back(triCount);
+        const size_t clusterCount = clusterStart.size() - 1;
+
+        vec3 meshCenter(0);
+        float meshArea = 0;
+        std::vector<vec3> centers(clusterCount), normals(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            vec3 center(0), normal(0);
+            float area = 0;
+            for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++)
+            {
+                const vec3 &a = vertices[indices[t * 3]].Position;
+                const vec3 &b = vertices[indices[t * 3 + 1]].Position;
+                const vec3 &d = vertices[indices[t * 3 + 2]].Position;
+                const vec3 n = cross(b - a, d - a);
+                const float w = length(n);
+                center += (a + b + d) * (w / 3.0f);
+                normal += n;
+                area += w;
+            }
+            meshCenter += center;
+            meshArea += area;
+            centers[c] = area > 0 ? center / area : vertices[indices[clusterStart[c] * 3]].Position;
+            normals[c] = normal;
+        }
+        if (meshArea > 0)
+            meshCenter /= meshArea;
+
+        std::vector<float> key(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            const float len = length(normals[c]);
+            key[c] = len > 0 ? dot(centers[c] - meshCenter, normals[c] / len) : 0.0f;
+        }
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return key[a] > key[b]; });
+
+        std::vector<GLuint> out;
+        out.reserve(indices.size());
+        for (size_t c : order)
+            out.insert(out.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+        indices.swap(out);
+    }
+
+    void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<GLuint> &indices)
+    {
+        constexpr GLuint Unused = GLuint(-1);
+        std::vector<GLuint> remap(vertices.size(), Unused);
+        GLuint next = 0;
+        for (GLuint &index : indices)
+        {
+            if (remap[index] == Unused)
+                remap[index] = next++;
+            index = remap[index];
+        }
+        for (GLuint &r : remap)
+            if (r == Unused)
+                r = next++;
+
+        std::vector<Vertex> out(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++)
+            out[remap[v]] = vertices[v];
+        vertices.swap(out);
+    }
+
+    float CacheMissRatio(const std::vector<GLuint> &indices, size_t vertexCount, unsigned cacheSize)
+    {
+        const size_t triCount = indices.size() / 3;
+        if (triCount == 0)
+            return 0.0f;
+        std::vector<uint32_t> stamp(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        size_t misses = 0;
+        for (size_t i = 0; i < triCount * 3; i++)
+        {
+            uint32_t &s = stamp[indices[i]];
+            if (time - s > cacheSize)
+            {
+                s = time++;
+                misses++;
+            }
+        }
+        return float(misses) / float(triCount);
+    }
+}
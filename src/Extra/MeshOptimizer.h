@@ -0,0 +1,18 @@
+#pragma once
+#include "Mesh.h"
+#include <vector>
+
+namespace ImguiBase::MeshOptimizer
+{
+    /// @brief Reorders triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm).
+    void OptimizeVertexCache(std::vector<GLuint> &indices, size_t vertexCount);
+    /// @brief Cuts the cache-ordered triangles where the cache starts cold and sorts the clusters
+    /// outward-facing first, so depth testing rejects more of what is behind them.
+    void OptimizeOverdraw(std::vector<GLuint> &indices, const std::vector<Vertex> &vertices, unsigned cacheSize = 16);
+    /// @brief Renumbers vertices in order of first use so fetches walk the buffer forwards.
+    /// Unreferenced vertices are kept, after the referenced ones.
+    void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<GLuint> &indices);
+
+    /// @brief Average cache miss ratio (vertex shader runs per triangle) with a FIFO cache.
+    float CacheMissRatio(const std::vector<GLuint> &indices, size_t vertexCount, unsigned cacheSize = 16);
+}
@@ -0,0 +1,280 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "VertexDedupeMap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace ImguiBase::MeshSimplifier
+{
+    // symmetric 4x4 error matrix of the planes around a vertex, weighted by triangle area
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;
+
+        Quadric() = default;
+        Quadric(const dvec3 &n, double d, double w)
+            : a00(n.x * n.x * w), a01(n.x * n.y * w), a02(n.x * n.z * w), a11(n.y * n.y * w), a12(n.y * n.z * w),
+              a22(n.z * n.z * w), b0(n.x * d * w), b1(n.y * d * w), b2(n.z * d * w), c(d * d * w), weight(w)
+        {
+        }
+
+        Quadric &operator+=(const Quadric &o)
+        {
+            a00 += o.a00, a01 += o.a01, a02 += o.a02, a11 += o.a11, a12 += o.a12, a22 += o.a22;
+            b0 += o.b0, b1 += o.b1, b2 += o.b2, c += o.c, weight += o.weight;
+            return *this;
+        }
+
+        // squared distance to the planes, averaged over their area
+        double Error(const vec3 &p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double e = x * (a00 * x + 2 * (a01 * y + a02 * z + b0)) + y * (a11 * y + 2 * (a12 * z + b1)) +
+                             z * (a22 * z + 2 * b2) + c;
+            return weight > 0 ? std::max(e, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        GLuint from, to;
+        double cost;
+    };
+
+    float Extent(const std::vector<vec3> &positions)
+    {
+        if (positions.empty())
+            return 0;
+        vec3 lo = positions[0], hi = positions[0];
+        for (const vec3 &p : positions)
+        {
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        const vec3 size = hi - lo;
+        return std::max(size.x, std::max(size.y, size.z));
+    }
+
+    static uint32_t FloatBits(float f)
+    {
+        f += 0.0f; // -0 and 0 are the same position
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    std::vector<GLuint> Simplify(const std::vector<vec3> &positions, const std::vector<GLuint> &indices,
+                                 size_t targetIndexCount, float targetError, float *resultError)
+    {
+        std::vector<GLuint> result(indices.begin(), indices.end() - indices.size() % 3);
+        if (resultError)
+            *resultError = 0;
+        const size_t vertexCount = positions.size();
+        if (result.size() <= targetIndexCount || vertexCount == 0)
+            return result;
+
+        // errors are measured on the mesh scaled into a unit box
+        vec3 lo = positions[0];
+        for (const vec3 &p : positions)
+            lo = glm::min(lo, p);
+        const float extent = Extent(positions);
+        const float scale = extent > 0 ? 1.0f / extent : 1.0f;
+        std::vector<vec3> points(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+            points[i] = (positions[i] - lo) * scale;
+
+        // one id per distinct position; several vertices at one position form an attribute seam
+        std::vector<uint32_t> group(vertexCount);
+        std::vector<uint32_t> groupSize;
+        {
+            VertexDedupeMap map(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                const vec3 &p = positions[i];
+                bool inserted;
+                group[i] = map.FindOrInsert({FloatBits(p.x), FloatBits(p.y), FloatBits(p.z)}, uint32_t(groupSize.size()), inserted);
+                if (inserted)
+                    groupSize.push_back(0);
+                groupSize[group[i]]++;
+            }
+        }
+
+        // edges not shared by exactly two triangles are borders or non-manifold; their ends stay put
+        std::vector<uint8_t> groupLocked(groupSize.size(), 0);
+        {
+            std::vector<uint64_t> edges;
+            edges.reserve(result.size());
+            for (size_t t = 0; t < result.size(); t += 3)
+                for (int k = 0; k < 3; k++)
+                {
+                    const uint64_t a = group[result[t + k]], b = group[result[t + (k + 1) % 3]];
+                    edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+                }
+            std::sort(edges.begin(), edges.end());
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t j = i + 1;
+                while (j < edges.size() && edges[j] == edges[i])
+                    j++;
+                if (j - i != 2)
+                    groupLocked[edges[i] >> 32] = groupLocked[edges[i] & 0xffffffffu] = 1;
+                i = j;
+            }
+        }
+        std::vector<uint8_t> locked(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+            locked[i] = groupSize[group[i]] > 1 || groupLocked[group[i]];
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            const vec3 &p0 = points[result[t]], &p1 = points[result[t + 1]], &p2 = points[result[t + 2]];
+            const dvec3 n = glm::cross(dvec3(p1 - p0), dvec3(p2 - p0));
+            const double length = glm::length(n);
+            if (length <= 0)
+                continue;
+            const dvec3 unit = n / length;
+            const Quadric q(unit, -glm::dot(unit, dvec3(p0)), length * 0.5);
+            for (int k = 0; k < 3; k++)
+                quadrics[result[t + k]] += q;
+        }
+
+        const double errorLimit = double(targetError) * targetError;
+        double maxError = 0;
+        std::vector<uint32_t> offsets(vertexCount + 1), adjacency, fill;
+        std::vector<GLuint> bestTarget(vertexCount), remap(vertexCount);
+        std::vector<double> bestCost(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<Collapse> candidates;
+
+        // each pass picks the cheapest collapses that do not share a neighbourhood, applies them
+        // and rebuilds the index list; quadrics of collapsed vertices move to their target
+        while (result.size() > targetIndexCount)
+        {
+            const size_t triCount = result.size() / 3;
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (GLuint i : result)
+                offsets[i + 1]++;
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            adjacency.resize(result.size());
+            fill.assign(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triCount; t++)
+                for (int k = 0; k < 3; k++)
+                    adjacency[fill[result[t * 3 + k]]++] = uint32_t(t);
+
+            std::fill(bestCost.begin(), bestCost.end(), std::numeric_limits<double>::infinity());
+            for (size_t t = 0; t < result.size(); t += 3)
+                for (int k = 0; k < 3; k++)
+                {
+                    const GLuint from = result[t + k];
+                    if (locked[from])
+                        continue;
+                    for (int o = 1; o < 3; o++)
+                    {
+                        const GLuint to = result[t + (k + o) % 3];
+                        Quadric q = quadrics[from];
+                        q += quadrics[to];
+                        const double cost = q.Error(points[to]);
+                        if (cost < bestCost[from])
+                        {
+                            bestCost[from] = cost;
+                            bestTarget[from] = to;
+                        }
+                    }
+                }
+            candidates.clear();
+            for (size_t v = 0; v < vertexCount; v++)
+                if (bestCost[v] <= errorLimit)
+                    candidates.push_back({GLuint(v), bestTarget[v], bestCost[v]});
+            if (candidates.empty())
+                break;
+            std::sort(candidates.begin(), candidates.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+            // a collapse removes about two triangles
+            const size_t budget = std::max<size_t>(1, (result.size() - targetIndexCount) / 6);
+            std::iota(remap.begin(), remap.end(), 0);
+            std::fill(touched.begin(), touched.end(), 0);
+            size_t applied = 0;
+            for (const Collapse &c : candidates)
+            {
+                if (touched[c.from] || touched[c.to])
+                    continue;
+                // reject collapses that flip or squash a remaining triangle around `from`
+                bool flips = false;
+                for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1] && !flips; a++)
+                {
+                    const GLuint *tri = &result[adjacency[a] * 3];
+                    if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+                        continue;
+                    vec3 p[3];
+                    for (int k = 0; k < 3; k++)
+                        p[k] = points[tri[k]];
+                    const vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (int k = 0; k < 3; k++)
+                        if (tri[k] == c.from)
+                            p[k] = points[c.to];
+                    const vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    const float lengths = glm::length(before) * glm::length(after);
+                    flips = lengths <= 0 || glm::dot(before, after) < 0.25f * lengths;
+                }
+                if (flips)
+                    continue;
+
+                remap[c.from] = c.to;
+                quadrics[c.to] += quadrics[c.from];
+                maxError = std::max(maxError, c.cost);
+                // the whole one-ring, so no neighbour moves under a triangle checked above
+                for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1]; a++)
+                    for (int k = 0; k < 3; k++)
+                        touched[result[adjacency[a] * 3 + k]] = 1;
+                touched[c.to] = 1;
+                if (++applied >= budget)
+                    break;
+            }
+            if (applied == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t t = 0; t < result.size(); t += 3)
+            {
+                const GLuint a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (resultError)
+            *resultError = float(std::sqrt(maxError));
+        return result;
+    }
+
+    std::vector<Lod> BuildLodChain(const std::vector<vec3> &positions, const std::vector<GLuint> &indices,
+                                   size_t maxLevels, float reduction, float maxError)
+    {
+        std::vector<Lod> chain;
+        float error = 0;
+        for (size_t level = 0; level < maxLevels && error < maxError; level++)
+        {
+            const std::vector<GLuint> &previous = chain.empty() ? indices : chain.back().indices;
+            const size_t target = size_t(previous.size() / 3 * reduction) * 3;
+            float levelError;
+            std::vector<GLuint> simplified = Simplify(positions, previous, target, maxError - error, &levelError);
+            if (simplified.empty() || simplified.size() * 10 > previous.size() * 9)
+                break;
+            // errors of successive levels add up at worst
+            error += levelError;
+            MeshOptimizer::OptimizeVertexCache(simplified, positions.size());
+            chain.push_back({std::move(simplified), error});
+        }
+        return chain;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Mesh.h"
+#include <vector>
+
+namespace ImguiBase::MeshSimplifier
+{
+    struct Lod
+    {
+        std::vector<GLuint> indices; // into the same vertices as the source
+        float error = 0;             // relative to the mesh extent, accumulated over the chain
+    };
+
+    /// @brief Quadric error edge collapse (Garland-Heckbert). Vertices are only ever collapsed
+    /// onto a neighbour, so the result indexes the original vertex buffer and no vertex data
+    /// changes. Border vertices and attribute seams (several vertices at one position) stay put.
+    /// Stops at `targetIndexCount` or once the next collapse would move the surface by more than
+    /// `targetError` times the mesh extent; `resultError` gets the largest error accepted.
+    std::vector<GLuint> Simplify(const std::vector<vec3> &positions, const std::vector<GLuint> &indices,
+                                 size_t targetIndexCount, float targetError, float *resultError = nullptr);
+
+    /// @brief Up to `maxLevels` LODs after the source, each simplified from the one before to
+    /// `reduction` of its triangles and cache optimized. Ends early once a level stops shrinking
+    /// by at least a tenth or its accumulated error would pass `maxError`.
+    std::vector<Lod> BuildLodChain(const std::vector<vec3> &positions, const std::vector<GLuint> &indices,
+                                   size_t maxLevels = 4, float reduction = 0.5f, float maxError = 0.05f);
+
+    /// @brief Largest side of the bounding box; Simplify's errors are relative to it.
+    float Extent(const std::vector<vec3> &positions);
+}
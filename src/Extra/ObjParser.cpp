@@ -0,0 +1,263 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace ImguiBase::Obj
+{
+    // Below this a chunk is not worth a thread of its own.
+    static constexpr size_t MinChunkBytes = 256 * 1024;
+
+    static inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static inline const char *SkipSpace(const char *p, const char *end)
+    {
+        while (p < end && IsSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static inline const char *TokenEnd(const char *p, const char *end)
+    {
+        while (p < end && !IsSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static inline float ParseFloat(const char *b, const char *e)
+    {
+        if (b < e && *b == '+')
+            ++b;
+        float v = 0;
+        std::from_chars(b, e, v);
+        return v;
+    }
+
+    // Reads up to N floats from the rest of the line, returns how many tokens the line has.
+    template <int N>
+    static int ParseFloats(const char *p, const char *end, float (&out)[N])
+    {
+        int tokens = 0;
+        while ((p = SkipSpace(p, end)) < end)
+        {
+            const char *e = TokenEnd(p, end);
+            if (tokens < N)
+                out[tokens] = ParseFloat(p, e);
+            tokens++;
+            p = e;
+        }
+        return tokens;
+    }
+
+    // One v/vt/vn component of a face corner; 0 and unparsable behave like an empty field.
+    static inline void ParseIndex(const char *b, const char *e, size_t count, Corner &corner, int slot)
+    {
+        corner.index[slot] = Corner::Missing;
+        if (b < e && *b == '+')
+            ++b;
+        int64_t raw = 0;
+        if (b >= e || std::from_chars(b, e, raw).ec != std::errc() || raw == 0)
+            return;
+        if (raw > 0)
+            corner.index[slot] = raw - 1;
+        else
+        {
+            corner.index[slot] = (int64_t)count + raw;
+            corner.relative |= uint8_t(1u << slot);
+        }
+    }
+
+    static inline Corner ParseCorner(const char *b, const char *e, const Chunk &chunk)
+    {
+        Corner corner{};
+        const char *s1 = std::find(b, e, '/');
+        ParseIndex(b, s1, chunk.positions.size(), corner, 0);
+        const char *s2 = s1 < e ? std::find(s1 + 1, e, '/') : e;
+        if (s1 < e)
+            ParseIndex(s1 + 1, s2, chunk.texCoords.size(), corner, 1);
+        else
+            corner.index[1] = Corner::Missing;
+        if (s2 < e)
+            ParseIndex(s2 + 1, e, chunk.normals.size(), corner, 2);
+        else
+            corner.index[2] = Corner::Missing;
+        return corner;
+    }
+
+    static void ParseFace(const char *p, const char *end, Chunk &chunk)
+    {
+        Corner first{}, previous{};
+        int count = 0;
+        while ((p = SkipSpace(p, end)) < end)
+        {
+            const char *e = TokenEnd(p, end);
+            Corner corner = ParseCorner(p, e, chunk);
+            p = e;
+            if (count == 0)
+                first = corner;
+            else if (count >= 2)
+            {
+                // fan: (0, i-1, i)
+                chunk.corners.push_back(first);
+                chunk.corners.push_back(previous);
+                chunk.corners.push_back(corner);
+            }
+            previous = corner;
+            count++;
+        }
+    }
+
+    Chunk ParseChunk(const char *begin, const char *end)
+    {
+        Chunk chunk;
+        // rough per-line guesses so the common case does not keep reallocating
+        const size_t guess = size_t(end - begin) / 40;
+        chunk.positions.reserve(guess / 2);
+        chunk.corners.reserve(guess);
+
+        const char *p = begin;
+        while (p < end)
+        {
+            const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+            const char *lineEnd = nl ? nl : end;
+            const char *line = p;
+            p = nl ? nl + 1 : end;
+
+            if (lineEnd - line < 2)
+                continue;
+            const char c0 = line[0];
+            const char c1 = line[1] == '\t' ? ' ' : line[1];
+
+            if (c0 == 'v' && c1 == ' ') // POSITION + COLOR
+            {
+                float values[3] = {0, 0, 0};
+                if (ParseFloats(line + 1, lineEnd, values) > 3)
+                    chunk.colorsFound = true;
+                chunk.positions.push_back({values[0], values[1], values[2]});
+            }
+            else if (c0 == 'v' && c1 == 'n') // NORMALS
+            {
+                float values[3] = {0, 0, 0};
+                ParseFloats(line + 2, lineEnd, values);
+                chunk.normals.push_back({values[0], values[1], values[2]});
+            }
+            else if (c0 == 'v' && c1 == 't') // TexCoords
+            {
+                float values[2] = {0, 0};
+                ParseFloats(line + 2, lineEnd, values);
+                chunk.texCoords.push_back({values[0], values[1]});
+            }
+            else if (c0 == 'f' && c1 == ' ') // COMPOSITION
+                ParseFace(line + 1, lineEnd, chunk);
+        }
+        return chunk;
+    }
+
+    std::vector<std::pair<const char *, const char *>> SplitLines(const char *begin, const char *end, size_t parts)
+    {
+        std::vector<std::pair<const char *, const char *>> ranges;
+        const size_t size = size_t(end - begin);
+        parts = std::max<size_t>(1, parts);
+
+        const char *start = begin;
+        for (size_t i = 1; i <= parts && start < end; i++)
+        {
+            const char *cut = i == parts ? end : begin + size * i / parts;
+            if (cut < start)
+                cut = start;
+            if (cut < end)
+            {
+                const char *nl = static_cast<const char *>(memchr(cut, '\n', end - cut));
+                cut = nl ? nl + 1 : end;
+            }
+            ranges.push_back({start, cut});
+            start = cut;
+        }
+        return ranges;
+    }
+
+    Data Merge(std::vector<Chunk> &&chunks)
+    {
+        Data data;
+        size_t positions = 0, normals = 0, texCoords = 0, corners = 0;
+        for (const auto &chunk : chunks)
+        {
+            positions += chunk.positions.size();
+            normals += chunk.normals.size();
+            texCoords += chunk.texCoords.size();
+            corners += chunk.corners.size();
+            data.colorsFound |= chunk.colorsFound;
+        }
+        data.positions.reserve(positions);
+        data.normals.reserve(normals);
+        data.texCoords.reserve(texCoords);
+        data.corners.reserve(corners);
+
+        const size_t totals[3] = {positions, texCoords, normals};
+        for (auto &chunk : chunks)
+        {
+            const size_t base[3] = {data.positions.size(), data.texCoords.size(), data.normals.size()};
+            for (const Corner &corner : chunk.corners)
+            {
+                std::array<uint32_t, 3> resolved;
+                for (int slot = 0; slot < 3; slot++)
+                {
+                    int64_t index = corner.index[slot];
+                    if (index == Corner::Missing)
+                    {
+                        resolved[slot] = Missing;
+                        continue;
+                    }
+                    if (corner.relative & (1u << slot))
+                        index += (int64_t)base[slot];
+                    if (index < 0 || (uint64_t)index >= totals[slot])
+                        throw std::runtime_error("OBJ face index out of range");
+                    resolved[slot] = (uint32_t)index;
+                }
+                data.corners.push_back(resolved);
+            }
+
+            data.positions.insert(data.positions.end(), chunk.positions.begin(), chunk.positions.end());
+            data.normals.insert(data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+            data.texCoords.insert(data.texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+            chunk = Chunk();
+        }
+        return data;
+    }
+
+    Data ParseFile(const std::string &filepath, unsigned threads)
+    {
+        MappedFile file(filepath);
+        const char *begin = file.data();
+        const char *end = begin + file.size();
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t parts = std::clamp<size_t>(file.size() / MinChunkBytes, 1, threads);
+        const auto ranges = SplitLines(begin, end, parts);
+
+        std::vector<Chunk> chunks(ranges.size());
+        if (ranges.size() <= 1)
+        {
+            if (!ranges.empty())
+                chunks[0] = ParseChunk(ranges[0].first, ranges[0].second);
+        }
+        else
+        {
+            std::vector<std::future<Chunk>> pending;
+            pending.reserve(ranges.size());
+            for (const auto &range : ranges)
+                pending.push_back(std::async(std::launch::async, ParseChunk, range.first, range.second));
+            for (size_t i = 0; i < pending.size(); i++)
+                chunks[i] = pending[i].get();
+        }
+        return Merge(std::move(chunks));
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "../lib_include.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ImguiBase::Obj
+{
+    constexpr uint32_t Missing = uint32_t(-1);
+
+    /// @brief One face corner as written in the file: 0-based absolute indices,
+    /// or chunk-local ones (negative OBJ indices) flagged in `relative`.
+    struct Corner
+    {
+        static constexpr int64_t Missing = INT64_MIN;
+        int64_t index[3]; // position, texcoord, normal
+        uint8_t relative; // bit i set: index[i] is relative to the chunk start
+    };
+
+    /// @brief Everything parsed from one line-aligned range of an OBJ file.
+    struct Chunk
+    {
+        std::vector<vec3> positions;
+        std::vector<vec3> normals;
+        std::vector<vec2> texCoords;
+        std::vector<Corner> corners; // 3 per triangle, ngons fan-triangulated
+        bool colorsFound = false;
+    };
+
+    /// @brief Whole-file result with indices resolved, 3 corners per triangle.
+    struct Data
+    {
+        std::vector<vec3> positions;
+        std::vector<vec3> normals;
+        std::vector<vec2> texCoords;
+        std::vector<std::array<uint32_t, 3>> corners; // position, texcoord, normal; Missing when absent
+        bool colorsFound = false;
+    };
+
+    Chunk ParseChunk(const char *begin, const char *end);
+    /// @brief Splits [begin, end) into at most `parts` ranges that start and end on line boundaries.
+    std::vector<std::pair<const char *, const char *>> SplitLines(const char *begin, const char *end, size_t parts);
+    /// @brief Concatenates chunks in file order and resolves relative indices. Throws on out of range indices.
+    Data Merge(std::vector<Chunk> &&chunks);
+    /// @brief Memory-maps the file and parses chunks in parallel; threads = 0 uses every core.
+    Data ParseFile(const std::string &filepath, unsigned threads = 0);
+}
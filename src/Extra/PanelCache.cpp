@@ -0,0 +1,127 @@
+#include "PanelCache.h"
+#include "Profiler.h"
+#include <cstring>
+
+static uint64_t Mix(uint64_t h, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    h ^= bits + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    return h * 0xBF58476D1CE4E5B9ull;
+}
+
+// the capture holds colors already multiplied by alpha, from rendering over transparent black
+static void PremultipliedBlend(const ImDrawList *, const ImDrawCmd *)
+{
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+bool PanelCache::InputActive()
+{
+    // mouse movement over the panel is part of the key; anything else this frame means the panel may react
+    const ImGuiIO &io = ImGui::GetIO();
+    if (io.MouseWheel != 0 || io.MouseWheelH != 0 || !io.InputQueueCharacters.empty())
+        return true;
+    for (int b = 0; b < IM_ARRAYSIZE(io.MouseDown); b++)
+        if (io.MouseDown[b] || io.MouseReleased[b])
+            return true;
+    for (int k = ImGuiKey_NamedKey_BEGIN; k < ImGuiKey_NamedKey_END; k++)
+        if (ImGui::IsKeyDown(ImGuiKey(k)))
+            return true;
+    return ImGui::IsAnyItemActive() || ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId);
+}
+
+void PanelCache::SetEnabled(bool enable)
+{
+    enabled = enable;
+    if (!enabled)
+        target.reset();
+}
+
+bool PanelCache::Begin(const char *id, uint64_t contentRevision)
+{
+    const ImGuiIO &io = ImGui::GetIO();
+    const ImVec2 pos = ImGui::GetCursorScreenPos();
+    const ImVec2 size = ImGui::GetContentRegionAvail();
+    const ImVec2 end(pos.x + size.x, pos.y + size.y);
+    // only over the panel can the mouse change what it shows; moving it anywhere else keeps the capture
+    const bool hovered = ImGui::IsMousePosValid() && ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows) &&
+                         ImGui::IsMouseHoveringRect(pos, end, false);
+    const ImVec2 mouse = hovered ? io.MousePos : ImVec2(-1, -1);
+    uint64_t newKey = contentRevision;
+    for (float v : {pos.x, pos.y, size.x, size.y, mouse.x, mouse.y, ImGui::GetFontSize(), io.DisplayFramebufferScale.x})
+        newKey = Mix(newKey, v);
+
+    const double now = ImGui::GetTime();
+    const bool active = InputActive();
+    if (newKey != key || active || itemHovered)
+    {
+        key = newKey;
+        stableSince = now;
+    }
+    // released mid-frame, the pool hands it out again only next frame
+    if (target && (capturedKey != key || active))
+        target.reset();
+
+    if (enabled && target)
+    {
+        ImDrawList *list = ImGui::GetWindowDrawList();
+        list->AddCallback(PremultipliedBlend, nullptr);
+        list->AddImage((ImTextureID)(intptr_t)target->GetColor().GetHandle(), pos, end, ImVec2(0, 1), ImVec2(1, 0));
+        list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        // the space the child would take; the child itself is not submitted, so it keeps its scroll
+        ImGui::Dummy(size);
+        stats.cachedFrames++;
+        return false;
+    }
+
+    captureWanted = enabled && now - stableSince >= settleSeconds;
+    ImGui::BeginChild(id, size);
+    return true;
+}
+
+void PanelCache::End()
+{
+    ImDrawList *list = ImGui::GetWindowDrawList();
+    itemHovered = ImGui::IsWindowHovered() && ImGui::IsAnyItemHovered();
+    stats.liveFrames++;
+    stats.liveVertices = list->VtxBuffer.Size;
+    stats.liveIndices = list->IdxBuffer.Size;
+    pendingList = captureWanted && !itemHovered ? list : nullptr;
+    pendingPos = ImGui::GetWindowPos();
+    pendingSize = ImGui::GetWindowSize();
+    ImGui::EndChild();
+}
+
+void PanelCache::Capture()
+{
+    if (!pendingList)
+        return;
+    ImDrawList *list = pendingList;
+    pendingList = nullptr;
+
+    const ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+    const uvec2 pixels(uint32_t(pendingSize.x * scale.x + 0.5f), uint32_t(pendingSize.y * scale.y + 0.5f));
+    if (pixels.x == 0 || pixels.y == 0)
+        return;
+    Profiler::Scope scope("PanelCache::Capture");
+
+    // same size and position as on screen, so the capture maps back one texel per pixel
+    auto captured = RenderTargetPool::Shared().Acquire(pixels, eNonApplicable, GL_RGBA8, Nearest);
+    const GLfloat transparent[4] = {0, 0, 0, 0};
+    glClearNamedFramebufferfv(captured->GetFramebuffer(), GL_COLOR, 0, transparent);
+
+    ImDrawData data;
+    data.Valid = true;
+    data.AddDrawList(list);
+    data.DisplayPos = pendingPos;
+    data.DisplaySize = pendingSize;
+    data.FramebufferScale = scale;
+    captured->Bind();
+    ImGui_ImplOpenGL3_RenderDrawData(&data);
+    RenderTarget::Unbind();
+
+    target = std::move(captured);
+    capturedKey = key;
+    stats.captures++;
+}
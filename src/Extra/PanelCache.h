@@ -0,0 +1,59 @@
+#pragma once
+#include "RenderTargetPool.h"
+#include <cstdint>
+#include <memory>
+
+/// @brief Retained mode for a mostly static ImGui panel. The panel is submitted inside a child
+/// window; once its content revision, size, input state and the mouse position over it have not
+/// changed for settleSeconds, Capture() renders that child's draw list into a pooled render target.
+/// Until any of them changes, Begin() draws the capture as a single quad instead of the widgets;
+/// the mouse moving outside the panel leaves it in place.
+///
+///     if (cache.Begin("##Panel", window.GetRevision()))
+///     {
+///         window.Render();
+///         cache.End();
+///     }
+class PanelCache
+{
+public:
+    struct Stats
+    {
+        uint64_t liveFrames = 0;
+        uint64_t cachedFrames = 0;
+        uint64_t captures = 0;
+        int liveVertices = 0, liveIndices = 0; // the panel's own draw list on its last live frame
+    };
+
+    /// @brief true: submit the panel and call End(). false: the capture was drawn in its place.
+    /// `contentRevision` must change whenever the panel would look different without any input.
+    bool Begin(const char *id, uint64_t contentRevision);
+    void End();
+    /// @brief Renders a panel that asked for it this frame. After ImGui::Render() and before the
+    /// next NewFrame, while the frame's draw lists are still intact.
+    void Capture();
+    /// @brief Drops the capture, e.g. after a style change the revision does not cover.
+    void Invalidate() { target.reset(); }
+
+    void SetEnabled(bool enable);
+    bool IsEnabled() const { return enabled; }
+    void SetSettleSeconds(float seconds) { settleSeconds = seconds; }
+    const Stats &GetStats() const { return stats; }
+
+private:
+    static bool InputActive();
+
+    bool enabled = true;
+    float settleSeconds = 0.6f; // past ImGui's tooltip delay, so a capture never misses one
+    uint64_t key = 0, capturedKey = 0;
+    double stableSince = 0;
+    bool itemHovered = false; // on the last live frame, where a tooltip may be about to open
+    bool captureWanted = false;
+
+    // recorded by End() for Capture()
+    ImDrawList *pendingList = nullptr;
+    ImVec2 pendingPos, pendingSize;
+
+    std::shared_ptr<RenderTarget> target;
+    Stats stats;
+};
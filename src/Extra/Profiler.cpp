@@ -0,0 +1,275 @@
+#include "Profiler.h"
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+// queries are generated in blocks so a frame with many new scopes makes one call
+static constexpr GLsizei QueryBlock = 64;
+
+Profiler::Scope::Scope(const char *name, bool gpu)
+{
+    Profiler &profiler = Shared();
+    frame = profiler.CurrentFrame();
+    sample = profiler.BeginScope(name, gpu);
+}
+
+Profiler::Scope::~Scope()
+{
+    Profiler &profiler = Shared();
+    // a scope left open across EndFrame belongs to a frame that is already closed
+    if (sample >= 0 && frame == profiler.CurrentFrame())
+        profiler.EndScope(sample);
+}
+
+Profiler &Profiler::Shared()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now())
+{
+}
+
+Profiler::~Profiler()
+{
+    ReleaseQueries();
+}
+
+void Profiler::ReleaseQueries()
+{
+    if (!allQueries.empty())
+        glDeleteQueries(GLsizei(allQueries.size()), allQueries.data());
+    allQueries.clear();
+    freeQueries.clear();
+    inFlight.clear();
+    current.queries.clear();
+    current.frameBegin = current.frameEnd = 0;
+    gpuThisFrame = false;
+}
+
+double Profiler::NowMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+GLuint Profiler::AcquireQuery()
+{
+    if (freeQueries.empty())
+    {
+        GLuint block[QueryBlock];
+        glGenQueries(QueryBlock, block);
+        allQueries.insert(allQueries.end(), block, block + QueryBlock);
+        freeQueries.insert(freeQueries.end(), block, block + QueryBlock);
+    }
+    const GLuint query = freeQueries.back();
+    freeQueries.pop_back();
+    return query;
+}
+
+void Profiler::BeginFrame()
+{
+    if (!initialized)
+    {
+        // core since 3.3; the app asks for 3.2 by default
+        gpuTimers = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+        if (!gpuTimers)
+            fprintf(stderr, "[INFO] Profiler: no timer queries, recording CPU time only\n");
+        initialized = true;
+    }
+    Collect();
+    if (!enabled)
+        return;
+
+    // rather than wait on a GPU that is this far behind, time this frame on the CPU only
+    gpuThisFrame = gpuTimers && inFlight.size() < maxFramesInFlight;
+    if (gpuTimers && !gpuThisFrame)
+        gpuFramesSkipped++;
+    renderThread = std::this_thread::get_id();
+    frameStart = std::chrono::steady_clock::now();
+    current.frame.index = nextFrame++;
+    current.frame.cpuStartMs = NowMs();
+    current.frame.cpuMs = 0;
+    current.frame.gpuMs = -1;
+    current.frame.samples.clear();
+    current.queries.clear();
+    current.frameBegin = current.frameEnd = 0;
+    if (gpuThisFrame)
+    {
+        current.frameBegin = AcquireQuery();
+        glQueryCounter(current.frameBegin, GL_TIMESTAMP);
+    }
+    depth = 0;
+    inFrame = true;
+}
+
+void Profiler::EndFrame()
+{
+    if (!inFrame)
+        return;
+    inFrame = false;
+    current.frame.cpuMs = NowMs() - current.frame.cpuStartMs;
+    if (gpuThisFrame)
+    {
+        current.frameEnd = AcquireQuery();
+        glQueryCounter(current.frameEnd, GL_TIMESTAMP);
+    }
+    // CPU only frames queue up too, so the history stays in frame order
+    inFlight.push_back(std::move(current));
+    current = Pending();
+}
+
+int32_t Profiler::BeginScope(const char *name, bool gpu)
+{
+    if (!inFrame || std::this_thread::get_id() != renderThread)
+        return -1;
+    const double start = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    current.frame.samples.push_back({name, depth++, start, 0, -1, -1});
+    GLuint begin = 0;
+    if (gpu && gpuThisFrame)
+    {
+        begin = AcquireQuery();
+        glQueryCounter(begin, GL_TIMESTAMP);
+    }
+    current.queries.push_back(begin);
+    current.queries.push_back(0);
+    return int32_t(current.frame.samples.size() - 1);
+}
+
+void Profiler::EndScope(int32_t sample)
+{
+    Sample &s = current.frame.samples[sample];
+    s.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count() - s.cpuStartMs;
+    if (current.queries[sample * 2])
+    {
+        const GLuint end = AcquireQuery();
+        glQueryCounter(end, GL_TIMESTAMP);
+        current.queries[sample * 2 + 1] = end;
+    }
+    depth = s.depth;
+}
+
+void Profiler::Collect()
+{
+    // timestamps retire in order, so once a frame's last query is available all of its queries are
+    while (!inFlight.empty())
+    {
+        Pending &pending = inFlight.front();
+        if (!pending.frameEnd)
+        {
+            Publish(std::move(pending.frame));
+            inFlight.pop_front();
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(pending.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 frameBegin = 0, frameEnd = 0;
+        glGetQueryObjectui64v(pending.frameBegin, GL_QUERY_RESULT, &frameBegin);
+        glGetQueryObjectui64v(pending.frameEnd, GL_QUERY_RESULT, &frameEnd);
+        pending.frame.gpuMs = double(frameEnd - frameBegin) * 1e-6;
+        freeQueries.push_back(pending.frameBegin);
+        freeQueries.push_back(pending.frameEnd);
+        for (size_t i = 0; i < pending.frame.samples.size(); i++)
+        {
+            const GLuint begin = pending.queries[i * 2], end = pending.queries[i * 2 + 1];
+            if (begin)
+                freeQueries.push_back(begin);
+            // a scope still open at EndFrame has no end query
+            if (!begin || !end)
+                continue;
+            freeQueries.push_back(end);
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(begin, GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(end, GL_QUERY_RESULT, &t1);
+            pending.frame.samples[i].gpuStartMs = double(t0 - frameBegin) * 1e-6;
+            pending.frame.samples[i].gpuMs = double(t1 - t0) * 1e-6;
+        }
+        Publish(std::move(pending.frame));
+        inFlight.pop_front();
+    }
+}
+
+void Profiler::Publish(Frame &&completed)
+{
+    history.push_back(std::move(completed));
+    while (history.size() > historySize)
+        history.pop_front();
+}
+
+void Profiler::SetHistorySize(size_t frames)
+{
+    historySize = frames ? frames : 1;
+    while (history.size() > historySize)
+        history.pop_front();
+}
+
+Profiler::Stats Profiler::GetStats() const
+{
+    Stats stats;
+    stats.queriesAllocated = allQueries.size();
+    stats.framesInFlight = inFlight.size();
+    stats.gpuFramesSkipped = gpuFramesSkipped;
+    return stats;
+}
+
+bool Profiler::ExportChromeTrace(const std::string &path) const
+{
+    using json = nlohmann::json;
+    json events = json::array();
+    events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 0}, {"args", {{"name", "CPU"}}}});
+    events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 1}, {"args", {{"name", "GPU"}}}});
+    for (const Frame &frame : history)
+    {
+        // microseconds; the GPU track has its own clock, so each frame is lined up with its CPU start
+        const double base = frame.cpuStartMs * 1000.0;
+        events.push_back({{"name", "Frame"}, {"ph", "X"}, {"pid", 0}, {"tid", 0}, {"ts", base},
+                          {"dur", frame.cpuMs * 1000.0}, {"args", {{"frame", frame.index}}}});
+        if (frame.gpuMs >= 0)
+            events.push_back({{"name", "Frame"}, {"ph", "X"}, {"pid", 0}, {"tid", 1}, {"ts", base},
+                              {"dur", frame.gpuMs * 1000.0}, {"args", {{"frame", frame.index}}}});
+        for (const Sample &s : frame.samples)
+        {
+            events.push_back({{"name", s.name}, {"ph", "X"}, {"pid", 0}, {"tid", 0},
+                              {"ts", base + s.cpuStartMs * 1000.0}, {"dur", s.cpuMs * 1000.0}});
+            if (s.gpuMs >= 0)
+                events.push_back({{"name", s.name}, {"ph", "X"}, {"pid", 0}, {"tid", 1},
+                                  {"ts", base + s.gpuStartMs * 1000.0}, {"dur", s.gpuMs * 1000.0}});
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        fprintf(stderr, "[ERROR] Profiler: could not open %s\n", path.c_str());
+        return false;
+    }
+    out << json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump();
+    return bool(out);
+}
+
+bool Profiler::ExportCsv(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        fprintf(stderr, "[ERROR] Profiler: could not open %s\n", path.c_str());
+        return false;
+    }
+    out << "frame,name,depth,cpu_start_ms,cpu_ms,gpu_start_ms,gpu_ms\n";
+    char line[256];
+    for (const Frame &frame : history)
+    {
+        snprintf(line, sizeof(line), "%llu,Frame,0,0,%.6f,0,%.6f\n", (unsigned long long)frame.index, frame.cpuMs, frame.gpuMs);
+        out << line;
+        for (const Sample &s : frame.samples)
+        {
+            snprintf(line, sizeof(line), "%llu,\"%s\",%u,%.6f,%.6f,%.6f,%.6f\n", (unsigned long long)frame.index, s.name,
+                     s.depth + 1, s.cpuStartMs, s.cpuMs, s.gpuStartMs, s.gpuMs);
+            out << line;
+        }
+    }
+    return bool(out);
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "lib_include.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Frame profiler for the render thread. Named scopes record CPU time and, with
+/// timer queries, GPU time from a pair of GL_TIMESTAMP queries taken from a pool that is reused
+/// across frames. Query results are collected a few frames later once the GPU has caught up,
+/// so nothing waits on them. Scopes only record between BeginFrame and EndFrame and on the thread
+/// that called BeginFrame; elsewhere they cost a branch.
+class Profiler
+{
+public:
+    struct Sample
+    {
+        const char *name; // must outlive the profiler, string literals in practice
+        uint32_t depth;
+        double cpuStartMs, cpuMs; // from the frame's CPU start
+        double gpuStartMs, gpuMs; // from the frame's GPU start, negative when not timed
+    };
+
+    struct Frame
+    {
+        uint64_t index = 0;
+        double cpuStartMs = 0; // since the profiler was created
+        double cpuMs = 0, gpuMs = -1;
+        std::vector<Sample> samples; // in begin order, parents before children
+    };
+
+    struct Stats
+    {
+        size_t queriesAllocated = 0;
+        size_t framesInFlight = 0;   // ended but waiting on query results
+        uint64_t gpuFramesSkipped = 0; // recorded CPU only because maxFramesInFlight were pending
+    };
+
+    /// @brief Ends its scope on destruction. Name must be a string literal or otherwise outlive the profiler.
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name, bool gpu = true);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        uint64_t frame;
+        int32_t sample;
+    };
+
+    /// @brief Profiler used by the instrumented render path.
+    static Profiler &Shared();
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    /// @brief Needs a current context. Collects every finished frame, then opens the next one.
+    void BeginFrame();
+    void EndFrame();
+
+    /// @brief A disabled profiler records nothing; frames still pending keep being collected.
+    void SetEnabled(bool enabled) { this->enabled = enabled; }
+    bool IsEnabled() const { return enabled; }
+    /// @brief Frames may wait this many frames for their queries before new ones go CPU only.
+    void SetMaxFramesInFlight(size_t frames) { maxFramesInFlight = frames ? frames : 1; }
+    void SetHistorySize(size_t frames);
+    bool HasGpuTimers() const { return gpuTimers; }
+
+    /// @brief Completed frames, oldest first.
+    const std::deque<Frame> &GetHistory() const { return history; }
+    Stats GetStats() const;
+    void ClearHistory() { history.clear(); }
+
+    /// @brief Writes the history in the Chrome trace event format (chrome://tracing, ui.perfetto.dev),
+    /// CPU and GPU on separate tracks. GPU times are placed relative to each frame's CPU start.
+    bool ExportChromeTrace(const std::string &path) const;
+    /// @brief One row per sample: frame, name, depth, cpu start/duration, gpu start/duration in ms.
+    bool ExportCsv(const std::string &path) const;
+
+    int32_t BeginScope(const char *name, bool gpu);
+    void EndScope(int32_t sample);
+    uint64_t CurrentFrame() const { return inFrame ? current.frame.index : 0; }
+    /// @brief Deletes the query objects; call while the context is still current. Pending GPU times are lost.
+    void ReleaseQueries();
+
+private:
+    struct Pending
+    {
+        Frame frame;
+        GLuint frameBegin = 0, frameEnd = 0;
+        std::vector<GLuint> queries; // begin, end per sample; 0 when the sample has no GPU time
+    };
+
+    bool enabled = true;
+    bool inFrame = false;
+    bool gpuTimers = false;
+    bool gpuThisFrame = false;
+    bool initialized = false;
+    std::thread::id renderThread;
+    std::chrono::steady_clock::time_point epoch;
+    std::chrono::steady_clock::time_point frameStart;
+    uint32_t depth = 0;
+    uint64_t nextFrame = 1;
+    uint64_t gpuFramesSkipped = 0;
+    size_t maxFramesInFlight = 4;
+    size_t historySize = 300;
+
+    Pending current;
+    std::deque<Pending> inFlight;
+    std::deque<Frame> history;
+    std::vector<GLuint> freeQueries;
+    std::vector<GLuint> allQueries;
+
+    double NowMs() const;
+    GLuint AcquireQuery();
+    void Collect();
+    void Publish(Frame &&completed);
+};
@@ -1,128 +1,543 @@
 #include "Program.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
-Program::Program(const decltype(files) &_files, bool is_this_source) : files(_files)
+namespace fs = std::filesystem;
+
+static const fs::path ProgramCacheDir = "Cache/Programs";
+static constexpr char ProgramCacheMagic[4] = {'I', 'P', 'R', 'G'};
+
+struct ProgramCacheHeader
+{
+    char magic[4];
+    uint32_t binaryFormat;
+    uint64_t length;
+};
+
+static uint64_t HashString(uint64_t h, std::string_view s)
+{
+    for (unsigned char c : s)
+        h = (h ^ c) * 0x100000001b3ull;
+    return h;
+}
+
+static std::string ReadSource(const std::string &file_name)
+{
+    std::ifstream file(file_name);
+    if (!file.is_open())
+    {
+        throw std::runtime_error(file_name + " does not exist");
+    }
+    return (std::stringstream() << file.rdbuf()).str();
+}
+
+static GLuint CompileStage(Shader_Stage stage, const std::string &file_content)
+{
+    const char *file_content_str = file_content.c_str();
+
+    GLuint module = glCreateShader(stage);
+    glShaderSource(module, 1, &file_content_str, 0);
+    glCompileShader(module);
+    return module;
+}
+
+static void PrintShaderLog(GLuint module, Shader_Stage stage)
+{
+    GLint info_log_length = 0;
+    glGetShaderiv(module, GL_INFO_LOG_LENGTH, &info_log_length);
+    if (info_log_length > 0)
+    {
+        std::string log(info_log_length + 1, 0);
+        glGetShaderInfoLog(module, log.size(), 0, log.data());
+        std::cout << "Shader Module Log [" + std::to_string(stage) + "]: " << log << std::endl;
+    }
+}
+
+static void PrintProgramLog(GLuint program)
+{
+    GLint info_log_length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+    if (info_log_length > 0)
+    {
+        std::string log(info_log_length + 1, 0);
+        glGetProgramInfoLog(program, log.size(), 0, log.data());
+        std::cout << "Shader Program Log: " << log << std::endl;
+    }
+}
+
+static bool LinkSucceeded(GLuint program)
+{
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+Program::Program(const decltype(files) &_files, bool is_this_source) : files(_files), is_source(is_this_source)
 {
-    gl_program = glCreateProgram();
-    std::vector<GLuint> shader_modules(_files.size());
+    for (const auto &[stage, file_name] : files)
+        sources.push_back(is_source ? file_name : ReadSource(file_name));
+
+    const uint64_t key = CacheKey();
+    if (LoadBinary(key))
+    {
+        Reflect();
+        std::cout << "Shader Program loaded from cache\n";
+        return;
+    }
+
+    std::vector<GLuint> shader_modules(files.size());
     for (int i = 0; i < files.size(); i++)
     {
-        const Shader_Stage stage = files[i].first;
-        const std::string &file_name = files[i].second;
-        std::string file_content;
-        if (is_this_source)
+        shader_modules[i] = CompileStage(files[i].first, sources[i]);
+        PrintShaderLog(shader_modules[i], files[i].first);
+    }
+    gl_program = Link(shader_modules);
+    const bool linked = LinkSucceeded(gl_program);
+    if (linked)
+    {
+        // validation only reports on the current GL state, but catches sampler/binding mismatches early
+        glValidateProgram(gl_program);
+        GLint valid = GL_FALSE;
+        glGetProgramiv(gl_program, GL_VALIDATE_STATUS, &valid);
+        if (!valid)
         {
-            file_content = file_name;
+            std::cerr << "Shader Program failed to validate\n";
+            PrintProgramLog(gl_program);
         }
-        else
+        SaveBinary(key);
+    }
+    else
+    {
+        std::cerr << "Shader Program failed to link\n";
+        PrintProgramLog(gl_program);
+    }
+    for (const auto &module : shader_modules)
+        glDeleteShader(module);
+
+    Reflect();
+    if (linked)
+        std::cout << "Shader Program compiled\n";
+}
+
+GLuint Program::Link(const std::vector<GLuint> &modules)
+{
+    GLuint program = glCreateProgram();
+    if (binaryCacheEnabled)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    for (GLuint module : modules)
+        glAttachShader(program, module);
+    glLinkProgram(program);
+    for (GLuint module : modules)
+        glDetachShader(program, module);
+    return program;
+}
+
+uint64_t Program::CacheKey() const
+{
+    // a driver update invalidates binaries, so the driver strings are part of the key
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const GLubyte *value = glGetString(name);
+        h = HashString(h, value ? reinterpret_cast<const char *>(value) : "");
+    }
+    for (int i = 0; i < files.size(); i++)
+    {
+        h = HashString(h, std::to_string(files[i].first));
+        h = HashString(h, sources[i]);
+    }
+    return h;
+}
+
+static fs::path CachePathFor(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return ProgramCacheDir / name;
+}
+
+bool Program::LoadBinary(uint64_t key)
+{
+    if (!binaryCacheEnabled)
+        return false;
+    const fs::path path = CachePathFor(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    // the length field comes from disk; a truncated or corrupt file must not size the allocation
+    std::error_code ec;
+    const uintmax_t fileSize = fs::file_size(path, ec);
+    ProgramCacheHeader header{};
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    const bool headerOk = in && !ec && memcmp(header.magic, ProgramCacheMagic, 4) == 0 && header.length > 0 &&
+                          header.length == fileSize - sizeof(header);
+    std::vector<char> binary(headerOk ? header.length : 0);
+    if (headerOk)
+        in.read(binary.data(), binary.size());
+    if (!in || binary.empty())
+    {
+        fprintf(stderr, "[WARN] Ignoring unreadable program cache %s\n", path.string().c_str());
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), GLsizei(binary.size()));
+    if (!LinkSucceeded(program))
+    {
+        // the driver rejected it (format no longer supported); rebuild from source
+        glDeleteProgram(program);
+        fs::remove(path, ec);
+        return false;
+    }
+    gl_program = program;
+    return true;
+}
+
+void Program::SaveBinary(uint64_t key) const
+{
+    if (!binaryCacheEnabled)
+        return;
+    GLint formats = 0, length = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetProgramiv(gl_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (formats == 0 || length <= 0)
+        return;
+
+    ProgramCacheHeader header{};
+    memcpy(header.magic, ProgramCacheMagic, 4);
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(gl_program, length, &length, &format, binary.data());
+    header.binaryFormat = format;
+    header.length = length;
+
+    const fs::path path = CachePathFor(key);
+    const fs::path temp = path.string() + ".tmp";
+    std::error_code ec;
+    fs::create_directories(ProgramCacheDir, ec);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(binary.data(), length);
+        if (!out)
         {
-            std::ifstream file(file_name);
-            if (!file.is_open())
-            {
-                throw std::runtime_error(file_name + " does not exist");
-            }
-            file_content = (std::stringstream() << file.rdbuf()).str();
-            file.close();
+            fprintf(stderr, "[WARN] Could not write program cache %s\n", path.string().c_str());
+            return;
         }
+    }
+    fs::rename(temp, path, ec);
+}
 
-        const char *file_content_str = file_content.c_str();
+void Program::EnableHotReload(bool enable)
+{
+    if (is_source)
+    {
+        fprintf(stderr, "[WARN] Hot reload needs file based shaders\n");
+        return;
+    }
+    hotReload = enable;
+    stageTimes.assign(files.size(), {});
+    std::error_code ec;
+    for (int i = 0; i < files.size(); i++)
+        stageTimes[i] = fs::last_write_time(files[i].second, ec);
+    if (enable && GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    if (!enable)
+        DiscardPending();
+}
+
+bool Program::Update()
+{
+    if (!hotReload)
+        return false;
+    if (pendingProgram)
+        return FinishReload();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < std::chrono::milliseconds(500))
+        return false;
+    lastPoll = now;
 
-        GLuint module = glCreateShader(stage);
-        glShaderSource(module, 1, &file_content_str, 0);
-        glCompileShader(module);
-        GLint info_log_length = 0;
-        glGetShaderiv(module, GL_INFO_LOG_LENGTH, &info_log_length);
-        if (info_log_length > 0)
+    // the new times are kept only once every changed stage has been read, so a failed read
+    // leaves all of them to be picked up again on the next poll
+    std::vector<int> changed;
+    std::vector<fs::file_time_type> times = stageTimes;
+    std::error_code ec;
+    for (int i = 0; i < files.size(); i++)
+    {
+        const auto time = fs::last_write_time(files[i].second, ec);
+        if (!ec && time != stageTimes[i])
         {
-            std::string log(info_log_length + 1, 0);
-            glGetShaderInfoLog(module, log.size(), 0, log.data());
-            std::cout << "Shader Module Log [" + std::to_string(stage) + "]: " << log << std::endl;
+            times[i] = time;
+            changed.push_back(i);
         }
-        glAttachShader(gl_program, module);
-        shader_modules[i] = module;
-    }
-    for (int i = 0; i < 2; i++)
-    {
-        if (i == 0)
-            glLinkProgram(gl_program);
-        else
-            glValidateProgram(gl_program);
-
-        GLint success;
-        glGetProgramiv(gl_program, GL_LINK_STATUS, &success);
-        if (!success)
-            std::cerr << "Shader Program failed to link\n";
-        GLint info_log_length = 0;
-        glGetProgramiv(gl_program, GL_INFO_LOG_LENGTH, &info_log_length);
-        if (info_log_length > 0)
+    }
+    if (changed.empty())
+        return false;
+
+    // unchanged stages reuse the shader objects kept from the last successful reload
+    retainedShaders.resize(files.size(), 0);
+    pendingShaders.assign(files.size(), 0);
+    pendingSources = sources;
+    for (int i = 0; i < files.size(); i++)
+    {
+        const bool stageChanged = std::find(changed.begin(), changed.end(), i) != changed.end();
+        if (!stageChanged && retainedShaders[i])
+            continue;
+        try
+        {
+            pendingSources[i] = ReadSource(files[i].second);
+        }
+        catch (const std::exception &e)
         {
-            std::string log(info_log_length + 1, 0);
-            glGetProgramInfoLog(gl_program, log.size(), 0, log.data());
-            std::cout << "Shader Program Log: " << log << std::endl;
+            // editors often replace the file in two steps; try again on the next poll
+            fprintf(stderr, "[WARN] %s\n", e.what());
+            DiscardPending();
+            return false;
         }
+        pendingShaders[i] = CompileStage(files[i].first, pendingSources[i]);
     }
-    for (const auto &module : shader_modules)
+    stageTimes = std::move(times);
+
+    std::vector<GLuint> modules(files.size());
+    for (int i = 0; i < files.size(); i++)
+        modules[i] = pendingShaders[i] ? pendingShaders[i] : retainedShaders[i];
+    pendingProgram = Link(modules);
+    return FinishReload();
+}
+
+bool Program::FinishReload()
+{
+    // with KHR_parallel_shader_compile the driver compiles and links on its own threads;
+    // querying the link status would block until it is done, so poll completion first
+    if (GLEW_KHR_parallel_shader_compile)
     {
-        glDetachShader(gl_program, module);
-        glDeleteShader(module);
+        GLint done = GL_FALSE;
+        glGetProgramiv(pendingProgram, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+            return false;
+    }
+
+    if (!LinkSucceeded(pendingProgram))
+    {
+        std::cerr << "Shader Program reload failed, keeping the previous program\n";
+        for (int i = 0; i < files.size(); i++)
+            if (pendingShaders[i])
+                PrintShaderLog(pendingShaders[i], files[i].first);
+        PrintProgramLog(pendingProgram);
+        DiscardPending();
+        return false;
+    }
+
+    // carry the block bindings over; plain uniform values are per program and must be pushed again
+    std::vector<std::pair<std::string, GLuint>> bindings;
+    for (const auto &[name, block] : uniformBlocks)
+        bindings.emplace_back(name, block.binding);
+
+    const GLuint old = gl_program;
+    gl_program = pendingProgram;
+    pendingProgram = 0;
+    sources = std::move(pendingSources);
+    for (int i = 0; i < files.size(); i++)
+    {
+        if (!pendingShaders[i])
+            continue;
+        if (retainedShaders[i])
+            glDeleteShader(retainedShaders[i]);
+        retainedShaders[i] = pendingShaders[i];
+    }
+    pendingShaders.clear();
+
+    Reflect();
+    for (const auto &[name, binding] : bindings)
+    {
+        auto it = uniformBlocks.find(name);
+        if (it != uniformBlocks.end() && it->second.binding != binding)
+        {
+            glUniformBlockBinding(gl_program, it->second.index, binding);
+            it->second.binding = binding;
+        }
+    }
+    if (boundProgram == old)
+    {
+        glUseProgram(gl_program);
+        boundProgram = gl_program;
+    }
+    glDeleteProgram(old);
+    SaveBinary(CacheKey());
+    std::cout << "Shader Program reloaded\n";
+    return true;
+}
+
+void Program::DiscardPending()
+{
+    if (pendingProgram)
+        glDeleteProgram(pendingProgram);
+    pendingProgram = 0;
+    for (GLuint module : pendingShaders)
+        if (module)
+            glDeleteShader(module);
+    pendingShaders.clear();
+    pendingSources.clear();
+    if (!hotReload)
+    {
+        for (GLuint module : retainedShaders)
+            if (module)
+                glDeleteShader(module);
+        retainedShaders.clear();
     }
+}
+
+Program::~Program()
+{
+    hotReload = false;
+    DiscardPending();
+    if (boundProgram == gl_program)
+        Unuse();
+    glDeleteProgram(gl_program);
+}
+
+void Program::Reflect()
+{
+    uniforms.clear();
+    uniformBlocks.clear();
+    reportedMissing.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(gl_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(gl_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(maxLength + 1, 0);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        UniformInfo info{};
+        glGetActiveUniform(gl_program, i, name.size(), &length, &info.size, &info.type, name.data());
+        // block members have no location and are set through the block's buffer
+        info.location = glGetUniformLocation(gl_program, name.c_str());
+        if (info.location < 0)
+            continue;
+        std::string key(name.data(), length);
+        // arrays are reported as "name[0]"; make "name" find them too
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+            uniforms.emplace(key.substr(0, key.size() - 3), info);
+        uniforms.emplace(std::move(key), info);
+    }
+
+    count = maxLength = 0;
+    glGetProgramiv(gl_program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(gl_program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.assign(maxLength + 1, 0);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(gl_program, i, name.size(), &length, name.data());
+        UniformBlockInfo info{GLuint(i), 0, 0};
+        GLint binding = 0;
+        glGetActiveUniformBlockiv(gl_program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+        glGetActiveUniformBlockiv(gl_program, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+        info.binding = binding;
+        uniformBlocks.emplace(std::string(name.data(), length), info);
+    }
+}
+
+bool Program::IsLinked() const
+{
+    return LinkSucceeded(gl_program);
+}
 
-    std::cout << "Shader Program compiled\n";
+void Program::Use() const
+{
+    if (boundProgram == gl_program)
+        return;
+    glUseProgram(gl_program);
+    boundProgram = gl_program;
+}
+
+void Program::Unuse() const
+{
+    if (boundProgram == 0)
+        return;
+    glUseProgram(0);
+    boundProgram = 0;
+}
+
+const Program::UniformInfo *Program::FindUniform(std::string_view name) const
+{
+    auto it = uniforms.find(name);
+    return it == uniforms.end() ? nullptr : &it->second;
+}
+
+const Program::UniformBlockInfo *Program::FindUniformBlock(std::string_view name) const
+{
+    auto it = uniformBlocks.find(name);
+    return it == uniformBlocks.end() ? nullptr : &it->second;
+}
+
+void Program::BindUniformBlock(std::string_view name, GLuint binding)
+{
+    auto it = uniformBlocks.find(name);
+    if (it == uniformBlocks.end())
+    {
+        fprintf(stderr, "[WARN] Uniform block '%.*s' is not active in the program\n", int(name.size()), name.data());
+        return;
+    }
+    if (it->second.binding == binding)
+        return;
+    glUniformBlockBinding(gl_program, it->second.index, binding);
+    it->second.binding = binding;
+}
+
+GLint Program::FetchUniformLocation(std::string_view n)
+{
+    auto it = uniforms.find(n);
+    if (it != uniforms.end())
+        return it->second.location;
+    // optimized out or misspelled; GL ignores location -1, say so once
+    if (reportedMissing.emplace(n).second)
+        fprintf(stderr, "[WARN] Uniform '%.*s' is not active in the program\n", int(n.size()), n.data());
+    return -1;
 }
 template <>
-void Program::PushUniform<mat4>(const std::string &name, const mat4 &m)
+void Program::PushUniform<mat4>(std::string_view name, const mat4 &m)
 {
-    Use();
-    glUniformMatrix4fv(FetchUniformLocation(name), 1, GL_FALSE, &m[0][0]);
-    Unuse();
+    glProgramUniformMatrix4fv(gl_program, FetchUniformLocation(name), 1, GL_FALSE, &m[0][0]);
 }
 
 template <>
-void Program::PushUniform<vec3>(const std::string &name, const vec3 &v)
+void Program::PushUniform<vec3>(std::string_view name, const vec3 &v)
 {
-    Use();
-    glUniform3fv(FetchUniformLocation(name),1,&v.x);
-    Unuse();
+    glProgramUniform3fv(gl_program, FetchUniformLocation(name), 1, &v.x);
 }
 template <>
-void Program::PushUniform<vec4>(const std::string &name, const vec4 &v)
+void Program::PushUniform<vec4>(std::string_view name, const vec4 &v)
 {
-    Use();
-    glUniform4fv(FetchUniformLocation(name),1,&v.x);
-    Unuse();
+    glProgramUniform4fv(gl_program, FetchUniformLocation(name), 1, &v.x);
 }
 
 template <>
-void Program::PushUniform<float>(const std::string &name, const float &v)
+void Program::PushUniform<float>(std::string_view name, const float &v)
 {
-    Use();
-    glUniform1fv(FetchUniformLocation(name),1,&v);
-    Unuse();
+    glProgramUniform1fv(gl_program, FetchUniformLocation(name), 1, &v);
 }
 template <>
-void Program::PushUniform<int>(const std::string &name, const int &v)
+void Program::PushUniform<int>(std::string_view name, const int &v)
 {
-    Use();
-    glUniform1iv(FetchUniformLocation(name),1,&v);
-    Unuse();
+    glProgramUniform1iv(gl_program, FetchUniformLocation(name), 1, &v);
 }
 template <>
-void Program::PushUniform<uvec2>(const std::string &name, const uvec2 &v)
+void Program::PushUniform<uvec2>(std::string_view name, const uvec2 &v)
 {
-    Use();
-    glUniform2ui(FetchUniformLocation(name),v.x,v.y);
-    Unuse();
+    glProgramUniform2ui(gl_program, FetchUniformLocation(name), v.x, v.y);
 }
 template <>
-void Program::PushUniform<ivec2>(const std::string &name, const ivec2 &v)
+void Program::PushUniform<ivec2>(std::string_view name, const ivec2 &v)
 {
-    Use();
-    glUniform2i(FetchUniformLocation(name),v.x,v.y);
-    Unuse();
+    glProgramUniform2i(gl_program, FetchUniformLocation(name), v.x, v.y);
 }
 template <>
-void Program::PushUniform<bool>(const std::string &name, const bool &v)
+void Program::PushUniform<bool>(std::string_view name, const bool &v)
 {
-    Use();
-    glUniform1i(FetchUniformLocation(name), static_cast<GLint>(v));
-    Unuse();
+    glProgramUniform1i(gl_program, FetchUniformLocation(name), static_cast<GLint>(v));
 }
\ No newline at end of file
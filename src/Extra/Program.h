@@ -1,9 +1,14 @@
 #pragma once
 #include "../lib_include.h"
+#include <chrono>
+#include <filesystem>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 enum Shader_Stage : GLenum
@@ -15,20 +20,90 @@ enum Shader_Stage : GLenum
 };
 class Program
 {
+public:
+    struct UniformInfo
+    {
+        GLint location;
+        GLenum type;
+        GLint size; // array length, 1 for plain uniforms
+    };
+    struct UniformBlockInfo
+    {
+        GLuint index;
+        GLint dataSize; // bytes, std140 layout
+        GLuint binding;
+    };
+
+private:
+    // lets find() take a string_view or literal without building a std::string
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+    template <typename T>
+    using NameMap = std::unordered_map<std::string, T, NameHash, std::equal_to<>>;
+
     GLuint gl_program = -1;
 
     std::vector<std::pair<Shader_Stage, std::string>> files;
+    bool is_source = false;
+    std::vector<std::string> sources; // what gl_program was built from, one per stage
+    NameMap<UniformInfo> uniforms;
+    NameMap<UniformBlockInfo> uniformBlocks;
+    std::unordered_set<std::string> reportedMissing;
+
+    // glUseProgram is skipped when this already matches; one GL context per process
+    static inline GLuint boundProgram = 0;
+
+    // hot reload: polled file times, shaders kept for unchanged stages, and a link in flight
+    bool hotReload = false;
+    std::chrono::steady_clock::time_point lastPoll;
+    std::vector<std::filesystem::file_time_type> stageTimes;
+    std::vector<GLuint> retainedShaders;
+    std::vector<GLuint> pendingShaders;
+    std::vector<std::string> pendingSources;
+    GLuint pendingProgram = 0;
+
+    void Reflect();
+    GLuint Link(const std::vector<GLuint> &modules);
+    uint64_t CacheKey() const;
+    bool LoadBinary(uint64_t key);
+    void SaveBinary(uint64_t key) const;
+    bool FinishReload();
+    void DiscardPending();
 
 public:
     Program(const decltype(files) &_files, bool is_this_source = false);
+    ~Program();
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+
+    /// @brief Uploads through glProgramUniform*, so the program does not have to be bound.
     template <typename T>
-    void PushUniform(const std::string &, const T &);
-    void Use() const { glUseProgram(gl_program); }
-    void Unuse() const { glUseProgram(0); }
+    void PushUniform(std::string_view, const T &);
+    void Use() const;
+    void Unuse() const;
+    /// @brief Linked programs are cached in Cache/Programs/, keyed by source and driver; on by default.
+    static inline bool binaryCacheEnabled = true;
+
+    /// @brief Watch the shader files (file based programs only) and rebuild when they change.
+    void EnableHotReload(bool enable = true);
+    /// @brief Call once per frame with hot reload on. Polls the files, finishes a pending link and
+    /// swaps it in only if it succeeded. Returns true on a swap; uniform values must be pushed again.
+    bool Update();
+
+    /// @brief For code that calls glUseProgram itself, so the next Use/Unuse is not skipped.
+    static void InvalidateBinding() { boundProgram = -1; }
+
+    GLuint GetHandle() const { return gl_program; }
+    /// @brief False when compiling or linking failed; the handle is then unusable.
+    bool IsLinked() const;
+    const UniformInfo *FindUniform(std::string_view name) const;
+    const UniformBlockInfo *FindUniformBlock(std::string_view name) const;
+    /// @brief Points the named block at a binding point a UniformBuffer is bound to.
+    void BindUniformBlock(std::string_view name, GLuint binding);
 
 private:
-    GLuint FetchUniformLocation(const std::string &n)
-    {
-        return glGetUniformLocation(gl_program, n.c_str());
-    }
+    GLint FetchUniformLocation(std::string_view n);
 };
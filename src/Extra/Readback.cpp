@@ -0,0 +1,202 @@
+#include "Readback.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct StagingBuffer
+    {
+        GLuint buffer = 0;
+        void *mapped = nullptr;
+        size_t capacity = 0;
+    };
+
+    // readbacks are issued every frame, so staging buffers are kept instead of reallocated
+    constexpr size_t MaxFreeStaging = 16;
+    std::vector<StagingBuffer> freeStaging;
+
+    StagingBuffer AcquireStaging(size_t size)
+    {
+        size_t best = freeStaging.size();
+        for (size_t i = 0; i < freeStaging.size(); i++)
+            if (freeStaging[i].capacity >= size && (best == freeStaging.size() || freeStaging[i].capacity < freeStaging[best].capacity))
+                best = i;
+        if (best != freeStaging.size())
+        {
+            StagingBuffer staging = freeStaging[best];
+            freeStaging.erase(freeStaging.begin() + best);
+            return staging;
+        }
+
+        // power of two sizes so buffers fit the next request of a similar size
+        StagingBuffer staging;
+        staging.capacity = std::bit_ceil(std::max<size_t>(size, 4096));
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &staging.buffer);
+        glNamedBufferStorage(staging.buffer, staging.capacity, nullptr, flags);
+        staging.mapped = glMapNamedBufferRange(staging.buffer, 0, staging.capacity, flags);
+        return staging;
+    }
+
+    void DeleteStaging(StagingBuffer &staging)
+    {
+        glUnmapNamedBuffer(staging.buffer);
+        glDeleteBuffers(1, &staging.buffer);
+    }
+
+    void ReturnStaging(StagingBuffer staging)
+    {
+        if (freeStaging.size() < MaxFreeStaging)
+            freeStaging.push_back(staging);
+        else
+            DeleteStaging(staging);
+    }
+
+    size_t ComponentsOf(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_RED:
+        case GL_DEPTH_COMPONENT:
+            return 1;
+        case GL_RG:
+            return 2;
+        case GL_RGB:
+        case GL_BGR:
+            return 3;
+        default:
+            return 4;
+        }
+    }
+
+    size_t ComponentBytes(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            return 1;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        default:
+            return 4;
+        }
+    }
+}
+
+struct Readback::Slot
+{
+    StagingBuffer staging;
+    size_t size = 0;
+    GLsync fence = nullptr;
+    bool signaled = false;
+
+    ~Slot()
+    {
+        if (fence)
+            glDeleteSync(fence);
+        ReturnStaging(staging);
+    }
+};
+
+Readback Readback::Begin(size_t size)
+{
+    Readback readback;
+    readback.slot = std::make_shared<Slot>();
+    readback.slot->staging = AcquireStaging(size);
+    readback.slot->size = size;
+    return readback;
+}
+
+void Readback::End()
+{
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+Readback Readback::FromBuffer(GLuint buffer, size_t offset, size_t size)
+{
+    Readback readback = Begin(size);
+    glCopyNamedBufferSubData(buffer, readback.slot->staging.buffer, offset, 0, size);
+    readback.End();
+    return readback;
+}
+
+Readback Readback::FromTexture(GLuint texture, GLint level, GLenum format, GLenum type, uvec2 size)
+{
+    const size_t bytes = size_t(size.x) * size.y * ComponentsOf(format) * ComponentBytes(type);
+    Readback readback = Begin(bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.slot->staging.buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(texture, level, format, type, GLsizei(bytes), nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.End();
+    return readback;
+}
+
+bool Readback::Ready() const
+{
+    if (!slot)
+        return false;
+    if (slot->signaled)
+        return true;
+    // the flush bit makes sure the fence reaches the GPU even if nothing else is submitted
+    const GLenum status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    if (status == GL_WAIT_FAILED)
+        fprintf(stderr, "[ERROR] Readback fence wait failed\n");
+    glDeleteSync(slot->fence);
+    slot->fence = nullptr;
+    slot->signaled = true;
+    return true;
+}
+
+const void *Readback::Wait() const
+{
+    if (!slot)
+        return nullptr;
+    while (!slot->signaled)
+    {
+        const GLenum status = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        if (status == GL_TIMEOUT_EXPIRED)
+            continue;
+        if (status == GL_WAIT_FAILED)
+            fprintf(stderr, "[ERROR] Readback fence wait failed\n");
+        glDeleteSync(slot->fence);
+        slot->fence = nullptr;
+        slot->signaled = true;
+    }
+    return slot->staging.mapped;
+}
+
+const void *Readback::Data() const
+{
+    return Ready() ? slot->staging.mapped : nullptr;
+}
+
+size_t Readback::Size() const
+{
+    return slot ? slot->size : 0;
+}
+
+bool Readback::CopyTo(void *dest) const
+{
+    const void *data = Data();
+    if (!data)
+        return false;
+    memcpy(dest, data, slot->size);
+    return true;
+}
+
+void Readback::ReleaseStaging()
+{
+    for (auto &staging : freeStaging)
+        DeleteStaging(staging);
+    freeStaging.clear();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../lib_include.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+
+/// @brief A GPU to CPU copy in flight. The copy lands in a persistently mapped staging buffer
+/// behind a fence, so issuing it never stalls; poll Ready() on later frames and read Data() once
+/// it returns true. Copyable; the staging buffer is recycled when the last copy goes away,
+/// which must happen on the GL thread.
+class Readback
+{
+public:
+    Readback() = default;
+
+    /// @brief Copies `size` bytes of a buffer object starting at `offset`.
+    static Readback FromBuffer(GLuint buffer, size_t offset, size_t size);
+    /// @brief Packs mip level `level` of a texture as format/type, tightly (no row padding).
+    static Readback FromTexture(GLuint texture, GLint level, GLenum format, GLenum type, uvec2 size);
+
+    bool Valid() const { return slot != nullptr; }
+    /// @brief Non-blocking fence poll.
+    bool Ready() const;
+    /// @brief Blocks until the copy has landed; the fallback for callers that cannot wait a frame.
+    const void *Wait() const;
+    /// @brief Null until Ready().
+    const void *Data() const;
+    size_t Size() const;
+
+    template <typename T>
+    std::span<const T> As() const
+    {
+        const void *data = Data();
+        return data ? std::span<const T>(static_cast<const T *>(data), Size() / sizeof(T)) : std::span<const T>();
+    }
+    /// @brief Copies the result into `dest` when ready; false if it is still in flight.
+    bool CopyTo(void *dest) const;
+
+    /// @brief Frees staging buffers not held by any readback.
+    static void ReleaseStaging();
+
+private:
+    struct Slot;
+    std::shared_ptr<Slot> slot;
+
+    static Readback Begin(size_t size);
+    void End();
+};
@@ -0,0 +1,275 @@
+#include "RenderTargetPool.h"
+#include "TexturePool.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct TargetKey
+    {
+        uint32_t width, height;
+        GLenum internalFormat, depthFormat;
+        int pixelFormat;
+        bool operator==(const TargetKey &) const = default;
+    };
+    struct TargetKeyHash
+    {
+        size_t operator()(const TargetKey &k) const
+        {
+            uint64_t h = (uint64_t(k.width) << 32 | k.height) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t(k.internalFormat) << 8 ^ uint64_t(uint32_t(k.pixelFormat))) * 0xBF58476D1CE4E5B9ull;
+            h ^= uint64_t(k.depthFormat) * 0x94D049BB133111EBull;
+            return size_t(h ^ (h >> 31));
+        }
+    };
+    struct FreeTarget
+    {
+        RenderTarget *target;
+        uint64_t releasedFrame;
+    };
+}
+
+RenderTarget::RenderTarget(uvec2 _size, PixelFormat pixelFormat, GLenum internalFormat, GLenum depthFormat, TextureFilter filter)
+    : color(std::make_unique<Texture>()), size(_size)
+{
+    color->SetFilter(filter);
+    if (pixelFormat == eNonApplicable)
+        color->Alloc2DStorage(size, internalFormat);
+    else
+        color->Alloc2D(size, pixelFormat, internalFormat);
+
+    glCreateFramebuffers(1, &fbo);
+    glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0, color->GetHandle(), 0);
+    if (depthFormat != GL_NONE)
+    {
+        glCreateRenderbuffers(1, &depth);
+        glNamedRenderbufferStorage(depth, depthFormat, size.x, size.y);
+        const bool stencil = depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+        glNamedFramebufferRenderbuffer(fbo, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    }
+    const GLenum status = glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        fprintf(stderr, "[ERROR] RenderTarget: %ux%u framebuffer incomplete (0x%x)\n", size.x, size.y, status);
+}
+
+RenderTarget::~RenderTarget()
+{
+    glDeleteFramebuffers(1, &fbo);
+    if (depth)
+        glDeleteRenderbuffers(1, &depth);
+}
+
+std::shared_ptr<Texture> RenderTarget::ShareColor()
+{
+    return std::shared_ptr<Texture>(shared_from_this(), color.get());
+}
+
+void RenderTarget::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, size.x, size.y);
+}
+
+void RenderTarget::Unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+struct RenderTargetPool::State
+{
+    std::mutex mutex;
+    // per key in release order, so the front is the least recently used
+    std::unordered_map<TargetKey, std::vector<FreeTarget>, TargetKeyHash> free;
+    size_t maxPooledBytes;
+    uint32_t maxIdleFrames;
+    uint64_t frame = 0;
+    bool shutDown = false;
+    Stats stats;
+};
+
+RenderTargetPool &RenderTargetPool::Shared()
+{
+    static RenderTargetPool pool;
+    return pool;
+}
+
+RenderTargetPool::RenderTargetPool(size_t maxPooledBytes, uint32_t maxIdleFrames) : state(std::make_shared<State>())
+{
+    state->maxPooledBytes = maxPooledBytes;
+    state->maxIdleFrames = maxIdleFrames;
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    // targets still handed out are deleted by their owners once the pool is gone
+    Clear();
+}
+
+size_t RenderTargetPool::BytesFor(uvec2 size, GLenum internalFormat, GLenum depthFormat)
+{
+    size_t depthBytes = 0;
+    switch (depthFormat)
+    {
+    case GL_NONE:
+        break;
+    case GL_DEPTH_COMPONENT16:
+        depthBytes = 2;
+        break;
+    case GL_DEPTH32F_STENCIL8:
+        depthBytes = 8;
+        break;
+    default:
+        depthBytes = 4;
+        break;
+    }
+    return TexturePool::BytesFor(size, internalFormat) + size_t(size.x) * size.y * depthBytes;
+}
+
+std::shared_ptr<RenderTarget> RenderTargetPool::Acquire(uvec2 size, PixelFormat pixelFormat, GLenum internalFormat,
+                                                        TextureFilter filter, GLenum depthFormat)
+{
+    const TargetKey key{size.x, size.y, internalFormat, depthFormat, int(pixelFormat)};
+    const size_t bytes = BytesFor(size, internalFormat, depthFormat);
+    RenderTarget *target = nullptr;
+    {
+        std::lock_guard lock(state->mutex);
+        auto it = state->free.find(key);
+        if (it != state->free.end())
+        {
+            // most recently released first, skipping what was released this frame
+            auto &list = it->second;
+            for (size_t i = list.size(); i-- > 0;)
+                if (list[i].releasedFrame < state->frame)
+                {
+                    target = list[i].target;
+                    list.erase(list.begin() + i);
+                    break;
+                }
+        }
+        if (target)
+        {
+            state->stats.pooledTargets--;
+            state->stats.pooledBytes -= bytes;
+            state->stats.hits++;
+        }
+        else
+            state->stats.misses++;
+    }
+
+    if (target)
+    {
+        if (target->color->GetFilter() != filter)
+            target->color->SetFilter(filter);
+    }
+    else
+        target = new RenderTarget(size, pixelFormat, internalFormat, depthFormat, filter);
+
+    std::weak_ptr<State> weak = state;
+    return std::shared_ptr<RenderTarget>(target, [weak, key, bytes](RenderTarget *t)
+    {
+        if (auto pool = weak.lock())
+        {
+            std::lock_guard lock(pool->mutex);
+            if (!pool->shutDown && pool->stats.pooledBytes + bytes <= pool->maxPooledBytes)
+            {
+                pool->free[key].push_back({t, pool->frame});
+                pool->stats.pooledTargets++;
+                pool->stats.pooledBytes += bytes;
+                return;
+            }
+            pool->stats.evicted++;
+        }
+        delete t;
+    });
+}
+
+GLuint RenderTargetPool::GetScratchFramebuffer()
+{
+    if (!scratch)
+        glCreateFramebuffers(1, &scratch);
+    return scratch;
+}
+
+void RenderTargetPool::EndFrame()
+{
+    std::vector<RenderTarget *> doomed;
+    {
+        std::lock_guard lock(state->mutex);
+        state->frame++;
+        for (auto it = state->free.begin(); it != state->free.end();)
+        {
+            auto &list = it->second;
+            const size_t bytes = BytesFor({it->first.width, it->first.height}, it->first.internalFormat, it->first.depthFormat);
+            size_t idle = 0;
+            while (idle < list.size() && state->frame - list[idle].releasedFrame > state->maxIdleFrames)
+                doomed.push_back(list[idle++].target);
+            list.erase(list.begin(), list.begin() + idle);
+            state->stats.pooledTargets -= idle;
+            state->stats.pooledBytes -= idle * bytes;
+            state->stats.evicted += idle;
+            it = list.empty() ? state->free.erase(it) : std::next(it);
+        }
+    }
+    for (RenderTarget *t : doomed)
+        delete t;
+}
+
+void RenderTargetPool::Trim(size_t maxBytes)
+{
+    std::vector<RenderTarget *> doomed;
+    {
+        std::lock_guard lock(state->mutex);
+        while (state->stats.pooledBytes > maxBytes)
+        {
+            // oldest front across all keys
+            auto oldest = state->free.end();
+            for (auto it = state->free.begin(); it != state->free.end(); ++it)
+                if (!it->second.empty() &&
+                    (oldest == state->free.end() || it->second.front().releasedFrame < oldest->second.front().releasedFrame))
+                    oldest = it;
+            if (oldest == state->free.end())
+                break;
+            doomed.push_back(oldest->second.front().target);
+            oldest->second.erase(oldest->second.begin());
+            state->stats.pooledTargets--;
+            state->stats.pooledBytes -= BytesFor({oldest->first.width, oldest->first.height}, oldest->first.internalFormat,
+                                                 oldest->first.depthFormat);
+            state->stats.evicted++;
+            if (oldest->second.empty())
+                state->free.erase(oldest);
+        }
+    }
+    for (RenderTarget *t : doomed)
+        delete t;
+}
+
+void RenderTargetPool::Clear()
+{
+    Trim(0);
+    if (scratch)
+        glDeleteFramebuffers(1, &scratch);
+    scratch = 0;
+}
+
+void RenderTargetPool::Shutdown()
+{
+    {
+        std::lock_guard lock(state->mutex);
+        state->shutDown = true;
+    }
+    Clear();
+}
+
+RenderTargetPool::Stats RenderTargetPool::GetStats() const
+{
+    std::lock_guard lock(state->mutex);
+    return state->stats;
+}
+
+uint64_t RenderTargetPool::GetFrame() const
+{
+    std::lock_guard lock(state->mutex);
+    return state->frame;
+}
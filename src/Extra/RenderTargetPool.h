@@ -0,0 +1,87 @@
+#pragma once
+#include "Texture.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/// @brief A framebuffer with a color texture and optionally a depth renderbuffer, from RenderTargetPool.
+/// The attachments never change, so binding one costs no framebuffer validation.
+class RenderTarget : public std::enable_shared_from_this<RenderTarget>
+{
+public:
+    ~RenderTarget();
+    RenderTarget(const RenderTarget &) = delete;
+    RenderTarget &operator=(const RenderTarget &) = delete;
+
+    GLuint GetFramebuffer() const { return fbo; }
+    const Texture &GetColor() const { return *color; }
+    GLuint GetDepth() const { return depth; }
+    uvec2 GetSize() const { return size; }
+    /// @brief The color texture, keeping this target out of the pool for as long as it is held.
+    std::shared_ptr<Texture> ShareColor();
+
+    /// @brief Binds for drawing and sets the viewport to the whole target.
+    void Bind() const;
+    static void Unbind();
+
+private:
+    friend class RenderTargetPool;
+    RenderTarget(uvec2 size, PixelFormat pixelFormat, GLenum internalFormat, GLenum depthFormat, TextureFilter filter);
+
+    GLuint fbo = 0, depth = 0;
+    std::unique_ptr<Texture> color;
+    uvec2 size;
+};
+
+/// @brief Recycles render targets by size and formats. A target goes back to the pool when the
+/// last shared_ptr to it (or to its ShareColor texture) goes away, which must happen on the GL
+/// thread, and is handed out again from the next frame on: ImGui may still sample a texture
+/// released while the frame is being built. Targets unused for maxIdleFrames are deleted.
+class RenderTargetPool
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;  // each one created a framebuffer
+        uint64_t evicted = 0; // deleted after sitting idle or over the byte limit
+        size_t pooledTargets = 0;
+        size_t pooledBytes = 0;
+        double HitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    /// @brief Pool used by Texture::BlitToNew; App advances it once per frame.
+    static RenderTargetPool &Shared();
+
+    RenderTargetPool(size_t maxPooledBytes = 256ull << 20, uint32_t maxIdleFrames = 120);
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool &) = delete;
+    RenderTargetPool &operator=(const RenderTargetPool &) = delete;
+
+    /// @brief A target with this size and formats, recycled when one is free. Contents are undefined.
+    /// eNonApplicable allocates immutable storage like Alloc2DStorage; depthFormat GL_NONE means no depth.
+    std::shared_ptr<RenderTarget> Acquire(uvec2 size, PixelFormat pixelFormat, GLenum internalFormat,
+                                          TextureFilter filter = Linear, GLenum depthFormat = GL_NONE);
+    /// @brief Read framebuffer for copying out of textures that are not render targets.
+    /// Attach the source, read, then detach it again so the framebuffer does not keep it alive.
+    GLuint GetScratchFramebuffer();
+
+    /// @brief Makes targets released this frame available and evicts the ones idle too long.
+    void EndFrame();
+    /// @brief Deletes free targets until at most maxBytes stay pooled, least recently used first.
+    void Trim(size_t maxBytes);
+    /// @brief Deletes every free target and the scratch framebuffer.
+    void Clear();
+    /// @brief Clears the pool and stops pooling: targets released afterwards are deleted right away.
+    /// Call before the context goes away, so the static Shared() pool has nothing left to delete.
+    void Shutdown();
+    Stats GetStats() const;
+    uint64_t GetFrame() const;
+
+    static size_t BytesFor(uvec2 size, GLenum internalFormat, GLenum depthFormat);
+
+private:
+    struct State;
+    std::shared_ptr<State> state;
+    GLuint scratch = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lib_include.h"
+#include "Readback.h"
 
 
 class SSBO 
@@ -30,4 +31,9 @@ void GetData(size_t offset, size_t size, void* dest)
 {
     glGetNamedBufferSubData(Handle,offset,size,dest);
 }
+// GetData without the pipeline stall; poll the result on a later frame
+Readback GetDataAsync(size_t offset, size_t size)
+{
+    return Readback::FromBuffer(Handle,offset,size);
+}
 };
\ No newline at end of file
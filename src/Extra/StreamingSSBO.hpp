@@ -0,0 +1,131 @@
+#pragma once
+
+#include "lib_include.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+// SSBO for data rewritten every frame. Immutable storage, persistently and coherently mapped,
+// split into Frames regions guarded by fences: BeginFrame() waits for the GPU to finish with the
+// region (normally already done), Allocate() bumps through it, EndFrame() fences it.
+// Writes land directly in mapped memory, with no driver copies or implicit syncs.
+class StreamingSSBO
+{
+GLuint Handle;
+uint8* Mapped;
+size_t RegionSize;
+uint32 Frames;
+size_t Alignment;
+uint32 Current = 0;
+size_t Head = 0;
+std::vector<GLsync> Fences;
+uint64_t Stalls = 0;
+size_t ReportedNeed = 0; // largest overflow logged so far
+
+public:
+struct Allocation
+{
+    void* data = nullptr;
+    size_t offset = 0; // from the start of the buffer, for BindRange
+    size_t size = 0;
+    explicit operator bool() const {return data != nullptr;}
+    template <typename T>
+    T* As() const {return static_cast<T*>(data);}
+};
+
+StreamingSSBO(size_t regionSize,uint32 frames = 3) : Frames(frames), Fences(frames,nullptr)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,&alignment);
+    Alignment = alignment > 0 ? size_t(alignment) : 256;
+    RegionSize = (regionSize + Alignment - 1) / Alignment * Alignment;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1,&Handle);
+    glNamedBufferStorage(Handle,RegionSize * Frames,nullptr,flags);
+    Mapped = static_cast<uint8*>(glMapNamedBufferRange(Handle,0,RegionSize * Frames,flags));
+}
+~StreamingSSBO()
+{
+    for (GLsync fence : Fences)
+        if (fence)
+            glDeleteSync(fence);
+    glUnmapNamedBuffer(Handle);
+    glDeleteBuffers(1,&Handle);
+}
+StreamingSSBO(const StreamingSSBO&) = delete;
+StreamingSSBO& operator=(const StreamingSSBO&) = delete;
+
+// Call before the first Allocate of a frame; only blocks when the GPU is Frames frames behind
+void BeginFrame()
+{
+    Head = 0;
+    GLsync& fence = Fences[Current];
+    if (!fence)
+        return;
+    GLenum result = glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        Stalls++;
+        do
+            result = glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+        while (result == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+// Call after the last draw or dispatch reading this frame's allocations
+void EndFrame()
+{
+    Fences[Current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    Current = (Current + 1) % Frames;
+}
+
+// Empty Allocation when the frame's region is full
+Allocation Allocate(size_t size)
+{
+    const size_t start = (Head + Alignment - 1) / Alignment * Alignment;
+    if (start + size > RegionSize)
+    {
+        // a frame that overflows once usually overflows every frame; only log when it needs more than before
+        if (start + size > ReportedNeed)
+        {
+            ReportedNeed = start + size;
+            fprintf(stderr,"[WARN] StreamingSSBO region full: frame needs %zu bytes, region holds %zu\n",start + size,RegionSize);
+        }
+        return {};
+    }
+    Head = start + size;
+    const size_t offset = Current * RegionSize + start;
+    return {Mapped + offset,offset,size};
+}
+template <typename T>
+T* Allocate(size_t count,Allocation* allocation = nullptr)
+{
+    Allocation a = Allocate(count * sizeof(T));
+    if (allocation)
+        *allocation = a;
+    return a.As<T>();
+}
+Allocation Push(const void* data,size_t size)
+{
+    Allocation a = Allocate(size);
+    if (a)
+        memcpy(a.data,data,size);
+    return a;
+}
+// Does nothing for empty allocations, which glBindBufferRange rejects
+void BindRange(uint32 Index,const Allocation& allocation)
+{
+    if (allocation.size == 0)
+        return;
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER,Index,Handle,allocation.offset,allocation.size);
+}
+
+auto GetHandle() {return Handle;}
+size_t GetRegionSize() const {return RegionSize;}
+size_t GetUsed() const {return Head;}
+// BeginFrame calls that had to wait on the GPU; nonzero means more frames are needed
+uint64_t GetStalls() const {return Stalls;}
+};
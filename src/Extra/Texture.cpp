@@ -1,4 +1,6 @@
 #include "Texture.h"
+#include "RenderTargetPool.h"
+#include "Profiler.h"
 Texture::Texture()
 {
 glCreateTextures(GL_TEXTURE_2D,1, &Handle);
@@ -8,3 +10,29 @@ Texture::~Texture()
 {
     glDeleteTextures(1,&Handle);
 }
+
+std::shared_ptr<Texture> Texture::BlitToNew(uvec2 newSize, TextureFilter filterMode) const
+{
+    Profiler::Scope scope("Texture::BlitToNew");
+    // Destination framebuffer and texture, recycled when one of the same size and format is free
+    RenderTargetPool &pool = RenderTargetPool::Shared();
+    auto dst = pool.Acquire(newSize, pixel_format, InternalFormat, filterMode);
+
+    // The source goes through the pool's read framebuffer for the length of the blit
+    const GLuint srcFBO = pool.GetScratchFramebuffer();
+    glNamedFramebufferTexture(srcFBO, GL_COLOR_ATTACHMENT0, Handle, 0);
+
+    // Perform blit (scaled or unscaled copy)
+    glBlitNamedFramebuffer(
+        srcFBO, dst->GetFramebuffer(),
+        0, 0, Dimensions.x, Dimensions.y,
+        0, 0, newSize.x, newSize.y,
+        GL_COLOR_BUFFER_BIT,
+        filterMode == Linear ? GL_LINEAR : GL_NEAREST
+    );
+
+    // Detach so the framebuffer does not keep this texture alive
+    glNamedFramebufferTexture(srcFBO, GL_COLOR_ATTACHMENT0, 0, 0);
+
+    return dst->ShareColor();
+}
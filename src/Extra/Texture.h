@@ -4,6 +4,7 @@
 #include "../lib_include.h"
 #include <string>
 #include <memory>
+#include "Readback.h"
 enum PixelFormat
 {
     eR = GL_RED,
@@ -68,6 +69,12 @@ public:
     {
         glGetTextureImage(Handle,0,pixel_format,GL_UNSIGNED_BYTE,size,dest);
     }
+    /// @brief GetData without the pipeline stall; poll the result on a later frame.
+    Readback GetDataAsync(GLenum type = GL_UNSIGNED_BYTE) const
+    {
+        const GLenum format = pixel_format == eNonApplicable ? GL_RGBA : pixel_format;
+        return Readback::FromTexture(Handle, 0, format, type, Dimensions);
+    }
     void GenerateMipmaps()
     {
         Bind();
@@ -83,42 +90,8 @@ public:
         Unbind();
     };
 
-std::shared_ptr<Texture> BlitToNew(uvec2 newSize, TextureFilter filterMode = Linear) const
-{
-    // Create destination texture
-    auto dst = std::make_shared<Texture>();
-    dst->SetFilter(filterMode);
-    dst->Alloc2D(newSize, pixel_format, InternalFormat);
-
-    // Create temporary framebuffers
-    GLuint srcFBO = 0, dstFBO = 0;
-    glGenFramebuffers(1, &srcFBO);
-    glGenFramebuffers(1, &dstFBO);
-
-    // Bind source texture to read FBO
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, srcFBO);
-    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Handle, 0);
-
-    // Bind destination texture to draw FBO
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dstFBO);
-    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst->GetHandle(), 0);
-
-    // Perform blit (scaled or unscaled copy)
-    glBlitFramebuffer(
-        0, 0, Dimensions.x, Dimensions.y,
-        0, 0, newSize.x, newSize.y,
-        GL_COLOR_BUFFER_BIT,
-        filterMode == Linear ? GL_LINEAR : GL_NEAREST
-    );
-
-    // Cleanup
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &srcFBO);
-    glDeleteFramebuffers(1, &dstFBO);
-
-    return dst;
-}
+    /// @brief Scaled copy into a texture recycled from RenderTargetPool::Shared(), along with its framebuffer.
+    std::shared_ptr<Texture> BlitToNew(uvec2 newSize, TextureFilter filterMode = Linear) const;
     TextureFilter GetFilter() const { return filter; }
     PixelFormat GetPixelFormat() const { return pixel_format; }
     GLenum GetInternalFormat() const { return InternalFormat; }
@@ -0,0 +1,166 @@
+#include "TexturePool.h"
+
+namespace
+{
+    struct PoolKey
+    {
+        uint32_t width, height;
+        GLenum internalFormat;
+        int pixelFormat;
+        bool operator==(const PoolKey &) const = default;
+    };
+    struct PoolKeyHash
+    {
+        size_t operator()(const PoolKey &k) const
+        {
+            uint64_t h = (uint64_t(k.width) << 32 | k.height) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t(k.internalFormat) << 8 ^ uint64_t(uint32_t(k.pixelFormat))) * 0xBF58476D1CE4E5B9ull;
+            return size_t(h ^ (h >> 31));
+        }
+    };
+}
+
+struct TexturePool::State
+{
+    std::mutex mutex;
+    std::unordered_map<PoolKey, std::vector<Texture *>, PoolKeyHash> free;
+    size_t maxPooledBytes;
+    bool shutDown = false;
+    Stats stats;
+};
+
+TexturePool &TexturePool::Shared()
+{
+    static TexturePool pool;
+    return pool;
+}
+
+TexturePool::TexturePool(size_t maxPooledBytes) : state(std::make_shared<State>())
+{
+    state->maxPooledBytes = maxPooledBytes;
+}
+
+TexturePool::~TexturePool()
+{
+    // textures still handed out are deleted by their owners once the pool is gone
+    Clear();
+}
+
+size_t TexturePool::BytesFor(uvec2 size, GLenum internalFormat)
+{
+    size_t bytesPerPixel = 4;
+    switch (internalFormat)
+    {
+    case GL_R8:
+        bytesPerPixel = 1;
+        break;
+    case GL_RG8:
+    case GL_R16F:
+        bytesPerPixel = 2;
+        break;
+    case GL_RGB8:
+        bytesPerPixel = 3;
+        break;
+    case GL_RGBA16F:
+    case GL_RG32F:
+        bytesPerPixel = 8;
+        break;
+    case GL_RGBA32F:
+        bytesPerPixel = 16;
+        break;
+    default:
+        break;
+    }
+    return size_t(size.x) * size.y * bytesPerPixel;
+}
+
+std::shared_ptr<Texture> TexturePool::Acquire(uvec2 size, PixelFormat pixelFormat, GLenum internalFormat, TextureFilter filter)
+{
+    const PoolKey key{size.x, size.y, internalFormat, int(pixelFormat)};
+    const size_t bytes = BytesFor(size, internalFormat);
+    Texture *texture = nullptr;
+    {
+        std::lock_guard lock(state->mutex);
+        auto it = state->free.find(key);
+        if (it != state->free.end() && !it->second.empty())
+        {
+            texture = it->second.back();
+            it->second.pop_back();
+            state->stats.pooledTextures--;
+            state->stats.pooledBytes -= bytes;
+            state->stats.hits++;
+        }
+        else
+            state->stats.misses++;
+    }
+
+    if (texture)
+    {
+        if (texture->GetFilter() != filter)
+            texture->SetFilter(filter);
+    }
+    else
+    {
+        texture = new Texture();
+        texture->SetFilter(filter);
+        if (pixelFormat == eNonApplicable)
+            texture->Alloc2DStorage(size, internalFormat);
+        else
+            texture->Alloc2D(size, pixelFormat, internalFormat);
+    }
+
+    std::weak_ptr<State> weak = state;
+    return std::shared_ptr<Texture>(texture, [weak, key, bytes](Texture *t)
+    {
+        if (auto pool = weak.lock())
+        {
+            std::lock_guard lock(pool->mutex);
+            if (!pool->shutDown && pool->stats.pooledBytes + bytes <= pool->maxPooledBytes)
+            {
+                pool->free[key].push_back(t);
+                pool->stats.pooledTextures++;
+                pool->stats.pooledBytes += bytes;
+                return;
+            }
+        }
+        delete t;
+    });
+}
+
+void TexturePool::Trim(size_t maxBytes)
+{
+    std::vector<Texture *> doomed;
+    {
+        std::lock_guard lock(state->mutex);
+        for (auto it = state->free.begin(); it != state->free.end() && state->stats.pooledBytes > maxBytes;)
+        {
+            const size_t bytes = BytesFor({it->first.width, it->first.height}, it->first.internalFormat);
+            auto &list = it->second;
+            while (!list.empty() && state->stats.pooledBytes > maxBytes)
+            {
+                doomed.push_back(list.back());
+                list.pop_back();
+                state->stats.pooledTextures--;
+                state->stats.pooledBytes -= bytes;
+            }
+            it = list.empty() ? state->free.erase(it) : std::next(it);
+        }
+    }
+    for (Texture *t : doomed)
+        delete t;
+}
+
+void TexturePool::Shutdown()
+{
+    {
+        std::lock_guard lock(state->mutex);
+        state->shutDown = true;
+    }
+    Clear();
+}
+
+TexturePool::Stats TexturePool::GetStats() const
+{
+    std::lock_guard lock(state->mutex);
+    return state->stats;
+}
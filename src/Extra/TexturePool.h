@@ -0,0 +1,47 @@
+#pragma once
+#include "Texture.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Recycles textures by size and format. Textures handed out return to the pool when the
+/// last shared_ptr goes away, so that must happen on the GL thread.
+class TexturePool
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t pooledTextures = 0;
+        size_t pooledBytes = 0;
+        double HitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    /// @brief Pool used by TextureStreamer.
+    static TexturePool &Shared();
+
+    TexturePool(size_t maxPooledBytes = 256ull << 20);
+    ~TexturePool();
+    TexturePool(const TexturePool &) = delete;
+    TexturePool &operator=(const TexturePool &) = delete;
+
+    /// @brief A texture with this size and format, recycled when one is free. Contents are undefined.
+    /// eNonApplicable allocates immutable storage like Alloc2DStorage.
+    std::shared_ptr<Texture> Acquire(uvec2 size, PixelFormat pixelFormat, GLenum internalFormat, TextureFilter filter = Linear);
+    /// @brief Deletes free textures until at most maxBytes stay pooled.
+    void Trim(size_t maxBytes);
+    void Clear() { Trim(0); }
+    /// @brief Clears the pool and stops pooling: textures released afterwards are deleted right away.
+    /// Call before the context goes away, so the static Shared() pool has nothing left to delete.
+    void Shutdown();
+    Stats GetStats() const;
+
+    static size_t BytesFor(uvec2 size, GLenum internalFormat);
+
+private:
+    struct State;
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,301 @@
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <cstring>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// PBO offsets must suit any pixel size; 256 also keeps copies cache-line aligned
+static constexpr size_t StagingAlignment = 256;
+
+static GLenum InternalFormatFor(PixelFormat format)
+{
+    switch (format)
+    {
+    case eR:
+        return GL_R8;
+    case eRG:
+        return GL_RG8;
+    case eRGB:
+        return GL_RGB8;
+    default:
+        return GL_RGBA8;
+    }
+}
+
+static size_t ChannelsOf(PixelFormat format)
+{
+    switch (format)
+    {
+    case eR:
+        return 1;
+    case eRG:
+        return 2;
+    case eRGB:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+TextureStreamer::TextureStreamer(TexturePool &_pool, size_t stagingBytes, unsigned workers) : pool(_pool)
+{
+    // Allocate rounds every request up to the alignment; a ring that is not a multiple of it
+    // could never fit a job that only just passes the direct upload check
+    capacity = std::max((stagingBytes + StagingAlignment - 1) / StagingAlignment * StagingAlignment, StagingAlignment);
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &pbo);
+    glNamedBufferStorage(pbo, capacity, nullptr, flags);
+    mapped = static_cast<uint8_t *>(glMapNamedBufferRange(pbo, 0, capacity, flags));
+    freeBlocks[0] = capacity;
+
+    if (workers == 0)
+        workers = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+    for (unsigned i = 0; i < workers; i++)
+        threads.emplace_back(&TextureStreamer::WorkerLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    spaceFreed.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+
+    for (auto &upload : inFlight)
+        glDeleteSync(upload.fence);
+    glUnmapNamedBuffer(pbo);
+    glDeleteBuffers(1, &pbo);
+}
+
+void TextureStreamer::LoadFile(const std::string &path, Callback done, bool mipmaps, TextureFilter filter)
+{
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->done = std::move(done);
+    job->mipmaps = mipmaps;
+    job->filter = filter;
+    Enqueue(std::move(job));
+}
+
+void TextureStreamer::LoadPixels(uvec2 size, PixelFormat format, std::vector<uint8_t> &&pixels, Callback done, bool mipmaps, TextureFilter filter)
+{
+    auto job = std::make_shared<Job>();
+    job->size = size;
+    job->format = format;
+    job->pixels = std::move(pixels);
+    job->done = std::move(done);
+    job->mipmaps = mipmaps;
+    job->filter = filter;
+    if (job->pixels.size() < size_t(size.x) * size.y * ChannelsOf(format))
+    {
+        fprintf(stderr, "[ERROR] TextureStreamer: pixel data smaller than %ux%u\n", size.x, size.y);
+        job->failed = true;
+        std::lock_guard lock(mutex);
+        staged.push_back(std::move(job));
+        return;
+    }
+    Enqueue(std::move(job));
+}
+
+void TextureStreamer::Enqueue(std::shared_ptr<Job> job)
+{
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back(std::move(job));
+        unstaged++;
+    }
+    wake.notify_one();
+}
+
+bool TextureStreamer::Decode(Job &job)
+{
+    int w = 0, h = 0, channels = 0;
+    stbi_uc *data = stbi_load(job.path.c_str(), &w, &h, &channels, 0);
+    if (!data)
+    {
+        fprintf(stderr, "[ERROR] Could not decode %s: %s\n", job.path.c_str(), stbi_failure_reason());
+        return false;
+    }
+    job.size = uvec2(w, h);
+    job.format = channels == 1 ? eR : channels == 2 ? eRG : channels == 3 ? eRGB : eRGBA;
+    job.decoded = std::shared_ptr<const uint8_t>(data, stbi_image_free);
+    return true;
+}
+
+void TextureStreamer::WorkerLoop()
+{
+    for (;;)
+    {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]
+                      { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        if (!job->path.empty() && !Decode(*job))
+            job->failed = true;
+        else
+        {
+            job->bytes = size_t(job->size.x) * job->size.y * ChannelsOf(job->format);
+            job->direct = job->bytes > capacity;
+        }
+
+        if (!job->failed && !job->direct)
+        {
+            {
+                // wait for the render thread to retire uploads; it never waits on us
+                std::unique_lock lock(mutex);
+                spaceFreed.wait(lock, [&]
+                                { return stopping || Allocate(job->bytes, job->offset); });
+                if (stopping)
+                    return;
+            }
+            memcpy(mapped + job->offset, job->Source(), job->bytes);
+            job->decoded.reset();
+            job->pixels = {};
+        }
+
+        std::lock_guard lock(mutex);
+        staged.push_back(std::move(job));
+        unstaged--;
+    }
+}
+
+bool TextureStreamer::Allocate(size_t bytes, size_t &offset)
+{
+    const size_t need = (bytes + StagingAlignment - 1) / StagingAlignment * StagingAlignment;
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        if (it->second < need)
+            continue;
+        offset = it->first;
+        const size_t rest = it->second - need;
+        freeBlocks.erase(it);
+        if (rest)
+            freeBlocks[offset + need] = rest;
+        return true;
+    }
+    return false;
+}
+
+void TextureStreamer::Release(size_t offset, size_t bytes)
+{
+    size_t size = (bytes + StagingAlignment - 1) / StagingAlignment * StagingAlignment;
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+    if (next != freeBlocks.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+    freeBlocks[offset] = size;
+}
+
+void TextureStreamer::Submit(const std::shared_ptr<Job> &job)
+{
+    auto texture = pool.Acquire(job->size, job->format, InternalFormatFor(job->format), job->filter);
+    const GLuint handle = texture->GetHandle();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (job->direct)
+    {
+        glTextureSubImage2D(handle, 0, 0, 0, job->size.x, job->size.y, job->format, GL_UNSIGNED_BYTE, job->Source());
+        job->decoded.reset();
+        job->pixels = {};
+        stats.directUploads++;
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glTextureSubImage2D(handle, 0, 0, 0, job->size.x, job->size.y, job->format, GL_UNSIGNED_BYTE, (const void *)job->offset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (job->mipmaps)
+        glGenerateTextureMipmap(handle);
+
+    inFlight.push_back({job, std::move(texture), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+}
+
+void TextureStreamer::Update()
+{
+    // fences signal in submission order, so stop at the first one still pending
+    bool freed = false;
+    while (!inFlight.empty())
+    {
+        InFlight &front = inFlight.front();
+        const GLenum status = glClientWaitSync(front.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+            break;
+        glDeleteSync(front.fence);
+        InFlight done = std::move(front);
+        inFlight.pop_front();
+
+        if (!done.job->direct)
+        {
+            std::lock_guard lock(mutex);
+            Release(done.job->offset, done.job->bytes);
+            freed = true;
+        }
+        stats.uploads++;
+        stats.bytesUploaded += done.job->bytes;
+        windowBytes += done.job->bytes;
+        if (done.job->done)
+            done.job->done(std::move(done.texture));
+    }
+    if (freed)
+        spaceFreed.notify_all();
+
+    std::deque<std::shared_ptr<Job>> ready;
+    {
+        std::lock_guard lock(mutex);
+        ready.swap(staged);
+    }
+    for (auto &job : ready)
+    {
+        if (job->failed)
+        {
+            if (job->done)
+                job->done(nullptr);
+            continue;
+        }
+        Submit(job);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - windowStart).count();
+    if (seconds >= 1.0)
+    {
+        stats.bandwidthMBs = windowBytes / 1e6 / seconds;
+        windowBytes = 0;
+        windowStart = now;
+    }
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const
+{
+    Stats result = stats;
+    {
+        std::lock_guard lock(mutex);
+        result.pending = unstaged + staged.size() + inFlight.size();
+    }
+    result.pool = pool.GetStats();
+    return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "TexturePool.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+/// @brief Streams textures to the GPU without stalling the render thread.
+/// Worker threads decode (stb_image) and copy pixels straight into a persistently mapped
+/// pixel unpack buffer; Update() on the render thread only issues the PBO-to-texture copies
+/// and hands textures over once their fence has signalled. Textures come from a TexturePool.
+class TextureStreamer
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<Texture> texture)>; // null when loading failed
+
+    struct Stats
+    {
+        uint64_t uploads = 0;
+        uint64_t bytesUploaded = 0;
+        uint64_t directUploads = 0; // too large for the staging ring, uploaded from client memory
+        double bandwidthMBs = 0;    // over the last completed second
+        size_t pending = 0;         // decoding, staged or in flight
+        TexturePool::Stats pool;
+    };
+
+    /// @brief Needs a current GL context; the staging ring is allocated here, rounded up to 256 bytes.
+    TextureStreamer(TexturePool &pool = TexturePool::Shared(), size_t stagingBytes = 64ull << 20, unsigned workers = 0);
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    /// @brief Decodes an image file on a worker; `done` runs on the render thread in Update().
+    void LoadFile(const std::string &path, Callback done, bool mipmaps = false, TextureFilter filter = Linear);
+    /// @brief Uploads tightly packed 8 bit pixels; staging happens on a worker.
+    void LoadPixels(uvec2 size, PixelFormat format, std::vector<uint8_t> &&pixels, Callback done, bool mipmaps = false, TextureFilter filter = Linear);
+
+    /// @brief Render thread, once per frame. Never waits on the GPU or the workers.
+    void Update();
+    Stats GetStats() const;
+
+private:
+    struct Job
+    {
+        std::string path; // empty: pixels already in memory
+        uvec2 size{0};
+        PixelFormat format = eRGBA;
+        std::vector<uint8_t> pixels;
+        std::shared_ptr<const uint8_t> decoded; // stb_image output, used instead of `pixels`
+        Callback done;
+        bool mipmaps = false;
+        TextureFilter filter = Linear;
+
+        size_t offset = 0; // in the staging ring, valid once staged
+        size_t bytes = 0;
+        bool direct = false; // larger than the ring, uploaded from Source() by the render thread
+        bool failed = false;
+
+        const uint8_t *Source() const { return decoded ? decoded.get() : pixels.data(); }
+    };
+    struct InFlight
+    {
+        std::shared_ptr<Job> job;
+        std::shared_ptr<Texture> texture;
+        GLsync fence;
+    };
+
+    TexturePool &pool;
+    GLuint pbo = 0;
+    uint8_t *mapped = nullptr;
+    size_t capacity = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;      // workers: new jobs or stop
+    std::condition_variable spaceFreed; // workers waiting for staging space
+    std::deque<std::shared_ptr<Job>> jobs;
+    std::deque<std::shared_ptr<Job>> staged;
+    std::map<size_t, size_t> freeBlocks; // offset -> size, coalesced
+    size_t unstaged = 0; // queued or being decoded
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    std::deque<InFlight> inFlight; // render thread only
+    Stats stats;
+    uint64_t windowBytes = 0;
+    std::chrono::steady_clock::time_point windowStart = std::chrono::steady_clock::now();
+
+    void Enqueue(std::shared_ptr<Job> job);
+    void WorkerLoop();
+    bool Decode(Job &job);
+    bool Allocate(size_t bytes, size_t &offset); // mutex held
+    void Release(size_t offset, size_t bytes);   // mutex held
+    void Submit(const std::shared_ptr<Job> &job);
+};
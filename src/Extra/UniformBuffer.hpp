@@ -0,0 +1,51 @@
+#pragma once
+
+#include "lib_include.h"
+
+
+// Uniform buffer for per-frame data shared by several programs; pair with Program::BindUniformBlock.
+// Contents follow the block's std140 layout.
+class UniformBuffer
+{
+GLuint Handle;
+size_t Size;
+
+public:
+UniformBuffer(size_t size,const void* data = nullptr) : Size(size)
+{
+    glCreateBuffers(1,&Handle);
+    glNamedBufferData(Handle,size,data,GL_DYNAMIC_DRAW);
+}
+~UniformBuffer()
+{
+    glDeleteBuffers(1,&Handle);
+}
+UniformBuffer(const UniformBuffer&) = delete;
+UniformBuffer& operator=(const UniformBuffer&) = delete;
+void BindBase(uint32 Index)
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER,Index,Handle);
+}
+// offset must be a multiple of OffsetAlignment()
+void BindRange(uint32 Index,size_t offset,size_t size)
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER,Index,Handle,offset,size);
+}
+auto GetHandle() {return Handle;}
+size_t GetSize() const {return Size;}
+void Update(const void* data, size_t size,size_t offset = 0)
+{
+    glNamedBufferSubData(Handle,offset,size,data);
+}
+template <typename T>
+void Update(const T& block)
+{
+    Update(&block,sizeof(T));
+}
+static GLint OffsetAlignment()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+    return alignment;
+}
+};
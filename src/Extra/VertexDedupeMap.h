@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ImguiBase
+{
+    /// @brief Flat open-addressing map from an index triple (e.g. position/texcoord/normal)
+    /// to a vertex index. Linear probing over 16 byte slots, no per-entry allocation.
+    /// Values must be below Empty, which marks unused slots.
+    class VertexDedupeMap
+    {
+    public:
+        using Key = std::array<uint32_t, 3>;
+        static constexpr uint32_t Empty = uint32_t(-1);
+
+        VertexDedupeMap() = default;
+        explicit VertexDedupeMap(size_t expectedEntries) { Reserve(expectedEntries); }
+
+        /// @brief Sizes the table so `entries` fit without rehashing.
+        void Reserve(size_t entries)
+        {
+            size_t wanted = 16;
+            while (wanted * MaxLoadNum < entries * MaxLoadDen)
+                wanted <<= 1;
+            if (wanted > slots.size())
+                Rehash(wanted);
+        }
+
+        /// @brief Returns the stored value for `key`, inserting `value` first if it is new.
+        /// `inserted` tells which of the two happened.
+        uint32_t FindOrInsert(const Key &key, uint32_t value, bool &inserted)
+        {
+            if ((count + 1) * MaxLoadDen > slots.size() * MaxLoadNum)
+                Rehash(slots.empty() ? 16 : slots.size() * 2);
+
+            for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+            {
+                Slot &slot = slots[i];
+                if (slot.value == Empty)
+                {
+                    slot.key = key;
+                    slot.value = value;
+                    count++;
+                    inserted = true;
+                    return value;
+                }
+                if (slot.key == key)
+                {
+                    inserted = false;
+                    return slot.value;
+                }
+            }
+        }
+
+        /// @brief Value stored for `key`, or Empty.
+        uint32_t Find(const Key &key) const
+        {
+            if (slots.empty())
+                return Empty;
+            for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+            {
+                const Slot &slot = slots[i];
+                if (slot.value == Empty)
+                    return Empty;
+                if (slot.key == key)
+                    return slot.value;
+            }
+        }
+
+        size_t Size() const { return count; }
+        size_t Capacity() const { return slots.size(); }
+        size_t MemoryBytes() const { return slots.size() * sizeof(Slot); }
+
+        void Clear()
+        {
+            slots.assign(slots.size(), Slot{});
+            count = 0;
+        }
+
+        /// @brief Mixes all three indices so neighbouring triples land far apart.
+        static size_t Hash(const Key &key)
+        {
+            uint64_t h = (uint64_t(key[0]) << 32 | key[1]) * 0x9E3779B97F4A7C15ull;
+            h ^= (h >> 29) ^ (uint64_t(key[2]) * 0xBF58476D1CE4E5B9ull);
+            h ^= h >> 32;
+            h *= 0x94D049BB133111EBull;
+            return size_t(h ^ (h >> 31));
+        }
+
+    private:
+        struct Slot
+        {
+            Key key{};
+            uint32_t value = Empty;
+        };
+        static_assert(sizeof(Slot) == 16);
+
+        // linear probing degrades quickly past 3/4 full
+        static constexpr size_t MaxLoadNum = 3;
+        static constexpr size_t MaxLoadDen = 4;
+
+        std::vector<Slot> slots;
+        size_t mask = 0;
+        size_t count = 0;
+
+        void Rehash(size_t newSize)
+        {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(newSize, Slot{});
+            mask = newSize - 1;
+            for (const Slot &slot : old)
+            {
+                if (slot.value == Empty)
+                    continue;
+                size_t i = Hash(slot.key) & mask;
+                while (slots[i].value != Empty)
+                    i = (i + 1) & mask;
+                slots[i] = slot;
+            }
+        }
+    };
+}
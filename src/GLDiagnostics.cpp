@@ -0,0 +1,262 @@
+#include "GLDiagnostics.h"
+#include <cstdio>
+#include <cstring>
+
+static const char *SeverityName(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:
+        return "HIGH";
+    case GL_DEBUG_SEVERITY_MEDIUM:
+        return "MEDIUM";
+    case GL_DEBUG_SEVERITY_LOW:
+        return "LOW";
+    case GL_DEBUG_SEVERITY_NOTIFICATION:
+        return "NOTIFICATION";
+    }
+    return "UNKNOWN";
+}
+
+static int SeverityRank(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:
+        return 3;
+    case GL_DEBUG_SEVERITY_MEDIUM:
+        return 2;
+    case GL_DEBUG_SEVERITY_LOW:
+        return 1;
+    }
+    return 0;
+}
+
+void GLDiagnostics::Init(const GLDiagnosticsSettings &_settings)
+{
+    settings = _settings;
+    for (size_t i = 0; i < QueueCapacity; i++)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    windowStart = std::chrono::steady_clock::now();
+
+    if (settings.mode == GLDebugMode::Off)
+    {
+        glDisable(GL_DEBUG_OUTPUT);
+        return;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (settings.mode == GLDebugMode::Sync)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    // filter in the driver so ignored messages never reach the callback
+    static const GLenum severities[] = {GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW,
+                                        GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH};
+    for (GLenum severity : severities)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr,
+                              SeverityRank(severity) >= SeverityRank(settings.minSeverity));
+    // an id list is only accepted with a concrete source and type (GL_INVALID_OPERATION otherwise)
+    static const GLenum sources[] = {GL_DEBUG_SOURCE_API, GL_DEBUG_SOURCE_WINDOW_SYSTEM, GL_DEBUG_SOURCE_SHADER_COMPILER,
+                                     GL_DEBUG_SOURCE_THIRD_PARTY, GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_SOURCE_OTHER};
+    static const GLenum types[] = {GL_DEBUG_TYPE_ERROR, GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR,
+                                   GL_DEBUG_TYPE_PORTABILITY, GL_DEBUG_TYPE_PERFORMANCE, GL_DEBUG_TYPE_MARKER,
+                                   GL_DEBUG_TYPE_PUSH_GROUP, GL_DEBUG_TYPE_POP_GROUP, GL_DEBUG_TYPE_OTHER};
+    if (!settings.ignoredIds.empty())
+        for (GLenum source : sources)
+            for (GLenum type : types)
+                glDebugMessageControl(source, type, GL_DONT_CARE, (GLsizei)settings.ignoredIds.size(),
+                                      settings.ignoredIds.data(), GL_FALSE);
+
+    glDebugMessageCallback(Callback, this);
+}
+
+void APIENTRY GLDiagnostics::Callback(GLenum source, GLenum type, GLuint id,
+                                      GLenum severity, GLsizei length,
+                                      const GLchar *message, const void *userParam)
+{
+    auto *self = static_cast<GLDiagnostics *>(const_cast<void *>(userParam));
+
+    Message m;
+    m.source = source;
+    m.type = type;
+    m.id = id;
+    m.severity = severity;
+    size_t len = length >= 0 ? (size_t)length : strlen(message);
+    len = std::min(len, sizeof(m.text) - 1);
+    memcpy(m.text, message, len);
+    m.text[len] = 0;
+    m.length = (uint16_t)len;
+
+    if (self->settings.mode == GLDebugMode::Sync)
+    {
+        std::string line = Format(m, 1);
+        fwrite(line.data(), 1, line.size(), stderr);
+        return;
+    }
+
+    if (!self->Push(m))
+        self->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Bounded MPMC queue (Vyukov); the driver may call back from several threads.
+bool GLDiagnostics::Push(const Message &m)
+{
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot &slot = slots[pos & (QueueCapacity - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.message = m;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+}
+
+bool GLDiagnostics::Pop(Message &m)
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot &slot = slots[pos & (QueueCapacity - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                m = slot.message;
+                slot.sequence.store(pos + QueueCapacity, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t GLDiagnostics::Key(const Message &m)
+{
+    // FNV-1a over the identifying fields and text
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void *data, size_t size)
+    {
+        auto *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++)
+            h = (h ^ bytes[i]) * 1099511628211ull;
+    };
+    mix(&m.source, sizeof(m.source));
+    mix(&m.type, sizeof(m.type));
+    mix(&m.id, sizeof(m.id));
+    mix(&m.severity, sizeof(m.severity));
+    mix(m.text, m.length);
+    return h;
+}
+
+std::string GLDiagnostics::Format(const Message &m, uint32_t repeats)
+{
+    std::string line = "OpenGL Debug Message [" + std::to_string(m.id) + "] (" +
+                       SeverityName(m.severity) + "): " + m.text;
+    if (repeats > 1)
+        line += " (x" + std::to_string(repeats) + ")";
+    line += '\n';
+    return line;
+}
+
+void GLDiagnostics::Drain()
+{
+    if (settings.mode != GLDebugMode::Async)
+        return;
+
+    if (std::chrono::steady_clock::now() - windowStart >= std::chrono::seconds(1))
+        EndWindow();
+
+    // fold identical messages from this frame into one line
+    std::vector<std::pair<Message, uint32_t>> frame;
+    std::unordered_map<uint64_t, size_t> frameIndex;
+    Message m;
+    while (Pop(m))
+    {
+        uint64_t key = Key(m);
+        auto [it, inserted] = frameIndex.try_emplace(key, frame.size());
+        if (inserted)
+            frame.push_back({m, 1});
+        else
+            frame[it->second].second++;
+    }
+
+    std::string out;
+    for (auto &[message, repeats] : frame)
+    {
+        uint32_t &seen = windowCounts[Key(message)];
+        seen += repeats;
+        if (seen > repeats)
+        {
+            // already printed this window, counted again in the summary
+            deduplicated += repeats;
+            windowSuppressed += repeats;
+            continue;
+        }
+        if (windowPrinted >= settings.maxMessagesPerSecond)
+        {
+            rateLimited += repeats;
+            windowSuppressed += repeats;
+            continue;
+        }
+        windowPrinted++;
+        printed++;
+        deduplicated += repeats - 1;
+        out += Format(message, repeats);
+    }
+
+    uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+    if (droppedNow != reportedDropped)
+    {
+        out += "[GL] Debug queue full, dropped " + std::to_string(droppedNow - reportedDropped) + " messages\n";
+        reportedDropped = droppedNow;
+    }
+
+    if (!out.empty())
+        fwrite(out.data(), 1, out.size(), stderr);
+}
+
+void GLDiagnostics::EndWindow()
+{
+    if (windowSuppressed > 0)
+        fprintf(stderr, "[GL] Suppressed %llu repeated or rate-limited debug messages in the last second\n",
+                (unsigned long long)windowSuppressed);
+    windowCounts.clear();
+    windowPrinted = 0;
+    windowSuppressed = 0;
+    windowStart = std::chrono::steady_clock::now();
+}
+
+GLDiagnostics::Stats GLDiagnostics::GetStats() const
+{
+    Stats s;
+    s.printed = printed;
+    s.deduplicated = deduplicated;
+    s.rateLimited = rateLimited;
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t GLDiagnostics::SuppressedCount() const
+{
+    Stats s = GetStats();
+    return s.deduplicated + s.rateLimited + s.dropped;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "lib_include.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class GLDebugMode
+{
+    Off,   // no debug context, no callback
+    Async, // callback enqueues, messages are printed when Drain() runs
+    Sync,  // GL_DEBUG_OUTPUT_SYNCHRONOUS, printed from inside the callback
+};
+
+struct GLDiagnosticsSettings
+{
+#ifdef _DEBUG
+    GLDebugMode mode = GLDebugMode::Async;
+#else
+    GLDebugMode mode = GLDebugMode::Off;
+#endif
+    GLenum minSeverity = GL_DEBUG_SEVERITY_LOW; // messages below this are filtered in the driver
+    std::vector<GLuint> ignoredIds;
+    uint32_t maxMessagesPerSecond = 20;
+};
+
+/// @brief Routes GL_KHR_debug output. In async mode the driver callback only
+/// copies the message into a fixed size lock-free queue; the render thread
+/// drains it once per frame, folding repeats together and rate limiting output.
+class GLDiagnostics
+{
+public:
+    struct Stats
+    {
+        uint64_t printed = 0;
+        uint64_t deduplicated = 0; // identical to a message already printed this window
+        uint64_t rateLimited = 0;  // over maxMessagesPerSecond
+        uint64_t dropped = 0;      // queue was full
+    };
+
+    /// @brief Needs a current context. The window must have been created with
+    /// GLFW_OPENGL_DEBUG_CONTEXT for most drivers to report anything.
+    void Init(const GLDiagnosticsSettings &settings);
+    /// @brief Call once per frame from the render thread.
+    void Drain();
+    Stats GetStats() const;
+    uint64_t SuppressedCount() const;
+
+private:
+    struct Message
+    {
+        GLenum source, type, severity;
+        GLuint id;
+        uint16_t length;
+        char text[256];
+    };
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        Message message;
+    };
+    static constexpr size_t QueueCapacity = 1024; // power of two
+
+    static void APIENTRY Callback(GLenum source, GLenum type, GLuint id,
+                                  GLenum severity, GLsizei length,
+                                  const GLchar *message, const void *userParam);
+    bool Push(const Message &m);
+    bool Pop(Message &m);
+    void EndWindow();
+    static std::string Format(const Message &m, uint32_t repeats);
+    static uint64_t Key(const Message &m);
+
+    GLDiagnosticsSettings settings;
+
+    std::array<Slot, QueueCapacity> slots;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    std::atomic<uint64_t> dropped{0};
+
+    // render thread only
+    std::chrono::steady_clock::time_point windowStart;
+    std::unordered_map<uint64_t, uint32_t> windowCounts;
+    uint32_t windowPrinted = 0;
+    uint64_t windowSuppressed = 0;
+    uint64_t printed = 0, deduplicated = 0, rateLimited = 0;
+    uint64_t reportedDropped = 0;
+};
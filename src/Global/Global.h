@@ -8,6 +8,7 @@
 #include <optional>
 #include <cstdlib>
 #include <cstdio>
+#include "IO/HelperExecutor.h"
 
 namespace fs = std::filesystem;
 
@@ -70,11 +71,11 @@ static std::optional<std::string> FindScriptByPath(const std::string& name,
 
 namespace PlatformOpen
 {
+    // Fire-and-forget: the command is launched detached from the helper executor, so closing
+    // the app leaves whatever it opened running.
     static void Run(const std::string& cmd)
     {
-        int rc = system(cmd.c_str());
-        if (rc != 0)
-            fprintf(stderr, "[PlatformOpen] Failed: %s\n", cmd.c_str());
+        HelperExecutor::Shared().Run({.command = cmd, .detached = true});
     }
 
     static void OpenFile(const std::string& path)
@@ -88,8 +89,7 @@ namespace PlatformOpen
 
     static bool CommandExists(const char* cmd)
     {
-    std::string test = std::string("command -v ") + cmd + " >/dev/null 2>&1";
-    return system(test.c_str()) == 0;
+        return HelperExecutor::Shared().CommandExists(cmd);
     }
 
 };
\ No newline at end of file
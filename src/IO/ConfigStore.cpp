@@ -0,0 +1,152 @@
+#include "ConfigStore.h"
+#include <cstdio>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+ConfigStore::ConfigStore(IOWorker *io, fs::path _path) : ioWorker(io), path(std::move(_path))
+{
+  Load();
+}
+
+void ConfigStore::ApplyDefaults()
+{
+  if (!data.is_object())
+    data = json::object();
+  if (!data.contains("scriptPaths") || !data["scriptPaths"].is_array() || data["scriptPaths"].empty())
+    data["scriptPaths"] = {"Scripts"};
+  data["schemaVersion"] = SchemaVersion;
+}
+
+void ConfigStore::Load()
+{
+  std::error_code ec;
+  bool needsWrite = false;
+
+  if (fs::exists(path, ec))
+  {
+    std::ifstream f(path);
+    data = json::parse(f, nullptr, false);
+    f.close();
+
+    const bool valid = !data.is_discarded() && data.is_object() &&
+                       data.value("schemaVersion", 0) >= 1;
+    if (!valid)
+    {
+      fs::path aside = path;
+      aside += ".corrupt";
+      fs::rename(path, aside, ec);
+      fprintf(stderr, "[WARN] %s is corrupt, moved to %s and using defaults\n",
+              path.string().c_str(), aside.string().c_str());
+      data = json::object();
+      needsWrite = true;
+    }
+    else if (data.value("schemaVersion", 0) > SchemaVersion)
+      fprintf(stderr, "[WARN] %s has a newer schema (%d), unknown keys are kept as-is\n",
+              path.string().c_str(), data.value("schemaVersion", 0));
+  }
+  else
+  {
+    // migrate the search paths from the old single-purpose file
+    data = json::object();
+    fs::path legacy = path.parent_path() / "paths.json";
+    std::ifstream f(legacy);
+    json old = json::parse(f, nullptr, false);
+    if (!old.is_discarded() && old.contains("scriptPaths") && old["scriptPaths"].is_array())
+      data["scriptPaths"] = old["scriptPaths"];
+    needsWrite = true;
+  }
+
+  ApplyDefaults();
+  if (needsWrite)
+    MarkDirty();
+}
+
+void ConfigStore::MarkDirty()
+{
+  dirty = true;
+  lastEdit = std::chrono::steady_clock::now();
+}
+
+void ConfigStore::Update()
+{
+  if (dirty && std::chrono::steady_clock::now() - lastEdit >= debounce)
+    FlushNow();
+}
+
+void ConfigStore::FlushNow()
+{
+  if (!dirty)
+    return;
+  dirty = false;
+
+  // the worker is FIFO, so the newest snapshot is always the last one written
+  ioWorker->Submit([target = path, bytes = data.dump(2)]() -> IOWorker::Completion
+                   {
+    if (!WriteAtomic(target, bytes))
+      fprintf(stderr, "[ERROR] Failed to write %s\n", target.string().c_str());
+    return nullptr; });
+}
+
+bool ConfigStore::WriteAtomic(const fs::path &target, const std::string &bytes)
+{
+  std::error_code ec;
+  if (target.has_parent_path())
+    fs::create_directories(target.parent_path(), ec);
+
+  fs::path tmp = target;
+  tmp += ".tmp";
+
+#if defined(_WIN32)
+  FILE *f = fopen(tmp.string().c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size() && fflush(f) == 0 &&
+            _commit(_fileno(f)) == 0;
+  ok = (fclose(f) == 0) && ok;
+#else
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  bool ok = true;
+  size_t written = 0;
+  while (ok && written < bytes.size())
+  {
+    ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+    ok = n > 0;
+    if (ok)
+      written += n;
+  }
+  ok = ok && fsync(fd) == 0;
+  ok = (close(fd) == 0) && ok;
+#endif
+
+  if (!ok)
+  {
+    fs::remove(tmp, ec);
+    return false;
+  }
+
+  fs::rename(tmp, target, ec);
+  if (ec)
+    return false;
+
+#if !defined(_WIN32)
+  // persist the rename itself
+  int dir = open(target.has_parent_path() ? target.parent_path().c_str() : ".", O_RDONLY);
+  if (dir >= 0)
+  {
+    fsync(dir);
+    close(dir);
+  }
+#endif
+  return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "IOWorker.h"
+#include <chrono>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Single owner of Config/config.json (search paths, window, launcher and
+// save preferences). Edits land in memory immediately and are written on
+// the IO worker once they have been quiet for a short debounce, as one
+// atomic replace (temp file, fsync, rename). A corrupt or unreadable file
+// is moved aside and the defaults are used instead of throwing.
+class ConfigStore
+{
+public:
+  static constexpr int SchemaVersion = 1;
+
+  explicit ConfigStore(IOWorker *io, std::filesystem::path path = "Config/config.json");
+
+  // Keys are JSON pointers, e.g. "/window/width".
+  template <typename T>
+  T Get(const std::string &key, const T &fallback) const
+  {
+    const nlohmann::json::json_pointer ptr(key);
+    if (!data.contains(ptr))
+      return fallback;
+    try
+    {
+      return data.at(ptr).get<T>();
+    }
+    catch (const nlohmann::json::exception &)
+    {
+      return fallback;
+    }
+  }
+
+  template <typename T>
+  void Set(const std::string &key, const T &value)
+  {
+    const nlohmann::json::json_pointer ptr(key);
+    nlohmann::json next = value;
+    if (data.contains(ptr) && data.at(ptr) == next)
+      return;
+    data[ptr] = std::move(next);
+    MarkDirty();
+  }
+
+  // Call once per frame; submits the write once the debounce has elapsed.
+  void Update();
+  // Submits any pending write right away (shutdown).
+  void FlushNow();
+  bool IsDirty() const { return dirty; }
+
+  static bool WriteAtomic(const std::filesystem::path &path, const std::string &bytes);
+
+private:
+  void Load();
+  void MarkDirty();
+  void ApplyDefaults();
+
+  IOWorker *ioWorker;
+  std::filesystem::path path;
+  nlohmann::json data;
+  bool dirty = false;
+  std::chrono::steady_clock::time_point lastEdit;
+  std::chrono::milliseconds debounce{500};
+};
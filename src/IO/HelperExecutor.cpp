@@ -0,0 +1,269 @@
+#include "HelperExecutor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char **environ;
+#endif
+
+HelperExecutor::~HelperExecutor()
+{
+  // running helpers are killed rather than waited on; detached launches were never tracked
+  cancelAll = true;
+  std::lock_guard lock(threadMutex);
+  for (auto &task : tasks)
+    if (task.thread.joinable())
+      task.thread.join();
+}
+
+HelperExecutor &HelperExecutor::Shared()
+{
+  static HelperExecutor instance;
+  return instance;
+}
+
+void HelperExecutor::Run(Request request, Callback done)
+{
+  ReapFinished();
+
+  running++;
+  std::lock_guard lock(threadMutex);
+  Task &task = tasks.emplace_back();
+  task.thread = std::thread([this, &task, request = std::move(request), done = std::move(done)]()
+                            {
+    Result result = Execute(request, cancelAll);
+    if (result.timedOut)
+      fprintf(stderr, "[WARN] Helper timed out: %s\n", request.command.c_str());
+    else if (result.exitCode != 0 && !request.captureOutput)
+      fprintf(stderr, "[PlatformOpen] Failed: %s\n", request.command.c_str());
+
+    if (done)
+    {
+      std::lock_guard lock(completionMutex);
+      completions.push_back([done, result]() mutable { done(result); });
+    }
+    running--;
+    task.finished = true; });
+}
+
+void HelperExecutor::PollCompletions()
+{
+  std::deque<std::function<void()>> ready;
+  {
+    std::lock_guard lock(completionMutex);
+    ready.swap(completions);
+  }
+  for (auto &done : ready)
+    done();
+
+  ReapFinished();
+}
+
+void HelperExecutor::ReapFinished()
+{
+  std::lock_guard lock(threadMutex);
+  for (auto it = tasks.begin(); it != tasks.end();)
+  {
+    if (it->finished)
+    {
+      it->thread.join();
+      it = tasks.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+bool HelperExecutor::CommandExists(const std::string &name)
+{
+  {
+    std::lock_guard lock(probeMutex);
+    auto it = probeCache.find(name);
+    if (it != probeCache.end())
+      return it->second;
+  }
+
+  bool found = false;
+  const char *pathEnv = getenv("PATH");
+  if (pathEnv)
+  {
+#if defined(_WIN32)
+    const char separator = ';';
+    const std::vector<std::string> suffixes = {".exe", ".bat", ".cmd", ""};
+#else
+    const char separator = ':';
+    const std::vector<std::string> suffixes = {""};
+#endif
+    std::stringstream dirs(pathEnv);
+    std::string dir;
+    while (!found && std::getline(dirs, dir, separator))
+    {
+      if (dir.empty())
+        continue;
+      for (const auto &suffix : suffixes)
+      {
+        std::filesystem::path candidate = std::filesystem::path(dir) / (name + suffix);
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(candidate, ec))
+          continue;
+#if defined(_WIN32)
+        found = true;
+#else
+        found = access(candidate.c_str(), X_OK) == 0;
+#endif
+        if (found)
+          break;
+      }
+    }
+  }
+
+  std::lock_guard lock(probeMutex);
+  probeCache[name] = found;
+  return found;
+}
+
+void HelperExecutor::PrefetchProbes(std::vector<std::string> names)
+{
+  running++;
+  std::lock_guard lock(threadMutex);
+  Task &task = tasks.emplace_back();
+  task.thread = std::thread([this, &task, names = std::move(names)]()
+                            {
+    for (const auto &name : names)
+      CommandExists(name);
+    running--;
+    task.finished = true; });
+}
+
+#if defined(_WIN32)
+
+HelperExecutor::Result HelperExecutor::Execute(const Request &request, const std::atomic<bool> &)
+{
+  // no portable way to kill a _popen child here, so the timeout is not enforced
+  Result result;
+  FILE *pipe = _popen(request.command.c_str(), "r");
+  if (!pipe)
+    return result;
+
+  char buffer[512];
+  while (fgets(buffer, sizeof(buffer), pipe))
+    if (request.captureOutput)
+      result.output += buffer;
+  result.exitCode = _pclose(pipe);
+  return result;
+}
+
+#else
+
+HelperExecutor::Result HelperExecutor::Execute(const Request &request, const std::atomic<bool> &cancel)
+{
+  Result result;
+
+  int fds[2] = {-1, -1};
+  if (pipe(fds) != 0)
+    return result;
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  if (request.captureOutput)
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+  else
+    // openers like xdg-open leave children behind that would otherwise hold the pipe open
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+  // own process group so a timeout can take down the whole shell pipeline
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+  posix_spawnattr_setpgroup(&attr, 0);
+
+  // detached: the shell backgrounds the command and exits at once, so the command is
+  // reparented away from us and nothing below can signal it
+  const std::string command = request.detached ? "(" + request.command + ") &" : request.command;
+#if defined(POSIX_SPAWN_SETSID)
+  if (request.detached)
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID);
+#endif
+
+  const char *argv[] = {"sh", "-c", command.c_str(), nullptr};
+  pid_t pid = -1;
+  int rc = posix_spawn(&pid, "/bin/sh", &actions, &attr, const_cast<char *const *>(argv), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attr);
+  close(fds[1]);
+
+  if (rc != 0)
+  {
+    close(fds[0]);
+    return result;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  const auto deadline = Clock::now() + request.timeout;
+  bool pipeOpen = true;
+  int status = 0;
+  bool exited = false;
+
+  while (!exited)
+  {
+    if (pipeOpen)
+    {
+      pollfd pfd{fds[0], POLLIN, 0};
+      if (poll(&pfd, 1, 50) > 0)
+      {
+        char buffer[512];
+        ssize_t n = read(fds[0], buffer, sizeof(buffer));
+        if (n > 0)
+          result.output.append(buffer, n);
+        else
+          pipeOpen = false;
+      }
+    }
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    exited = waitpid(pid, &status, WNOHANG) == pid;
+    if (exited)
+      break;
+
+    const bool expired = request.timeout.count() > 0 && Clock::now() >= deadline;
+    if (!request.detached && (expired || cancel))
+    {
+      result.timedOut = expired;
+      kill(-pid, SIGTERM);
+      waitpid(pid, &status, 0);
+      exited = true;
+    }
+  }
+
+  // pick up anything written just before exit
+  if (pipeOpen && !result.timedOut)
+  {
+    pollfd pfd{fds[0], POLLIN, 0};
+    char buffer[512];
+    while (poll(&pfd, 1, 0) > 0)
+    {
+      ssize_t n = read(fds[0], buffer, sizeof(buffer));
+      if (n <= 0)
+        break;
+      result.output.append(buffer, n);
+    }
+  }
+  close(fds[0]);
+
+  if (!result.timedOut && WIFEXITED(status))
+    result.exitCode = WEXITSTATUS(status);
+  return result;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Runs external helper programs (directory pickers, file openers, editors)
+// off the render thread. Each command gets its own thread so a picker left
+// open does not hold up anything else; results come back through a queue
+// drained by PollCompletions() once per frame.
+class HelperExecutor
+{
+public:
+  struct Request
+  {
+    std::string command;
+    bool captureOutput = false;
+    std::chrono::milliseconds timeout{0}; // 0 = wait forever
+    // Launches (editors, openers) run in their own session and are not waited on,
+    // so they are never cancelled and outlive the app.
+    bool detached = false;
+  };
+
+  struct Result
+  {
+    int exitCode = -1;
+    bool timedOut = false;
+    std::string output;
+  };
+
+  using Callback = std::function<void(Result &)>;
+
+  HelperExecutor() = default;
+  ~HelperExecutor();
+  HelperExecutor(const HelperExecutor &) = delete;
+  HelperExecutor &operator=(const HelperExecutor &) = delete;
+
+  // Shared instance used by PlatformOpen and the windows.
+  static HelperExecutor &Shared();
+
+  void Run(Request request, Callback done = nullptr);
+  void PollCompletions();
+  size_t RunningCount() const { return running.load(); }
+
+  // PATH lookup, cached for the lifetime of the process.
+  bool CommandExists(const std::string &name);
+  // Resolves the given probes on a background thread so the first frame never pays for them.
+  void PrefetchProbes(std::vector<std::string> names);
+
+private:
+  static Result Execute(const Request &request, const std::atomic<bool> &cancel);
+  void ReapFinished();
+
+  std::mutex completionMutex;
+  std::deque<std::function<void()>> completions;
+
+  std::mutex threadMutex;
+  struct Task
+  {
+    std::thread thread;
+    std::atomic<bool> finished{false};
+  };
+  std::list<Task> tasks;
+  std::atomic<size_t> running{0};
+  std::atomic<bool> cancelAll{false};
+
+  std::mutex probeMutex;
+  std::unordered_map<std::string, bool> probeCache;
+};
@@ -0,0 +1,109 @@
+#include "IOWorker.h"
+
+IOWorker::IOWorker()
+{
+  worker = std::thread(&IOWorker::WorkerLoop, this);
+}
+
+IOWorker::~IOWorker()
+{
+  {
+    std::lock_guard lock(jobMutex);
+    stopping = true;
+  }
+  jobCv.notify_all();
+  // queued writes are still drained before the thread exits
+  if (worker.joinable())
+    worker.join();
+}
+
+void IOWorker::Submit(Job job)
+{
+  pending++;
+  {
+    std::lock_guard lock(jobMutex);
+    jobs.push_back(std::move(job));
+  }
+  jobCv.notify_one();
+}
+
+void IOWorker::Post(Completion done)
+{
+  std::lock_guard lock(completionMutex);
+  completions.push_back(std::move(done));
+}
+
+void IOWorker::PollCompletions()
+{
+  std::deque<Completion> ready;
+  {
+    std::lock_guard lock(completionMutex);
+    ready.swap(completions);
+  }
+
+  for (auto &done : ready)
+    if (done)
+      done();
+}
+
+void IOWorker::LogError(const char *what, std::exception_ptr error)
+{
+  try
+  {
+    std::rethrow_exception(error);
+  }
+  catch (const std::exception &e)
+  {
+    fprintf(stderr, "[ERROR] %s: %s\n", what, e.what());
+  }
+  catch (...)
+  {
+    fprintf(stderr, "[ERROR] %s: unknown exception\n", what);
+  }
+}
+
+void IOWorker::Flush()
+{
+  std::unique_lock lock(jobMutex);
+  idleCv.wait(lock, [this]
+              { return jobs.empty() && pending.load() == 0; });
+}
+
+void IOWorker::WorkerLoop()
+{
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock lock(jobMutex);
+      jobCv.wait(lock, [this]
+                 { return stopping || !jobs.empty(); });
+      if (jobs.empty())
+        return;
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    Completion done;
+    try
+    {
+      done = job();
+    }
+    catch (...)
+    {
+      LogError("IO job failed", std::current_exception());
+    }
+
+    if (done)
+    {
+      std::lock_guard lock(completionMutex);
+      completions.push_back(std::move(done));
+    }
+
+    {
+      std::lock_guard lock(jobMutex);
+      pending--;
+    }
+    idleCv.notify_all();
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Single background thread for file system work (save load/store, directory
+// listing, config writes). Jobs run in submission order; each job returns a
+// completion that is queued and executed on the UI thread by PollCompletions().
+class IOWorker
+{
+public:
+  using Completion = std::function<void()>;
+  using Job = std::function<Completion()>;
+
+  IOWorker();
+  ~IOWorker();
+  IOWorker(const IOWorker &) = delete;
+  IOWorker &operator=(const IOWorker &) = delete;
+
+  void Submit(Job job);
+
+  // Runs work() on the worker and hands its result to done() on the UI thread.
+  // If work() throws, failed(std::exception_ptr) runs on the UI thread instead,
+  // so exactly one of the two always follows a Submit.
+  template <typename Work, typename Done, typename Failed>
+  void Submit(Work work, Done done, Failed failed)
+  {
+    Submit(Job([work = std::move(work), done = std::move(done), failed = std::move(failed)]() mutable -> Completion
+               {
+      try
+      {
+        auto result = std::make_shared<decltype(work())>(work());
+        return [done, result]() mutable { done(*result); };
+      }
+      catch (...)
+      {
+        return [failed, error = std::current_exception()]() mutable { failed(error); };
+      } }));
+  }
+
+  // As above, for callers with nothing to undo: a failure is only logged.
+  template <typename Work, typename Done>
+  void Submit(Work work, Done done)
+  {
+    Submit(std::move(work), std::move(done), [](std::exception_ptr error)
+           { LogError("IO job failed", error); });
+  }
+
+  static void LogError(const char *what, std::exception_ptr error);
+
+  // Queues a completion directly, e.g. progress from inside a running job.
+  void Post(Completion done);
+
+  // Call once per frame from the render thread.
+  void PollCompletions();
+
+  // Blocks until every submitted job has run (completions are not executed).
+  void Flush();
+
+  size_t PendingCount() const { return pending.load(); }
+  bool IsBusy() const { return pending.load() != 0; }
+
+private:
+  void WorkerLoop();
+
+  std::mutex jobMutex;
+  std::condition_variable jobCv;
+  std::condition_variable idleCv;
+  std::deque<Job> jobs;
+
+  std::mutex completionMutex;
+  std::deque<Completion> completions;
+
+  std::atomic<size_t> pending{0};
+  bool stopping = false;
+  std::thread worker;
+};
@@ -9,21 +9,34 @@ pathsWindow(&(buttonsWindow.GetSearchPaths()), &buttonsWindow)
 
 void MainWindow::OnStart()
 {
+  int width = config.Get("/window/width", (int)properties.winSizeX);
+  int height = config.Get("/window/height", (int)properties.winSizeY);
+  if (width > 0 && height > 0)
+    glfwSetWindowSize(window, width, height);
+
   buttonsWindow.LoadButtonSearchPaths();
   buttonsWindow.ReloadScripts(true);
+  HelperExecutor::Shared().PrefetchProbes({"zenity", "kdialog", "xdg-open", "konsole",
+                                           "gnome-terminal", "xfce4-terminal", "x-terminal-emulator"});
   ImFontConfig cfg;
   cfg.SizePixels = 32.0f;
   ImGui::GetIO().Fonts->AddFontDefault(&cfg);
+
+  const bool retained = config.Get("/ui/retainedPanels", false);
+  for (PanelCache *cache : {&buttonsCache, &pathsCache, &savesCache})
+    cache->SetEnabled(retained);
 }
 
 void MainWindow::OnUpdate()
 {
+  ioWorker.PollCompletions();
+  HelperExecutor::Shared().PollCompletions();
+  savesWindow.Update();
+  config.Update();
 }
 
 void MainWindow::OnRender()
 {
-  static int activeWindow = 0;
-
   ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
   ImGui::SetNextWindowPos(ImVec2(0, 0));
   ImGui::Begin("My Tools###ToolsWindow", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoFocusOnAppearing);
@@ -33,22 +46,34 @@ void MainWindow::OnRender()
   {
     if (ImGui::BeginTabItem("Buttons"))
     {
-      buttonsWindow.Render();
-      activeWindow = 0;
+      if (buttonsCache.Begin("##ButtonsPanel", buttonsWindow.GetRevision()))
+      {
+        buttonsWindow.Render();
+        buttonsCache.End();
+      }
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Paths"))
     {
-      pathsWindow.Render();
-      activeWindow = 1;
+      if (pathsCache.Begin("##PathsPanel", pathsWindow.GetRevision()))
+      {
+        pathsWindow.Render();
+        pathsCache.End();
+      }
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Saves"))
     {
-      if (activeWindow != 2)
-        savesWindow.ReloadSaves();  // auto-refresh
-      savesWindow.Render();
-      activeWindow = 2;
+      if (savesCache.Begin("##SavesPanel", savesWindow.GetRevision()))
+      {
+        savesWindow.Render();
+        savesCache.End();
+      }
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Profiler"))
+    {
+      profilerWindow.Render();
       ImGui::EndTabItem();
     }
     
@@ -59,8 +84,22 @@ void MainWindow::OnRender()
 
 void MainWindow::OnPostRender()
 {
+  for (PanelCache *cache : {&buttonsCache, &pathsCache, &savesCache})
+    cache->Capture();
 }
 
 void MainWindow::OnShutdown()
 {
+  int width, height;
+  glfwGetWindowSize(window, &width, &height);
+  config.Set("/window/width", width);
+  config.Set("/window/height", height);
+
+  // let pending save/config writes land before the windows go away
+  config.FlushNow();
+  ioWorker.Flush();
+
+  // the captures are pooled render targets, released while the context still exists
+  for (PanelCache *cache : {&buttonsCache, &pathsCache, &savesCache})
+    cache->Invalidate();
 }
\ No newline at end of file
@@ -4,6 +4,11 @@
 #include "ButtonsWindow/ScriptMacro.h"
 #include "SavesWindow/SavesWindow.h"
 #include "PathsWindow/PathsWindow.h"
+#include "ProfilerWindow/ProfilerWindow.h"
+#include "IO/IOWorker.h"
+#include "IO/ConfigStore.h"
+#include "IO/HelperExecutor.h"
+#include "Extra/PanelCache.h"
 #include <iostream>
 
 class MainWindow : public App
@@ -17,7 +22,12 @@ public:
   void OnShutdown() override;
 
 private:
-  ButtonsWindow buttonsWindow;
-  SavesWindow savesWindow{&buttonsWindow};
+  IOWorker ioWorker; // declared first: everything below holds pointers to it
+  ConfigStore config{&ioWorker};
+  ButtonsWindow buttonsWindow{&ioWorker, &config};
+  SavesWindow savesWindow{&buttonsWindow, &ioWorker, &config};
   PathsWindow pathsWindow;
+  ProfilerWindow profilerWindow;
+  // the mostly static tabs draw as one quad while nothing about them changes
+  PanelCache buttonsCache, pathsCache, savesCache;
 };
\ No newline at end of file
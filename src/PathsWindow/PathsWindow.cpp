@@ -24,64 +24,14 @@ void PathsWindow::Render()
   RenderFullWidthInput("##newpath", inputBuf, sizeof(inputBuf));
 
   // --- OS directory picker ---
+  ImGui::BeginDisabled(pickerOpen);
   if (ImGui::Button("Browse…"))
+    OpenDirectoryPicker();
+  ImGui::EndDisabled();
+  if (pickerOpen)
   {
-    char buffer[512] = {0};
-
-#if defined(_WIN32)
-    FILE *pipe = _popen(
-        "powershell -NoProfile -Command \""
-        "$f = New-Object System.Windows.Forms.FolderBrowserDialog;"
-        "if ($f.ShowDialog() -eq 'OK') { Write-Output $f.SelectedPath }\"",
-        "r");
-
-#elif defined(__linux__)
-        FILE* pipe = nullptr;
-
-    // Ensure we are in a GUI session
-    const char* display = getenv("DISPLAY");
-    const char* wayland = getenv("WAYLAND_DISPLAY");
-
-    if ((display || wayland) && PlatformOpen::CommandExists("zenity"))
-    {
-        pipe = popen("zenity --file-selection --directory 2>/dev/null", "r");
-    }
-    else if ((display || wayland) && PlatformOpen::CommandExists("kdialog"))
-    {
-        pipe = popen("kdialog --getexistingdirectory 2>/dev/null", "r");
-    }
-    else
-    {
-        fprintf(stderr,
-            "[PathsWindow] No GUI directory picker available "
-            "(install zenity or kdialog)\n");
-    }
-#else
-    FILE *pipe = nullptr;
-#endif
-
-    if (pipe)
-    {
-      fgets(buffer, sizeof(buffer), pipe);
-#if defined(_WIN32)
-      _pclose(pipe);
-#else
-      pclose(pipe);
-#endif
-
-      std::string path = buffer;
-
-      // trim newline
-      path.erase(std::remove(path.begin(), path.end(), '\n'), path.end());
-      path.erase(std::remove(path.begin(), path.end(), '\r'), path.end());
-
-      if (!path.empty())
-      {
-        std::string rel = NormalizeRelative(path);
-        scriptSearchPaths->push_back(rel);
-        SaveSearchPaths();
-      }
-    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("Waiting for directory picker...");
   }
 
   ImGui::Separator();
@@ -97,6 +47,72 @@ void PathsWindow::Render()
   }
 }
 
+uint64_t PathsWindow::GetRevision() const
+{
+  uint64_t h = pickerOpen ? 1 : 0;
+  for (const auto& p : *scriptSearchPaths)
+    h = (h ^ std::hash<std::string>{}(p)) * 0x100000001B3ull;
+  return h ^ scriptSearchPaths->size();
+}
+
+void PathsWindow::OpenDirectoryPicker()
+{
+  std::string command;
+
+#if defined(_WIN32)
+  command =
+      "powershell -NoProfile -Command \""
+      "$f = New-Object System.Windows.Forms.FolderBrowserDialog;"
+      "if ($f.ShowDialog() -eq 'OK') { Write-Output $f.SelectedPath }\"";
+
+#elif defined(__linux__)
+  // Ensure we are in a GUI session
+  const char* display = getenv("DISPLAY");
+  const char* wayland = getenv("WAYLAND_DISPLAY");
+
+  if ((display || wayland) && PlatformOpen::CommandExists("zenity"))
+  {
+    command = "zenity --file-selection --directory 2>/dev/null";
+  }
+  else if ((display || wayland) && PlatformOpen::CommandExists("kdialog"))
+  {
+    command = "kdialog --getexistingdirectory 2>/dev/null";
+  }
+  else
+  {
+    fprintf(stderr,
+        "[PathsWindow] No GUI directory picker available "
+        "(install zenity or kdialog)\n");
+  }
+#endif
+
+  if (command.empty())
+    return;
+
+  pickerOpen = true;
+  HelperExecutor::Shared().Run(
+      {command, true, pickerTimeout},
+      [this](HelperExecutor::Result& result)
+      {
+        pickerOpen = false;
+        if (result.exitCode != 0)
+          return;
+
+        std::string path = result.output;
+
+        // trim newline
+        path.erase(std::remove(path.begin(), path.end(), '\n'), path.end());
+        path.erase(std::remove(path.begin(), path.end(), '\r'), path.end());
+
+        if (!path.empty())
+        {
+          std::string rel = NormalizeRelative(path);
+          scriptSearchPaths->push_back(rel);
+          SaveSearchPaths();
+        }
+      });
+}
+
 float PathsWindow::ComputeMaxPathWidth() const
 {
     float maxWidth = 0.0f;
@@ -163,17 +179,9 @@ std::string PathsWindow::NormalizeRelative(const std::string &path)
 
 void PathsWindow::SaveSearchPaths()
 {
-  json j;
-  j["scriptPaths"] = *scriptSearchPaths;
-
-  if (!std::filesystem::exists("Config"))
-    std::filesystem::create_directory("Config");
-
-  std::ofstream("Config/paths.json") << std::setw(2) << j;
-
-  
+  // debounced write through the config store; the rescan runs on the IO worker
   buttonsWindow->SaveButtonSearchPaths();
-  buttonsWindow->ReloadScripts();
+  buttonsWindow->ReloadScriptsAsync();
 }
 
 float PathsWindow::ComputeUniformButtonWidth(std::initializer_list<const char*> labels) const
@@ -8,6 +8,8 @@
 #include "ButtonsWindow/ButtonsWindow.h"
 #include "ButtonsWindow/ScriptMacro.h"
 #include "Global/Global.h"
+#include "IO/HelperExecutor.h"
+#include <chrono>
 
 class PathsWindow
 {
@@ -16,13 +18,19 @@ public:
         : scriptSearchPaths(pathsRef), buttonsWindow(buttons) {}
 
     void Render();
+    // Changes with the search paths and picker state; the list is short, so it is hashed each call.
+    uint64_t GetRevision() const;
 
 private:
     std::vector<std::string>* scriptSearchPaths;
     ButtonsWindow* buttonsWindow;
+    bool pickerOpen = false;
+    // a picker nobody answers is closed instead of lingering forever
+    std::chrono::milliseconds pickerTimeout = std::chrono::minutes(10);
 
 public:
     void SaveSearchPaths();
+    void OpenDirectoryPicker();
     float ComputeMaxPathWidth() const;
     void RenderPathRow(int index, float maxWidth);
     float ComputeUniformButtonWidth(std::initializer_list<const char*> labels) const;
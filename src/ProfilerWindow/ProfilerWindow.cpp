@@ -0,0 +1,222 @@
+#include "ProfilerWindow.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+// stable colour per scope name, darker on the GPU track
+static ImU32 ScopeColor(const char *name, bool gpu)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = name; *c; c++)
+        hash = (hash ^ uint8_t(*c)) * 16777619u;
+    return ImColor::HSV(float(hash % 360) / 360.0f, 0.55f, gpu ? 0.65f : 0.85f);
+}
+
+// the export path with the extension of the chosen format, so a CSV never lands in the trace file
+static std::string ExportPathFor(const std::string &path, const char *extension)
+{
+    return std::filesystem::path(path).replace_extension(extension).string();
+}
+
+void ProfilerWindow::Render()
+{
+    Profiler &profiler = Profiler::Shared();
+    const auto &history = profiler.GetHistory();
+
+    bool recording = profiler.IsEnabled();
+    if (ImGui::Checkbox("Record", &recording))
+        profiler.SetEnabled(recording);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+    {
+        profiler.ClearHistory();
+        selectedFrame = 0;
+    }
+    ImGui::SameLine();
+    const Profiler::Stats stats = profiler.GetStats();
+    ImGui::TextDisabled("%s | %zu queries | %zu frames in flight | %llu frames CPU only",
+                        profiler.HasGpuTimers() ? "GPU timers" : "no GPU timers", stats.queriesAllocated,
+                        stats.framesInFlight, (unsigned long long)stats.gpuFramesSkipped);
+
+    if (ImGui::Button("Export trace"))
+    {
+        const std::string path = ExportPathFor(exportPath, ".json");
+        exportStatus = profiler.ExportChromeTrace(path) ? "Wrote " + path : "Could not write " + path;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+    {
+        const std::string path = ExportPathFor(exportPath, ".csv");
+        exportStatus = profiler.ExportCsv(path) ? "Wrote " + path : "Could not write " + path;
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.5f);
+    ImGui::InputText("##exportPath", &exportPath);
+    if (!exportStatus.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", exportStatus.c_str());
+    }
+
+    if (history.empty())
+    {
+        ImGui::TextDisabled("%s", recording ? "Waiting for frames..." : "Recording is off");
+        return;
+    }
+
+    // history is in frame order; a selected frame that scrolled out falls back to the newest
+    auto selected = std::lower_bound(history.begin(), history.end(), selectedFrame,
+                                     [](const Profiler::Frame &f, uint64_t index) { return f.index < index; });
+    if (selectedFrame == 0 || selected == history.end() || selected->index != selectedFrame)
+    {
+        selectedFrame = 0;
+        selected = history.end() - 1;
+    }
+    bool follow = selectedFrame == 0;
+    if (ImGui::Checkbox("Newest frame", &follow))
+        selectedFrame = follow ? 0 : selected->index;
+    ImGui::SameLine();
+    int position = int(selected - history.begin());
+    ImGui::SetNextItemWidth(-1);
+    if (ImGui::SliderInt("##frame", &position, 0, (int)history.size() - 1, "history %d"))
+        selectedFrame = history[position].index;
+
+    const Profiler::Frame &frame = history[position];
+    RenderFrameTimes(history, frame.index);
+    RenderTimeline(frame);
+    RenderScopeTable(frame);
+}
+
+void ProfilerWindow::RenderFrameTimes(const std::deque<Profiler::Frame> &history, uint64_t shown)
+{
+    std::vector<double> xs, cpu, gpu;
+    for (const Profiler::Frame &frame : history)
+    {
+        xs.push_back(double(frame.index));
+        cpu.push_back(frame.cpuMs);
+        gpu.push_back(frame.gpuMs >= 0 ? frame.gpuMs : NAN);
+    }
+
+    if (!ImPlot::BeginPlot("Frame times", ImVec2(-1, ImGui::GetFontSize() * 10)))
+        return;
+    ImPlot::SetupAxes("frame", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+    ImPlot::PlotLine("CPU", xs.data(), cpu.data(), (int)xs.size());
+    ImPlot::PlotLine("GPU", xs.data(), gpu.data(), (int)xs.size());
+    const double marker = double(shown);
+    ImPlot::PlotInfLines("##shown", &marker, 1);
+
+    // click a frame to inspect it
+    if (ImPlot::IsPlotHovered() && ImGui::IsMouseClicked(0))
+    {
+        const double picked = ImPlot::GetPlotMousePos().x;
+        auto nearest = std::lower_bound(xs.begin(), xs.end(), picked);
+        if (nearest == xs.end() || (nearest != xs.begin() && picked - nearest[-1] < *nearest - picked))
+            --nearest;
+        selectedFrame = uint64_t(*nearest);
+    }
+    ImPlot::EndPlot();
+}
+
+void ProfilerWindow::RenderTimeline(const Profiler::Frame &frame)
+{
+    uint32_t rows = 1;
+    double length = std::max(frame.cpuMs, frame.gpuMs);
+    for (const Profiler::Sample &s : frame.samples)
+    {
+        rows = std::max(rows, s.depth + 2); // row 0 is the frame itself
+        length = std::max(length, s.gpuStartMs + s.gpuMs);
+    }
+    // CPU rows on top, a gap, then the same rows on the GPU track
+    const double gpuRow = rows + 1.0;
+
+    char title[64];
+    snprintf(title, sizeof(title), "Frame %llu###Timeline", (unsigned long long)frame.index);
+    if (!ImPlot::BeginPlot(title, ImVec2(-1, ImGui::GetFontSize() * (2.0f * rows + 6.0f)), ImPlotFlags_NoLegend))
+        return;
+    ImPlot::SetupAxis(ImAxis_X1, "ms");
+    ImPlot::SetupAxis(ImAxis_Y1, nullptr, ImPlotAxisFlags_Invert | ImPlotAxisFlags_NoTickLabels | ImPlotAxisFlags_Lock);
+    ImPlot::SetupAxisLimits(ImAxis_X1, 0, length > 0 ? length : 1, frame.index != fittedFrame ? ImPlotCond_Always : ImPlotCond_Once);
+    ImPlot::SetupAxisLimits(ImAxis_Y1, 0, gpuRow + rows, ImPlotCond_Always);
+
+    ImDrawList *drawList = ImPlot::GetPlotDrawList();
+    const bool hovered = ImPlot::IsPlotHovered();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    ImPlot::PushPlotClipRect();
+    auto bar = [&](const char *name, double start, double ms, double row, bool gpu)
+    {
+        const ImVec2 a = ImPlot::PlotToPixels(start, row + 0.05), b = ImPlot::PlotToPixels(start + ms, row + 0.95);
+        const ImVec2 min(std::min(a.x, b.x), std::min(a.y, b.y)), max(std::max(a.x, b.x), std::max(a.y, b.y));
+        drawList->AddRectFilled(min, max, ScopeColor(name, gpu));
+        if (max.x - min.x > ImGui::CalcTextSize(name).x + 4)
+            drawList->AddText(ImVec2(min.x + 2, min.y), IM_COL32_BLACK, name);
+        if (hovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+            ImGui::SetTooltip("%s (%s)\n%.3f ms at %.3f ms", name, gpu ? "GPU" : "CPU", ms, start);
+    };
+
+    bar("Frame", 0, frame.cpuMs, 0, false);
+    if (frame.gpuMs >= 0)
+        bar("Frame", 0, frame.gpuMs, gpuRow, true);
+    for (const Profiler::Sample &s : frame.samples)
+    {
+        bar(s.name, s.cpuStartMs, s.cpuMs, s.depth + 1.0, false);
+        if (s.gpuMs >= 0)
+            bar(s.name, s.gpuStartMs, s.gpuMs, gpuRow + s.depth + 1.0, true);
+    }
+    ImPlot::PopPlotClipRect();
+    ImPlot::EndPlot();
+    fittedFrame = frame.index;
+}
+
+void ProfilerWindow::RenderScopeTable(const Profiler::Frame &frame)
+{
+    struct Total
+    {
+        const char *name;
+        int calls = 0;
+        double cpuMs = 0, gpuMs = 0;
+        bool gpu = false;
+    };
+    std::vector<Total> totals;
+    for (const Profiler::Sample &s : frame.samples)
+    {
+        auto it = std::find_if(totals.begin(), totals.end(), [&](const Total &t) { return strcmp(t.name, s.name) == 0; });
+        if (it == totals.end())
+        {
+            totals.push_back({s.name});
+            it = totals.end() - 1;
+        }
+        it->calls++;
+        it->cpuMs += s.cpuMs;
+        if (s.gpuMs >= 0)
+        {
+            it->gpuMs += s.gpuMs;
+            it->gpu = true;
+        }
+    }
+
+    if (!ImGui::BeginTable("Scopes", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        return;
+    ImGui::TableSetupColumn("Scope");
+    ImGui::TableSetupColumn("Calls");
+    ImGui::TableSetupColumn("CPU ms");
+    ImGui::TableSetupColumn("GPU ms");
+    ImGui::TableHeadersRow();
+    for (const Total &t : totals)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(t.name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%d", t.calls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", t.cpuMs);
+        ImGui::TableNextColumn();
+        if (t.gpu)
+            ImGui::Text("%.3f", t.gpuMs);
+        else
+            ImGui::TextDisabled("-");
+    }
+    ImGui::EndTable();
+}
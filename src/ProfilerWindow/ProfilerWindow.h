@@ -0,0 +1,22 @@
+#pragma once
+#include "lib_include.h"
+#include "Extra/Profiler.h"
+#include <string>
+
+/// @brief Frame times over the profiler history and a CPU/GPU timeline of one frame,
+/// with export to a Chrome trace or CSV.
+class ProfilerWindow
+{
+public:
+    void Render();
+
+private:
+    uint64_t selectedFrame = 0; // Profiler::Frame::index, 0 follows the newest frame
+    std::string exportPath = "profile.json"; // the extension follows the export format
+    std::string exportStatus;
+    uint64_t fittedFrame = 0; // the timeline zooms to a frame when it is first shown
+
+    void RenderFrameTimes(const std::deque<Profiler::Frame> &history, uint64_t shown);
+    void RenderTimeline(const Profiler::Frame &frame);
+    void RenderScopeTable(const Profiler::Frame &frame);
+};
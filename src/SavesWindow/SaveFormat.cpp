@@ -0,0 +1,396 @@
+#include "SaveFormat.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t stringBytes;
+    };
+
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Entry
+    {
+        StringRef name, path, title, description, category;
+        uint32_t reserved[2]; // spelled out so no padding byte reaches the file
+        uint64_t size;
+        int64_t mtime;
+        uint64_t hash;
+    };
+
+    // both are written with a raw copy; every byte must belong to a member
+    static_assert(std::has_unique_object_representations_v<Header> && sizeof(Header) == 16);
+    static_assert(std::has_unique_object_representations_v<Entry> && sizeof(Entry) == 72);
+
+    StringRef AddString(std::string& blob, const std::string& s)
+    {
+        StringRef ref{(uint32_t)blob.size(), (uint32_t)s.size()};
+        blob += s;
+        return ref;
+    }
+
+    bool GetString(const std::string& blob, StringRef ref, std::string& out)
+    {
+        if ((uint64_t)ref.offset + ref.length > blob.size())
+            return false;
+        out.assign(blob, ref.offset, ref.length);
+        return true;
+    }
+
+    bool StatScript(const std::string& path, uint64_t& size, int64_t& mtime)
+    {
+        std::error_code ec;
+        size = fs::file_size(path, ec);
+        if (ec)
+            return false;
+        auto time = fs::last_write_time(path, ec);
+        if (ec)
+            return false;
+        mtime = time.time_since_epoch().count();
+        return true;
+    }
+
+    bool ReadContent(const std::string& path, std::string& content)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool WriteReplace(const fs::path& path, const std::string& bytes)
+    {
+        std::error_code ec;
+        if (path.has_parent_path())
+            fs::create_directories(path.parent_path(), ec);
+
+        fs::path tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            file.write(bytes.data(), bytes.size());
+            if (!file)
+                return false;
+        }
+        fs::rename(tmp, path, ec);
+        return !ec;
+    }
+}
+
+uint64_t SaveFormat::HashBytes(const void* data, size_t size)
+{
+    // FNV-1a, 64 bit
+    uint64_t h = 1469598103934665603ull;
+    auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    return h;
+}
+
+void SaveFormat::StampScript(ScriptMacro& script)
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!StatScript(script.path, size, mtime))
+        return;
+
+    // the recorded hash is still good if the file has not been touched
+    if (script.hash != 0 && script.size == size && script.mtime == mtime)
+        return;
+
+    // the cached content can be a same-length older version, so hash what is on disk
+    std::string content;
+    if (!ReadContent(script.path, content))
+        return;
+
+    script.size = size;
+    script.mtime = mtime;
+    script.hash = HashBytes(content.data(), content.size());
+}
+
+bool SaveFormat::WriteBinary(const fs::path& path, std::vector<ScriptMacro> scripts)
+{
+    std::string blob;
+    std::vector<Entry> entries;
+    entries.reserve(scripts.size());
+
+    for (auto& script : scripts)
+    {
+        std::error_code ec;
+        fs::path resolved = fs::absolute(script.path, ec);
+        if (!ec)
+            script.path = resolved.lexically_normal().string();
+        StampScript(script);
+
+        Entry e{};
+        e.name = AddString(blob, script.name);
+        e.path = AddString(blob, script.path);
+        e.title = AddString(blob, script.title);
+        e.description = AddString(blob, script.description);
+        e.category = AddString(blob, script.category);
+        e.size = script.size;
+        e.mtime = script.mtime;
+        e.hash = script.hash;
+        entries.push_back(e);
+    }
+
+    Header header{};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.entryCount = (uint32_t)entries.size();
+    header.stringBytes = (uint32_t)blob.size();
+
+    std::string bytes;
+    bytes.reserve(sizeof(Header) + entries.size() * sizeof(Entry) + blob.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    bytes += blob;
+
+    if (!WriteReplace(path, bytes))
+    {
+        fprintf(stderr, "[ERROR] Failed to write save: %s\n", path.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<ScriptMacro>> SaveFormat::ReadBinary(const fs::path& path)
+{
+    std::string bytes;
+    if (!ReadContent(path.string(), bytes) || bytes.size() < sizeof(Header))
+        return std::nullopt;
+
+    Header header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version)
+    {
+        fprintf(stderr, "[ERROR] Unsupported save format: %s\n", path.string().c_str());
+        return std::nullopt;
+    }
+
+    const uint64_t indexBytes = (uint64_t)header.entryCount * sizeof(Entry);
+    if (sizeof(Header) + indexBytes + header.stringBytes > bytes.size())
+    {
+        fprintf(stderr, "[ERROR] Truncated save: %s\n", path.string().c_str());
+        return std::nullopt;
+    }
+    const std::string blob = bytes.substr(sizeof(Header) + indexBytes, header.stringBytes);
+
+    std::vector<ScriptMacro> scripts;
+    scripts.reserve(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        Entry e;
+        memcpy(&e, bytes.data() + sizeof(Header) + i * sizeof(Entry), sizeof(Entry));
+
+        ScriptMacro sm;
+        if (!GetString(blob, e.name, sm.name) || !GetString(blob, e.path, sm.path) ||
+            !GetString(blob, e.title, sm.title) || !GetString(blob, e.description, sm.description) ||
+            !GetString(blob, e.category, sm.category))
+        {
+            fprintf(stderr, "[ERROR] Corrupt save entry %u: %s\n", i, path.string().c_str());
+            return std::nullopt;
+        }
+
+        // stat-only validation; reparse only what changed on disk
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!StatScript(sm.path, size, mtime))
+        {
+            sm.content = "# Missing script file\n";
+            fprintf(stderr, "[WARN] Missing script: %s\n", sm.path.c_str());
+        }
+        else if (size == e.size && mtime == e.mtime)
+        {
+            sm.size = e.size;
+            sm.mtime = e.mtime;
+            sm.hash = e.hash;
+        }
+        else if (ReadContent(sm.path, sm.content))
+        {
+            sm.title.clear();
+            sm.description.clear();
+            sm.category.clear();
+            ParseScriptMetadata(sm.content, sm);
+            sm.size = size;
+            sm.mtime = mtime;
+            sm.hash = HashBytes(sm.content.data(), sm.content.size());
+        }
+
+        scripts.push_back(std::move(sm));
+    }
+    return scripts;
+}
+
+bool SaveFormat::WriteJson(const fs::path& path, const std::vector<ScriptMacro>& scripts)
+{
+    json j;
+    for (const auto& s : scripts)
+        j["scripts"].push_back({{"name", s.name}, {"path", s.path}});
+
+    if (!WriteReplace(path, j.dump(2)))
+    {
+        fprintf(stderr, "[ERROR] Failed to write save: %s\n", path.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<ScriptMacro>> SaveFormat::ReadJson(const fs::path& path,
+                                                             const std::vector<std::string>& searchPaths)
+{
+    std::ifstream file(path);
+    json j = json::parse(file, nullptr, false);
+    if (j.is_discarded())
+    {
+        fprintf(stderr, "[ERROR] Failed to parse save: %s\n", path.string().c_str());
+        return std::nullopt;
+    }
+    return ButtonsWindow::LoadScriptReferences(j, searchPaths);
+}
+
+namespace
+{
+    class ReferenceSax : public nlohmann::json_sax<json>
+    {
+    public:
+        explicit ReferenceSax(const SaveFormat::ReferenceCallback& cb) : onEntry(cb) {}
+
+        bool null() override { return true; }
+        bool boolean(bool) override { return true; }
+        bool number_integer(number_integer_t) override { return true; }
+        bool number_unsigned(number_unsigned_t) override { return true; }
+        bool number_float(number_float_t, const string_t&) override { return true; }
+        bool binary(binary_t&) override { return true; }
+
+        bool string(string_t& val) override
+        {
+            if (inEntry && depth == 3)
+            {
+                if (currentKey == "name")
+                    name = std::move(val);
+                else if (currentKey == "path")
+                    path = std::move(val);
+            }
+            return true;
+        }
+
+        bool key(string_t& val) override
+        {
+            if (depth == 1 || (inEntry && depth == 3))
+                currentKey = std::move(val);
+            return true;
+        }
+
+        bool start_object(std::size_t) override
+        {
+            depth++;
+            if (inScripts && depth == 3)
+            {
+                inEntry = true;
+                name.clear();
+                path.clear();
+                currentKey.clear();
+            }
+            return true;
+        }
+
+        bool end_object() override
+        {
+            if (inEntry && depth == 3)
+            {
+                inEntry = false;
+                onEntry(std::move(name), std::move(path));
+                name.clear();
+                path.clear();
+            }
+            depth--;
+            return true;
+        }
+
+        bool start_array(std::size_t) override
+        {
+            depth++;
+            if (depth == 2 && currentKey == "scripts")
+                inScripts = true;
+            return true;
+        }
+
+        bool end_array() override
+        {
+            if (depth == 2)
+                inScripts = false;
+            depth--;
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override
+        {
+            fprintf(stderr, "[ERROR] JSON parse error at byte %zu: %s\n", position, ex.what());
+            return false;
+        }
+
+    private:
+        const SaveFormat::ReferenceCallback& onEntry;
+        int depth = 0;
+        bool inScripts = false;
+        bool inEntry = false;
+        std::string currentKey, name, path;
+    };
+}
+
+bool SaveFormat::StreamJsonReferences(std::istream& in, const ReferenceCallback& onEntry)
+{
+    ReferenceSax sax(onEntry);
+    return json::sax_parse(in, &sax);
+}
+
+bool SaveFormat::StreamJson(const fs::path& path, const std::vector<std::string>& searchPaths,
+                            const std::function<void(std::vector<ScriptMacro>&&)>& onBatch, size_t batchSize)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::vector<ScriptMacro> batch;
+    auto flush = [&]()
+    {
+        if (batch.empty())
+            return;
+        onBatch(std::move(batch));
+        batch.clear();
+    };
+
+    bool ok = StreamJsonReferences(file, [&](std::string&& name, std::string&& scriptPath)
+                                   {
+        batch.push_back(ButtonsWindow::ResolveScriptReference(name, std::move(scriptPath), searchPaths));
+        if (batch.size() >= batchSize)
+            flush(); });
+    flush();
+
+    if (!ok)
+        fprintf(stderr, "[ERROR] Failed to parse save: %s\n", path.string().c_str());
+    return ok;
+}
+
+std::optional<std::vector<ScriptMacro>> SaveFormat::Read(const fs::path& path,
+                                                         const std::vector<std::string>& searchPaths)
+{
+    if (path.extension() == BinaryExtension)
+        return ReadBinary(path);
+    return ReadJson(path, searchPaths);
+}
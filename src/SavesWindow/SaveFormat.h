@@ -0,0 +1,51 @@
+#pragma once
+#include "ButtonsWindow/ButtonsWindow.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Binary save (.sav): a fixed header, one fixed-size index entry per script
+// and a string blob. Each entry records the script's resolved path, size,
+// mtime, content hash and parsed metadata, so loading is one small read plus
+// a stat per script; only scripts whose size or mtime changed are reread.
+// Stored in native byte order.
+namespace SaveFormat
+{
+    constexpr char Magic[4] = {'I', 'T', 'S', 'V'};
+    constexpr uint32_t Version = 1;
+    constexpr const char* BinaryExtension = ".sav";
+    constexpr const char* JsonExtension = ".json";
+
+    uint64_t HashBytes(const void* data, size_t size);
+    // Fills size/mtime/hash for a script; rereads the file only when needed.
+    void StampScript(ScriptMacro& script);
+
+    bool WriteBinary(const std::filesystem::path& path, std::vector<ScriptMacro> scripts);
+    std::optional<std::vector<ScriptMacro>> ReadBinary(const std::filesystem::path& path);
+
+    // Compatibility with the original Saves/*.json files.
+    bool WriteJson(const std::filesystem::path& path, const std::vector<ScriptMacro>& scripts);
+    std::optional<std::vector<ScriptMacro>> ReadJson(const std::filesystem::path& path,
+                                                     const std::vector<std::string>& searchPaths);
+
+    // SAX walk of {"scripts": [{"name": ..., "path": ...}, ...]} that hands each
+    // reference to onEntry as soon as its object closes; no DOM is built.
+    using ReferenceCallback = std::function<void(std::string&& name, std::string&& path)>;
+    bool StreamJsonReferences(std::istream& in, const ReferenceCallback& onEntry);
+
+    // Streaming counterpart of ReadJson: resolved scripts are moved to onBatch
+    // every batchSize entries and nothing else is kept, so memory stays at one
+    // batch. Returns false on a parse error, after the batches read so far.
+    bool StreamJson(const std::filesystem::path& path,
+                                                       const std::vector<std::string>& searchPaths,
+                                                       const std::function<void(std::vector<ScriptMacro>&&)>& onBatch,
+                                                       size_t batchSize = 256);
+
+    // Picks the reader from the extension.
+    std::optional<std::vector<ScriptMacro>> Read(const std::filesystem::path& path,
+                                                 const std::vector<std::string>& searchPaths);
+}
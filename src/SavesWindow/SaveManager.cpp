@@ -0,0 +1,328 @@
+#include "SaveManager.h"
+#include "SaveFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+namespace fs = std::filesystem;
+
+static std::string FormatTime(fs::file_time_type time)
+{
+    const auto sys = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        std::chrono::file_clock::to_sys(time));
+    const std::time_t t = std::chrono::system_clock::to_time_t(sys);
+    char buffer[32] = "";
+    if (const std::tm* local = std::localtime(&t))
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", local);
+    return buffer;
+}
+
+// Entry count straight from a .sav header, without reading the index.
+static int PeekScriptCount(const fs::path& path)
+{
+    char header[16];
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(header, sizeof(header)) || memcmp(header, SaveFormat::Magic, 4) != 0)
+        return -1;
+    uint32_t count;
+    memcpy(&count, header + 8, sizeof(count));
+    return (int)count;
+}
+
+// One entry per save name; a binary .sav wins over a .json of the same name.
+std::vector<SaveManager::SaveInfo> SaveManager::ListSaves(const std::vector<SaveInfo>& known)
+{
+    // header counts from the last listing, reused while the file's size and mtime hold
+    std::unordered_map<std::string, const SaveInfo*> peeked;
+    for (const auto& save : known)
+        if (save.binary && save.scriptCount >= 0)
+            peeked[save.path.string()] = &save;
+
+    std::map<std::string, SaveInfo> found;
+    std::error_code ec;
+    if (!fs::exists("Saves", ec))
+        fs::create_directory("Saves", ec);
+
+    for (auto& entry : fs::directory_iterator("Saves", ec))
+    {
+        const auto ext = entry.path().extension();
+        const bool binary = ext == SaveFormat::BinaryExtension;
+        if (!binary && ext != SaveFormat::JsonExtension)
+            continue;
+
+        std::string name = entry.path().stem().string();
+        auto it = found.find(name);
+        if (it != found.end() && !binary)
+            continue;
+
+        SaveInfo info;
+        info.name = name;
+        info.path = entry.path();
+        info.binary = binary;
+        info.fileSize = entry.file_size(ec);
+        auto time = entry.last_write_time(ec);
+        info.mtime = time.time_since_epoch().count();
+        info.modified = FormatTime(time);
+        if (binary)
+        {
+            auto previous = peeked.find(info.path.string());
+            const bool unchanged = previous != peeked.end() && previous->second->fileSize == info.fileSize &&
+                                   previous->second->mtime == info.mtime;
+            info.scriptCount = unchanged ? previous->second->scriptCount : PeekScriptCount(entry.path());
+        }
+        found[name] = std::move(info);
+    }
+
+    std::vector<SaveInfo> sorted;
+    for (auto& [name, save] : found)
+        sorted.push_back(std::move(save));
+    return sorted;
+}
+
+void SaveManager::Update()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (pollInFlight || now - lastPoll < pollInterval)
+        return;
+    Rescan();
+}
+
+void SaveManager::Rescan()
+{
+    pollInFlight = true;
+    lastPoll = std::chrono::steady_clock::now();
+    ioWorker->Submit([known = saves]() { return ListSaves(known); },
+                     [this](std::vector<SaveInfo>& found)
+                     {
+                         pollInFlight = false;
+                         ApplyListing(std::move(found));
+                     },
+                     [this](std::exception_ptr error)
+                     {
+                         pollInFlight = false;
+                         IOWorker::LogError("Listing Saves/ failed", error);
+                     });
+}
+
+void SaveManager::ApplyListing(std::vector<SaveInfo>&& found)
+{
+    std::unordered_map<std::string, const SaveInfo*> byName;
+    for (const auto& save : found)
+        byName[save.name] = &save;
+
+    // drop workspaces whose file changed or disappeared
+    for (auto it = lru.begin(); it != lru.end();)
+    {
+        auto match = byName.find(it->name);
+        const bool stale = match == byName.end() ||
+                           match->second->fileSize != it->fileSize ||
+                           match->second->mtime != it->mtime;
+        if (stale)
+        {
+            index.erase(it->name);
+            it = lru.erase(it);
+            revision++;
+        }
+        else
+            ++it;
+    }
+
+    for (auto& save : found)
+    {
+        auto cached = index.find(save.name);
+        if (cached != index.end())
+            save.scriptCount = (int)cached->second->workspace->size();
+    }
+    // the poll lands every second; only a listing that looks different counts as a change
+    auto shown = [](const SaveInfo& a, const SaveInfo& b)
+    {
+        return a.name == b.name && a.binary == b.binary && a.modified == b.modified && a.scriptCount == b.scriptCount;
+    };
+    if (!std::equal(saves.begin(), saves.end(), found.begin(), found.end(), shown))
+        revision++;
+
+    saves = std::move(found);
+    saveNames.clear();
+    for (auto& save : saves)
+        saveNames.push_back(save.name);
+}
+
+void SaveManager::SetCapacity(size_t newCapacity)
+{
+    capacity = std::max<size_t>(1, newCapacity);
+    while (lru.size() > capacity)
+        Evict(lru.back().name);
+}
+
+void SaveManager::Open(const SaveInfo& save, const std::vector<std::string>& searchPaths,
+                       std::function<void(WorkspacePtr)> done, BatchCallback onBatch)
+{
+    const uint64_t generation = ++openGeneration;
+    staging.reset();
+    auto cached = index.find(save.name);
+    if (cached != index.end())
+    {
+        Touch(save.name);
+        done(lru.front().workspace);
+        return;
+    }
+
+    pendingJobs++;
+    auto failed = [this, save, done, generation](std::exception_ptr error)
+    {
+        pendingJobs--;
+        IOWorker::LogError(("Opening " + save.name + " failed").c_str(), error);
+        if (generation != openGeneration)
+            return;
+        staging.reset();
+        done(nullptr);
+    };
+
+    if (save.binary || !onBatch)
+    {
+        ioWorker->Submit(
+            [save, searchPaths]()
+            {
+                auto loaded = SaveFormat::Read(save.path, searchPaths);
+                return loaded ? std::make_shared<const Workspace>(std::move(*loaded)) : WorkspacePtr{};
+            },
+            [this, save, done, generation](WorkspacePtr& workspace)
+            {
+                pendingJobs--;
+                if (generation == openGeneration)
+                    FinishOpen(save, std::move(workspace), done);
+            },
+            failed);
+        return;
+    }
+
+    ioWorker->Submit(
+        [this, save, searchPaths, generation, onBatch]()
+        {
+            // each batch is moved on to the UI thread; the worker keeps nothing
+            return SaveFormat::StreamJson(save.path, searchPaths, [&](Workspace&& batch)
+                                          {
+                ioWorker->Post([this, generation, onBatch, batch = std::move(batch)]() mutable
+                               {
+                    if (generation != openGeneration)
+                        return;
+                    const bool first = !staging;
+                    if (first)
+                        staging = std::make_shared<Workspace>();
+                    staging->insert(staging->end(), std::make_move_iterator(batch.begin()),
+                                    std::make_move_iterator(batch.end()));
+                    onBatch(staging, first); }); });
+        },
+        [this, save, done, generation](bool& ok)
+        {
+            pendingJobs--;
+            if (generation != openGeneration)
+                return;
+            // batches were posted before this completion, so staging is complete
+            WorkspacePtr workspace;
+            if (ok)
+                workspace = staging ? std::move(staging) : std::make_shared<Workspace>();
+            staging.reset();
+            FinishOpen(save, std::move(workspace), done);
+        },
+        failed);
+}
+
+void SaveManager::FinishOpen(const SaveInfo& save, WorkspacePtr workspace, const std::function<void(WorkspacePtr)>& done)
+{
+    if (workspace)
+    {
+        Insert(save.name, save.fileSize, save.mtime, workspace);
+        for (auto& info : saves)
+            if (info.name == save.name)
+                info.scriptCount = (int)workspace->size();
+        revision++;
+    }
+    done(std::move(workspace));
+}
+
+void SaveManager::Store(const std::string& name, WorkspacePtr workspace)
+{
+    // a list still being streamed in keeps growing on this thread; the worker gets a snapshot
+    if (staging && workspace == staging)
+        workspace = std::make_shared<const Workspace>(*workspace);
+    pendingJobs++;
+    ioWorker->Submit(
+        [name, workspace, known = saves]()
+        {
+            SaveFormat::WriteBinary("Saves/" + name + SaveFormat::BinaryExtension, *workspace);
+            return ListSaves(known);
+        },
+        [this, name, workspace](std::vector<SaveInfo>& found)
+        {
+            pendingJobs--;
+            Evict(name);
+            ApplyListing(std::move(found));
+            // the snapshot just written is exactly what reopening would produce
+            for (auto& save : saves)
+                if (save.name == name && save.binary)
+                {
+                    Insert(name, save.fileSize, save.mtime, workspace);
+                    save.scriptCount = (int)workspace->size();
+                }
+        },
+        [this, name](std::exception_ptr error)
+        {
+            pendingJobs--;
+            IOWorker::LogError(("Storing " + name + " failed").c_str(), error);
+        });
+}
+
+void SaveManager::ExportJson(const SaveInfo& save, const std::vector<std::string>& searchPaths)
+{
+    pendingJobs++;
+    ioWorker->Submit(
+        [save, searchPaths]()
+        {
+            auto scripts = SaveFormat::Read(save.path, searchPaths);
+            if (scripts)
+            {
+                fs::path out = save.path;
+                out.replace_extension(SaveFormat::JsonExtension);
+                if (SaveFormat::WriteJson(out, *scripts))
+                    printf("[INFO] Exported %s\n", out.string().c_str());
+            }
+            return 0;
+        },
+        [this](int&) { pendingJobs--; },
+        [this](std::exception_ptr error)
+        {
+            pendingJobs--;
+            IOWorker::LogError("JSON export failed", error);
+        });
+}
+
+void SaveManager::Insert(const std::string& name, uintmax_t fileSize, int64_t mtime, WorkspacePtr workspace)
+{
+    Evict(name);
+    lru.push_front({name, fileSize, mtime, std::move(workspace)});
+    index[name] = lru.begin();
+    revision++;
+    while (lru.size() > capacity)
+        Evict(lru.back().name);
+}
+
+void SaveManager::Evict(const std::string& name)
+{
+    auto it = index.find(name);
+    if (it == index.end())
+        return;
+    lru.erase(it->second);
+    index.erase(it);
+    revision++;
+}
+
+void SaveManager::Touch(const std::string& name)
+{
+    auto it = index.find(name);
+    if (it != index.end())
+        lru.splice(lru.begin(), lru, it->second);
+}
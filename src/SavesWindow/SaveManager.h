@@ -0,0 +1,94 @@
+#pragma once
+#include "ButtonsWindow/ButtonsWindow.h"
+#include "IO/IOWorker.h"
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Owns the Saves/ listing and an LRU of parsed workspaces. Reopening a
+// cached save hands out the same shared list, so switching is a pointer
+// swap. Saves/ is polled on the IO worker; a save whose size or mtime
+// changes is dropped from the cache and the listing is refreshed.
+class SaveManager
+{
+public:
+    using Workspace = ButtonsWindow::ScriptList;
+    using WorkspacePtr = std::shared_ptr<const Workspace>;
+
+    struct SaveInfo
+    {
+        std::string name;
+        std::filesystem::path path;
+        bool binary = false;
+        uintmax_t fileSize = 0;
+        int64_t mtime = 0;
+        std::string modified;  // display string for mtime
+        int scriptCount = -1;  // -1 until known (read from .sav headers, or once loaded)
+    };
+
+    SaveManager(IOWorker* io, size_t capacity = 6) : ioWorker(io), capacity(capacity) {}
+
+    // Call once per frame; schedules the directory watch poll.
+    void Update();
+    void Rescan();
+
+    void SetCapacity(size_t newCapacity);
+    size_t GetCapacity() const { return capacity; }
+    size_t CachedCount() const { return lru.size(); }
+    bool IsCached(const std::string& name) const { return index.count(name) != 0; }
+
+    // Cached saves complete immediately; others load on the IO worker, and done
+    // gets nullptr if the load fails. JSON saves are streamed: parsed batches are
+    // moved into one staging list, which onBatch sees growing (first on the first
+    // batch); on success that same list is handed to done, so it is never copied.
+    using BatchCallback = std::function<void(const WorkspacePtr& loadedSoFar, bool first)>;
+    void Open(const SaveInfo& save, const std::vector<std::string>& searchPaths,
+              std::function<void(WorkspacePtr)> done, BatchCallback onBatch = nullptr);
+    void Store(const std::string& name, WorkspacePtr workspace);
+    void ExportJson(const SaveInfo& save, const std::vector<std::string>& searchPaths);
+
+    const std::vector<SaveInfo>& GetSaves() const { return saves; }
+    std::vector<std::string>& GetSaveNames() { return saveNames; }
+    bool IsBusy() const { return pendingJobs > 0; }
+    // Changes whenever the listing or the cached set does, not on every poll.
+    uint64_t GetRevision() const { return revision; }
+
+    // Header counts in `known` (the previous listing) are reused for files whose
+    // size and mtime are unchanged, so a poll only reopens saves that changed.
+    static std::vector<SaveInfo> ListSaves(const std::vector<SaveInfo>& known = {});
+
+private:
+    struct CachedWorkspace
+    {
+        std::string name;
+        uintmax_t fileSize;
+        int64_t mtime;
+        WorkspacePtr workspace;
+    };
+
+    void ApplyListing(std::vector<SaveInfo>&& found);
+    void FinishOpen(const SaveInfo& save, WorkspacePtr workspace, const std::function<void(WorkspacePtr)>& done);
+    void Insert(const std::string& name, uintmax_t fileSize, int64_t mtime, WorkspacePtr workspace);
+    void Evict(const std::string& name);
+    void Touch(const std::string& name);
+
+    IOWorker* ioWorker;
+    size_t capacity;
+    std::list<CachedWorkspace> lru; // front = most recently used
+    std::unordered_map<std::string, std::list<CachedWorkspace>::iterator> index;
+
+    std::vector<SaveInfo> saves;
+    std::vector<std::string> saveNames;
+    int pendingJobs = 0;
+    uint64_t openGeneration = 0; // batches from a superseded Open are dropped
+    std::shared_ptr<Workspace> staging; // the JSON save being streamed in
+    uint64_t revision = 0;
+    bool pollInFlight = false;
+    std::chrono::steady_clock::time_point lastPoll{};
+    std::chrono::milliseconds pollInterval{1000};
+};
@@ -1,16 +1,4 @@
 #include "SavesWindow.h"
-#include <fstream>
-
-void SavesWindow:: ReloadSaves()
-{
-    saveFiles.clear();
-    if (!std::filesystem::exists("Saves"))
-        std::filesystem::create_directory("Saves");
-
-    for (auto& entry : std::filesystem::directory_iterator("Saves"))
-        if (entry.path().extension() == ".json")
-            saveFiles.push_back(entry.path().stem().string());
-}
 
 void SavesWindow::Render()
 {
@@ -20,14 +8,7 @@ void SavesWindow::Render()
     if (ImGui::Button("Create Save"))
     {
         if (strlen(nameBuffer) > 0)
-        {
-            json j = buttonsWindow->Serialize();
-            std::string path = "Saves/" + std::string(nameBuffer) + ".json";
-            std::ofstream file(path);
-            file << std::setw(2) << j;
-            file.close();
-            ReloadSaves();
-        }
+            saveManager.Store(nameBuffer, buttonsWindow->GetScriptsShared());
     }
     ImGui::SameLine();
     //ImGui::InputText("Save Name", nameBuffer, sizeof(nameBuffer));
@@ -37,23 +18,60 @@ void SavesWindow::Render()
 
     if (ImGui::Button("Refresh"))
         ReloadSaves();
+    ImGui::SameLine();
+    int capacity = (int)saveManager.GetCapacity();
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("000000").x * 2.0f);
+    if (ImGui::InputInt("Cached workspaces", &capacity))
+    {
+        saveManager.SetCapacity(capacity > 0 ? capacity : 1);
+        config->Set("/saves/cacheSize", saveManager.GetCapacity());
+    }
+    if (IsBusy())
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Working...");
+    }
 
     ImGui::Separator();
 
     // --- Compute uniform width for save buttons ---
-    float buttonWidth = ComputeUniformButtonWidth(saveFiles);
+    float buttonWidth = ComputeUniformButtonWidth(saveManager.GetSaveNames());
     // --- Load referenced scripts ---
-    for (auto& name : saveFiles)
+    ImGui::BeginDisabled(IsBusy());
+    for (const auto& save : saveManager.GetSaves())
     {
-        if (ImGui::Button(name.c_str(), ImVec2(buttonWidth, 0)))
+        if (ImGui::Button(save.name.c_str(), ImVec2(buttonWidth, 0)))
+            saveManager.Open(
+                save, buttonsWindow->GetSearchPaths(),
+                [this](SaveManager::WorkspacePtr workspace)
+                {
+                    // a failed load puts back what was shown before it started streaming
+                    if (workspace)
+                        buttonsWindow->SetScripts(std::move(workspace));
+                    else if (beforeStream)
+                        buttonsWindow->SetScripts(std::move(beforeStream));
+                    beforeStream.reset();
+                },
+                [this](const SaveManager::WorkspacePtr& loadedSoFar, bool first)
+                {
+                    // large JSON saves fill in progressively while streaming
+                    if (first)
+                        beforeStream = buttonsWindow->GetScriptsShared();
+                    buttonsWindow->SetScripts(loadedSoFar);
+                });
+
+        ImGui::SameLine();
+        if (save.binary)
         {
-            std::string path = "Saves/" + name + ".json";
-            std::ifstream file(path);
-            json j;
-            file >> j;
-            file.close();
-            buttonsWindow->ClearScripts();
-            buttonsWindow->Deserialize(j);
+            if (ImGui::Button(("Export JSON##" + save.name).c_str()))
+                saveManager.ExportJson(save, buttonsWindow->GetSearchPaths());
+            ImGui::SameLine();
         }
+
+        std::string count = save.scriptCount >= 0 ? std::to_string(save.scriptCount) + " scripts" : "? scripts";
+        ImGui::TextDisabled("%s, %s%s%s", count.c_str(), save.modified.c_str(),
+                            save.binary ? "" : " (json)",
+                            saveManager.IsCached(save.name) ? " (cached)" : "");
     }
+    ImGui::EndDisabled();
 }
@@ -2,6 +2,8 @@
 #include "lib_include.h"
 #include "ButtonsWindow/ButtonsWindow.h"
 #include "ButtonsWindow/ScriptMacro.h"
+#include "IO/IOWorker.h"
+#include "SaveManager.h"
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include "Global/Global.h"
@@ -11,11 +13,22 @@ using json = nlohmann::json;
 class SavesWindow
 {
 public:
-    explicit SavesWindow(ButtonsWindow* buttons) : buttonsWindow(buttons) {}
+    SavesWindow(ButtonsWindow* buttons, IOWorker* io, ConfigStore* cfg)
+        : buttonsWindow(buttons), config(cfg), saveManager(io, cfg->Get<size_t>("/saves/cacheSize", 6)) {}
     void Render();
+    // Per frame: keeps the listing in sync with Saves/ without blocking.
+    void Update() { saveManager.Update(); }
 
-    void ReloadSaves();
+    void ReloadSaves() { saveManager.Rescan(); }
+    bool IsBusy() const { return saveManager.IsBusy(); }
+    // Changes with the listing, the cache and the busy state.
+    uint64_t GetRevision() const
+    {
+        return (saveManager.GetRevision() * 2 + (IsBusy() ? 1 : 0)) * 131 + saveManager.GetCapacity();
+    }
 private:
     ButtonsWindow* buttonsWindow;
-    std::vector<std::string> saveFiles;
+    ConfigStore* config;
+    SaveManager saveManager;
+    SaveManager::WorkspacePtr beforeStream; // restored if a streamed load fails
 };